@@ -0,0 +1,102 @@
+/*
+    BENCHMARK SUPPORT
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace adstl_bench
+{
+
+struct bench_config
+{
+    size_t max_n = 1000000;                       // biggest element count, up to 10^8
+    size_t max_bytes = size_t(1) << 31;           // skip sizes whose containers would not fit in memory
+};
+
+// element of a fixed size, trivially copyable so both libraries get the same fast paths
+template <size_t Bytes>
+struct payload
+{
+    payload() = default;
+    explicit payload(size_t v) { std::memset(bytes, static_cast<unsigned char>(v), Bytes); }
+
+    unsigned char bytes[Bytes];
+};
+
+// element type of any container with begin(), adstl containers do not all expose value_type
+template <typename C>
+using element_t = std::decay_t<decltype(*std::declval<C&>().begin())>;
+
+template <typename T>
+inline T make_value(size_t i)
+{
+    return T(i);
+}
+
+// powers of ten from 10^3 up to the configured limit, capped by memory budget per element size
+inline void apply_sizes(benchmark::internal::Benchmark *b, const bench_config &config, size_t element_size, size_t max_n)
+{
+    size_t limit = std::min(config.max_n, max_n);
+    limit = std::min(limit, config.max_bytes / (element_size ? element_size : 1));
+
+    for(size_t n = 1000; n <= limit; n *= 10)
+    {
+        b->Arg(static_cast<int64_t>(n));
+    }
+}
+
+// records per operation latency percentiles into the benchmark counters
+class latency_recorder
+{
+    public:
+
+        explicit latency_recorder(size_t reserve) { samples.reserve(reserve); }
+
+        template <typename F>
+        void measure(F &&f)
+        {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto stop = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+
+        void report(benchmark::State &state)
+        {
+            if(samples.empty())
+            {
+                return;
+            }
+
+            std::sort(samples.begin(), samples.end());
+            state.counters["p50_ns"] = samples[samples.size() / 2];
+            state.counters["p99_ns"] = samples[samples.size() * 99 / 100];
+            state.counters["max_ns"] = samples.back();
+        }
+
+    private:
+        std::vector<double> samples;
+};
+
+void register_vector_benchmarks(const bench_config&);
+void register_sllist_benchmarks(const bench_config&);
+void register_stack_benchmarks(const bench_config&);
+void register_simd_benchmarks(const bench_config&);
+void register_queue_benchmarks(const bench_config&);
+void register_hash_map_benchmarks(const bench_config&);
+void register_btree_benchmarks(const bench_config&);
+void register_priority_queue_benchmarks(const bench_config&);
+
+}
+
+#endif
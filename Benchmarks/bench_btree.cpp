@@ -0,0 +1,176 @@
+#include "bench.hpp"
+#include "btree_map.hpp"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+
+namespace adstl_bench
+{
+
+namespace
+{
+
+// distinct keys in a scattered order
+inline std::vector<uint64_t> make_keys(size_t n, uint64_t seed)
+{
+    std::vector<uint64_t> keys(n);
+    for(size_t i = 0; i != n; ++i)
+    {
+        keys[i] = 2 * i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(seed));
+    return keys;
+}
+
+template <typename M>
+M make_map(const std::vector<uint64_t> &keys)
+{
+    M map;
+    for(uint64_t key : keys)
+    {
+        map.emplace(key, key);
+    }
+    return map;
+}
+
+template <typename M>
+void BM_insert_random(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto keys = make_keys(n, 1);
+
+    for(auto _ : state)
+    {
+        M map = make_map<M>(keys);
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename M>
+void BM_insert_ascending(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    for(auto _ : state)
+    {
+        M map;
+        for(size_t i = 0; i != n; ++i)
+        {
+            map.emplace_hint(map.end(), i, i);
+        }
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// a sorted batch turned into an index: bulk load for btree_map, hinted inserts for std::map
+template <typename M>
+void BM_build_sorted(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<std::pair<uint64_t, uint64_t>> sorted(n);
+    for(size_t i = 0; i != n; ++i)
+    {
+        sorted[i] = {i, i};
+    }
+
+    for(auto _ : state)
+    {
+        M map(sorted.begin(), sorted.end());
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename M>
+void BM_find(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto keys = make_keys(n, 1);
+    const M map = make_map<M>(keys);
+    const auto lookups = make_keys(n, 2);
+
+    for(auto _ : state)
+    {
+        uint64_t sum = 0;
+        for(uint64_t key : lookups)
+        {
+            sum += map.find(key)->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// lower_bound then 100 elements in key order, the index workload
+template <typename M>
+void BM_range_scan(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const size_t span = 100;
+    const auto keys = make_keys(n, 1);
+    const M map = make_map<M>(keys);
+    const auto starts = make_keys(n / span, 3);
+
+    for(auto _ : state)
+    {
+        uint64_t sum = 0;
+        for(uint64_t start : starts)
+        {
+            auto it = map.lower_bound(start);
+            for(size_t i = 0; i != span && it != map.end(); ++i, ++it)
+            {
+                sum += it->second;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * starts.size() * span);
+}
+
+template <typename M>
+void BM_erase(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto keys = make_keys(n, 1);
+    const auto order = make_keys(n, 2);
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        M map = make_map<M>(keys);
+        state.ResumeTiming();
+
+        for(uint64_t key : order)
+        {
+            map.erase(key);
+        }
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename M>
+void register_map(const std::string &name, const bench_config &config, size_t element_size)
+{
+    apply_sizes(benchmark::RegisterBenchmark((name + "/insert_random").c_str(), BM_insert_random<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/insert_ascending").c_str(), BM_insert_ascending<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/build_sorted").c_str(), BM_build_sorted<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/find").c_str(), BM_find<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/range_scan").c_str(), BM_range_scan<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/erase").c_str(), BM_erase<M>), config, element_size, config.max_n);
+}
+
+}
+
+void register_btree_benchmarks(const bench_config &config)
+{
+    // a red-black node carries three pointers and a color next to the element
+    register_map<adstl::btree_map<uint64_t, uint64_t>>("adstl::btree_map<uint64_t, uint64_t>", config, 2 * sizeof(uint64_t));
+    register_map<std::map<uint64_t, uint64_t>>("std::map<uint64_t, uint64_t>", config, 2 * sizeof(uint64_t) + 4 * sizeof(void*));
+}
+
+}
@@ -0,0 +1,186 @@
+#include "bench.hpp"
+#include "flat_hash_map.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace adstl_bench
+{
+
+namespace
+{
+
+// keys in a scattered order, so neither table sees them sorted
+inline std::vector<uint64_t> make_keys(size_t n, uint64_t seed)
+{
+    std::vector<uint64_t> keys(n);
+    std::mt19937_64 rng(seed);
+    for(auto &key : keys)
+    {
+        key = rng();
+    }
+    return keys;
+}
+
+template <typename M>
+void BM_insert(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto keys = make_keys(n, 1);
+
+    for(auto _ : state)
+    {
+        M map;
+        for(uint64_t key : keys)
+        {
+            map.emplace(key, key);
+        }
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename M>
+void BM_insert_reserved(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto keys = make_keys(n, 1);
+
+    for(auto _ : state)
+    {
+        M map;
+        map.reserve(n);
+        for(uint64_t key : keys)
+        {
+            map.emplace(key, key);
+        }
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// every key is found, in another order than it was inserted in
+template <typename M>
+void BM_find_hit(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    auto keys = make_keys(n, 1);
+
+    M map;
+    for(uint64_t key : keys)
+    {
+        map.emplace(key, key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(2));
+
+    for(auto _ : state)
+    {
+        uint64_t sum = 0;
+        for(uint64_t key : keys)
+        {
+            sum += map.find(key)->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename M>
+void BM_find_miss(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto keys = make_keys(n, 1);
+    const auto missing = make_keys(n, 3);
+
+    M map;
+    for(uint64_t key : keys)
+    {
+        map.emplace(key, key);
+    }
+
+    for(auto _ : state)
+    {
+        size_t found = 0;
+        for(uint64_t key : missing)
+        {
+            found += map.find(key) != map.end();
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename M>
+void BM_erase(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto keys = make_keys(n, 1);
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        M map;
+        for(uint64_t key : keys)
+        {
+            map.emplace(key, key);
+        }
+        state.ResumeTiming();
+
+        for(uint64_t key : keys)
+        {
+            map.erase(key);
+        }
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename M>
+void BM_iterate(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto keys = make_keys(n, 1);
+
+    M map;
+    for(uint64_t key : keys)
+    {
+        map.emplace(key, key);
+    }
+
+    for(auto _ : state)
+    {
+        uint64_t sum = 0;
+        for(const auto &entry : map)
+        {
+            sum += entry.second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename M>
+void register_map(const std::string &name, const bench_config &config)
+{
+    // a key, a value and about one pointer of overhead per element
+    const size_t element_size = 3 * sizeof(uint64_t);
+
+    apply_sizes(benchmark::RegisterBenchmark((name + "/insert").c_str(), BM_insert<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/insert_reserved").c_str(), BM_insert_reserved<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/find_hit").c_str(), BM_find_hit<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/find_miss").c_str(), BM_find_miss<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/erase").c_str(), BM_erase<M>), config, element_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/iterate").c_str(), BM_iterate<M>), config, element_size, config.max_n);
+}
+
+}
+
+void register_hash_map_benchmarks(const bench_config &config)
+{
+    register_map<adstl::flat_hash_map<uint64_t, uint64_t>>("adstl::flat_hash_map<uint64_t, uint64_t>", config);
+    register_map<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map<uint64_t, uint64_t>", config);
+}
+
+}
@@ -0,0 +1,52 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+// Runs the adstl microbenchmarks against their standard library counterparts.
+//
+//     ./bench_main --max_n=100000000 --benchmark_out=bench_output.json --benchmark_out_format=json
+//
+// --max_n and --max_bytes are ours, everything else goes to Google Benchmark.
+int main(int argc, char **argv)
+{
+    adstl_bench::bench_config config;
+
+    int kept = 1;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strncmp(argv[i], "--max_n=", 8) == 0)
+        {
+            config.max_n = std::strtoull(argv[i] + 8, nullptr, 10);
+        }
+        else if(std::strncmp(argv[i], "--max_bytes=", 12) == 0)
+        {
+            config.max_bytes = std::strtoull(argv[i] + 12, nullptr, 10);
+        }
+        else
+        {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+
+    adstl_bench::register_vector_benchmarks(config);
+    adstl_bench::register_sllist_benchmarks(config);
+    adstl_bench::register_stack_benchmarks(config);
+    adstl_bench::register_simd_benchmarks(config);
+    adstl_bench::register_queue_benchmarks(config);
+    adstl_bench::register_hash_map_benchmarks(config);
+    adstl_bench::register_btree_benchmarks(config);
+    adstl_bench::register_priority_queue_benchmarks(config);
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
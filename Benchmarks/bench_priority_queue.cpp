@@ -0,0 +1,229 @@
+#include "bench.hpp"
+#include "priority_queue.hpp"
+
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace adstl_bench
+{
+
+namespace
+{
+
+inline std::vector<uint64_t> make_priorities(size_t n, uint64_t seed)
+{
+    std::vector<uint64_t> values(n);
+    std::mt19937_64 rng(seed);
+    for(auto &value : values)
+    {
+        value = rng();
+    }
+    return values;
+}
+
+template <typename Q>
+void BM_push_pop_all(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto values = make_priorities(n, 1);
+
+    for(auto _ : state)
+    {
+        Q q;
+        for(uint64_t value : values)
+        {
+            q.push(value);
+        }
+        uint64_t sum = 0;
+        while(!q.empty())
+        {
+            sum += q.top();
+            q.pop();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n * 2);
+}
+
+// a full queue that keeps taking one element for every one it hands out, the scheduler loop
+template <typename Q>
+void BM_steady_state(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto values = make_priorities(n, 1);
+    const auto incoming = make_priorities(n, 2);
+
+    Q q;
+    for(uint64_t value : values)
+    {
+        q.push(value);
+    }
+
+    for(auto _ : state)
+    {
+        uint64_t sum = 0;
+        for(uint64_t value : incoming)
+        {
+            if constexpr (std::is_same_v<Q, std::priority_queue<uint64_t>>)
+            {
+                sum += q.top();
+                q.pop();
+                q.push(value);
+            }
+            else
+            {
+                sum += q.replace_top(value);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Q>
+void BM_heapify(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const auto values = make_priorities(n, 1);
+
+    for(auto _ : state)
+    {
+        Q q(values.begin(), values.end());
+        benchmark::DoNotOptimize(&q.top());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// random graph with n vertices and 8 edges per vertex
+struct graph
+{
+    explicit graph(size_t n) : offsets(n + 1), targets(8 * n), weights(8 * n)
+    {
+        std::mt19937_64 rng(3);
+        for(size_t v = 0; v != n; ++v)
+        {
+            offsets[v] = 8 * v;
+        }
+        offsets[n] = 8 * n;
+        for(size_t e = 0; e != targets.size(); ++e)
+        {
+            targets[e] = static_cast<uint32_t>(rng() % n);
+            weights[e] = static_cast<uint32_t>(rng() % 1000 + 1);
+        }
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> weights;
+};
+
+// Dijkstra with decrease_key, one queue entry per vertex
+template <size_t Arity>
+void BM_dijkstra_indexed(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const graph g(n);
+    constexpr size_t none = std::numeric_limits<size_t>::max();
+
+    for(auto _ : state)
+    {
+        std::vector<uint64_t> dist(n, std::numeric_limits<uint64_t>::max());
+        std::vector<size_t> handle(n, none);
+        std::vector<uint32_t> vertex_of;
+        adstl::indexed_priority_queue<std::pair<uint64_t, uint32_t>, std::greater<>, Arity> q;
+
+        dist[0] = 0;
+        handle[0] = q.push(std::make_pair(uint64_t(0), uint32_t(0)));
+        while(!q.empty())
+        {
+            const uint32_t u = q.top().second;
+            q.pop();
+            for(size_t e = g.offsets[u]; e != g.offsets[u + 1]; ++e)
+            {
+                const uint32_t v = g.targets[e];
+                const uint64_t d = dist[u] + g.weights[e];
+                if(d < dist[v])
+                {
+                    if(dist[v] != std::numeric_limits<uint64_t>::max() && q.contains(handle[v]) && q.value(handle[v]).second == v)
+                    {
+                        q.decrease_key(handle[v], std::make_pair(d, v));
+                    }
+                    else
+                    {
+                        handle[v] = q.push(std::make_pair(d, v));
+                    }
+                    dist[v] = d;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(dist.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Dijkstra with a plain heap, stale entries are pushed again and skipped when popped
+void BM_dijkstra_lazy(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const graph g(n);
+
+    for(auto _ : state)
+    {
+        std::vector<uint64_t> dist(n, std::numeric_limits<uint64_t>::max());
+        std::priority_queue<std::pair<uint64_t, uint32_t>, std::vector<std::pair<uint64_t, uint32_t>>, std::greater<>> q;
+
+        dist[0] = 0;
+        q.push({0, 0});
+        while(!q.empty())
+        {
+            const auto [du, u] = q.top();
+            q.pop();
+            if(du != dist[u])
+            {
+                continue;
+            }
+            for(size_t e = g.offsets[u]; e != g.offsets[u + 1]; ++e)
+            {
+                const uint32_t v = g.targets[e];
+                const uint64_t d = du + g.weights[e];
+                if(d < dist[v])
+                {
+                    dist[v] = d;
+                    q.push({d, v});
+                }
+            }
+        }
+        benchmark::DoNotOptimize(dist.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Q>
+void register_queue(const std::string &name, const bench_config &config)
+{
+    apply_sizes(benchmark::RegisterBenchmark((name + "/push_pop_all").c_str(), BM_push_pop_all<Q>), config, sizeof(uint64_t), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/steady_state").c_str(), BM_steady_state<Q>), config, sizeof(uint64_t), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/heapify").c_str(), BM_heapify<Q>), config, sizeof(uint64_t), config.max_n);
+}
+
+}
+
+void register_priority_queue_benchmarks(const bench_config &config)
+{
+    register_queue<adstl::priority_queue<uint64_t>>("adstl::priority_queue<uint64_t>", config);
+    register_queue<adstl::quaternary_priority_queue<uint64_t>>("adstl::quaternary_priority_queue<uint64_t>", config);
+    register_queue<std::priority_queue<uint64_t>>("std::priority_queue<uint64_t>", config);
+
+    // a vertex costs its adjacency list and a queue entry
+    const size_t vertex_size = sizeof(size_t) + 8 * 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+    apply_sizes(benchmark::RegisterBenchmark("dijkstra/adstl::indexed_priority_queue<2>", BM_dijkstra_indexed<2>), config, vertex_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark("dijkstra/adstl::indexed_priority_queue<4>", BM_dijkstra_indexed<4>), config, vertex_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark("dijkstra/std::priority_queue lazy deletion", BM_dijkstra_lazy), config, vertex_size, config.max_n);
+}
+
+}
@@ -0,0 +1,133 @@
+#include "bench.hpp"
+#include "mpmc_ring.hpp"
+
+#include <mutex>
+#include <queue>
+#include <string>
+
+namespace adstl_bench
+{
+
+namespace
+{
+
+constexpr size_t ring_capacity = 1024;
+constexpr size_t batch = 32;
+
+// the mutex guarded queue mpmc_ring is meant to replace
+template <typename T>
+class locked_queue
+{
+    public:
+
+        explicit locked_queue(size_t) {}
+
+        template <typename U>
+        bool try_push(U &&element)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            data.push(std::forward<U>(element));
+            return true;
+        }
+
+        bool try_pop(T &out)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(data.empty())
+            {
+                return false;
+            }
+            out = std::move(data.front());
+            data.pop();
+            return true;
+        }
+
+    private:
+        std::mutex mutex;
+        std::queue<T> data;
+};
+
+// every thread pushes and pops on one shared queue, items are counted per thread
+template <typename Q, typename T>
+void BM_shared_push_pop(benchmark::State &state)
+{
+    static Q q(ring_capacity);
+    const T value = make_value<T>(1);
+    T out = value;
+
+    for(auto _ : state)
+    {
+        q.try_push(value);
+        q.try_pop(out);
+    }
+    benchmark::DoNotOptimize(&out);
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// the same with batch pushes and pops of up to 32 elements
+template <typename Q, typename T>
+void BM_shared_push_pop_n(benchmark::State &state)
+{
+    static Q q(ring_capacity);
+    T in[batch];
+    T out[batch];
+    for(size_t i = 0; i != batch; ++i)
+    {
+        in[i] = make_value<T>(i);
+    }
+
+    size_t items = 0;
+    for(auto _ : state)
+    {
+        items += q.try_push_n(in, batch);
+        items += q.try_pop_n(out, batch);
+    }
+    benchmark::DoNotOptimize(&out);
+    state.SetItemsProcessed(items);
+}
+
+// one producer and one consumer thread
+template <typename Q, typename T>
+void BM_producer_consumer(benchmark::State &state)
+{
+    static Q q(ring_capacity);
+    const T value = make_value<T>(1);
+    T out = value;
+
+    size_t items = 0;
+    for(auto _ : state)
+    {
+        if(state.thread_index() == 0)
+        {
+            items += q.try_push(value);
+        }
+        else
+        {
+            items += q.try_pop(out);
+        }
+    }
+    benchmark::DoNotOptimize(&out);
+    state.SetItemsProcessed(items);
+}
+
+template <typename Q, typename T>
+void register_shared(const std::string &name)
+{
+    benchmark::RegisterBenchmark((name + "/shared_push_pop").c_str(), BM_shared_push_pop<Q, T>)->ThreadRange(1, 32)->UseRealTime();
+}
+
+}
+
+void register_queue_benchmarks(const bench_config &)
+{
+    register_shared<adstl::mpmc_ring<int>, int>("adstl::mpmc_ring<int>");
+    register_shared<locked_queue<int>, int>("mutex+std::queue<int>");
+
+    benchmark::RegisterBenchmark("adstl::mpmc_ring<int>/shared_push_pop_n", BM_shared_push_pop_n<adstl::mpmc_ring<int>, int>)->ThreadRange(1, 32)->UseRealTime();
+
+    benchmark::RegisterBenchmark("adstl::mpmc_ring<int>/producer_consumer", BM_producer_consumer<adstl::mpmc_ring<int>, int>)->Threads(2)->UseRealTime();
+    benchmark::RegisterBenchmark("adstl::spsc_ring<int>/producer_consumer", BM_producer_consumer<adstl::spsc_ring<int>, int>)->Threads(2)->UseRealTime();
+    benchmark::RegisterBenchmark("mutex+std::queue<int>/producer_consumer", BM_producer_consumer<locked_queue<int>, int>)->Threads(2)->UseRealTime();
+}
+
+}
@@ -0,0 +1,209 @@
+#include "bench.hpp"
+#include "vector.hpp"
+#include "simd.hpp"
+
+#include <string>
+
+namespace adstl_bench
+{
+
+namespace
+{
+
+// what callers wrote before the kernels: plain loops through the vector iterator
+struct scalar_loops
+{
+    template <typename It, typename T>
+    static It find(It first, It last, const T &value)
+    {
+        for(; first != last; ++first)
+        {
+            if(*first == value)
+            {
+                break;
+            }
+        }
+        return first;
+    }
+
+    template <typename It, typename T>
+    static size_t count(It first, It last, const T &value)
+    {
+        size_t n = 0;
+        for(; first != last; ++first)
+        {
+            n += *first == value;
+        }
+        return n;
+    }
+
+    template <typename It>
+    static It min_element(It first, It last)
+    {
+        It best = first;
+        for(; first != last; ++first)
+        {
+            if(*first < *best)
+            {
+                best = first;
+            }
+        }
+        return best;
+    }
+
+    template <typename It, typename T>
+    static T accumulate(It first, It last, T init)
+    {
+        for(; first != last; ++first)
+        {
+            init = init + *first;
+        }
+        return init;
+    }
+
+    template <typename It1, typename It2>
+    static bool equal(It1 first, It1 last, It2 other)
+    {
+        for(; first != last; ++first, ++other)
+        {
+            if(!(*first == *other))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename It, typename T>
+    static void fill(It first, It last, const T &value)
+    {
+        for(; first != last; ++first)
+        {
+            *first = value;
+        }
+    }
+};
+
+struct simd_kernels
+{
+    template <typename It, typename T>
+    static It find(It first, It last, const T &value) { return adstl::simd::find(first, last, value); }
+
+    template <typename It, typename T>
+    static size_t count(It first, It last, const T &value) { return adstl::simd::count(first, last, value); }
+
+    template <typename It>
+    static It min_element(It first, It last) { return adstl::simd::min_element(first, last); }
+
+    template <typename It, typename T>
+    static T accumulate(It first, It last, T init) { return adstl::simd::accumulate(first, last, init); }
+
+    template <typename It1, typename It2>
+    static bool equal(It1 first, It1 last, It2 other) { return adstl::simd::equal(first, last, other); }
+
+    template <typename It, typename T>
+    static void fill(It first, It last, const T &value) { adstl::simd::fill(first, last, value); }
+};
+
+template <typename T>
+adstl::vector<T> make_data(size_t n)
+{
+    adstl::vector<T> v;
+    v.reserve(n);
+    for(size_t i = 0; i != n; ++i)
+    {
+        v.push_back(static_cast<T>(i % 1000));
+    }
+    return v;
+}
+
+enum class op
+{
+    find,
+    count,
+    min_element,
+    accumulate,
+    equal,
+    fill
+};
+
+template <typename Impl, typename T, op Op>
+void BM_kernel(benchmark::State &state, adstl::simd::isa level)
+{
+    const size_t n = state.range(0);
+    adstl::vector<T> v = make_data<T>(n);
+    adstl::vector<T> w = v;
+    const T missing = static_cast<T>(-1);
+
+    adstl::simd::set_max_isa(level);
+    for(auto _ : state)
+    {
+        if constexpr (Op == op::find)
+        {
+            benchmark::DoNotOptimize(Impl::find(v.begin(), v.end(), missing));
+        }
+        else if constexpr (Op == op::count)
+        {
+            benchmark::DoNotOptimize(Impl::count(v.begin(), v.end(), T(7)));
+        }
+        else if constexpr (Op == op::min_element)
+        {
+            benchmark::DoNotOptimize(Impl::min_element(v.begin(), v.end()));
+        }
+        else if constexpr (Op == op::accumulate)
+        {
+            benchmark::DoNotOptimize(Impl::accumulate(v.begin(), v.end(), T(0)));
+        }
+        else if constexpr (Op == op::equal)
+        {
+            benchmark::DoNotOptimize(Impl::equal(v.begin(), v.end(), w.begin()));
+        }
+        else
+        {
+            Impl::fill(v.begin(), v.end(), T(3));
+            benchmark::ClobberMemory();
+        }
+    }
+    adstl::simd::set_max_isa(adstl::simd::isa::avx512);
+
+    state.SetBytesProcessed(state.iterations() * n * sizeof(T));
+}
+
+template <typename T, op Op>
+void register_op(const std::string &name, const bench_config &config)
+{
+    using adstl::simd::isa;
+
+    apply_sizes(benchmark::RegisterBenchmark((name + "/scalar_loop").c_str(), BM_kernel<scalar_loops, T, Op>, isa::scalar), config, 2 * sizeof(T), config.max_n);
+
+    const std::pair<isa, const char*> levels[] = {{isa::sse2, "/sse2"}, {isa::avx2, "/avx2"}, {isa::avx512, "/avx512"}};
+    for(const auto &level : levels)
+    {
+        if(level.first <= adstl::simd::detected_isa())
+        {
+            apply_sizes(benchmark::RegisterBenchmark((name + level.second).c_str(), BM_kernel<simd_kernels, T, Op>, level.first), config, 2 * sizeof(T), config.max_n);
+        }
+    }
+}
+
+template <typename T>
+void register_element(const std::string &type_name, const bench_config &config)
+{
+    register_op<T, op::find>("simd::find<" + type_name + ">", config);
+    register_op<T, op::count>("simd::count<" + type_name + ">", config);
+    register_op<T, op::min_element>("simd::min_element<" + type_name + ">", config);
+    register_op<T, op::accumulate>("simd::accumulate<" + type_name + ">", config);
+    register_op<T, op::equal>("simd::equal<" + type_name + ">", config);
+    register_op<T, op::fill>("simd::fill<" + type_name + ">", config);
+}
+
+}
+
+void register_simd_benchmarks(const bench_config &config)
+{
+    register_element<int>("int", config);
+    register_element<float>("float", config);
+    register_element<double>("double", config);
+}
+
+}
@@ -0,0 +1,223 @@
+#include "bench.hpp"
+#include "indexed_skiplist.hpp"
+#include "sllist.hpp"
+#include "unrolled_list.hpp"
+
+#include <forward_list>
+#include <iterator>
+#include <string>
+
+namespace adstl_bench
+{
+
+namespace
+{
+
+// std::forward_list has no push_back or operator[], keep a tail iterator to give it the same ops
+template <typename T>
+class forward_list_adapter
+{
+    public:
+
+        forward_list_adapter() : tail(list.before_begin()) {}
+
+        auto begin() { return list.begin(); }
+        auto end() { return list.end(); }
+
+        void push_back(const T &value) { tail = list.insert_after(tail, value); }
+        void insert(size_t pos, const T &value) { list.insert_after(std::next(list.before_begin(), pos), value); }
+        T& operator[](size_t pos) { return *std::next(list.begin(), pos); }
+        void reverse() { list.reverse(); }
+
+    private:
+        std::forward_list<T> list;
+        typename std::forward_list<T>::iterator tail;
+};
+
+template <typename L>
+void fill(L &list, size_t n)
+{
+    using T = element_t<L>;
+    for(size_t i = 0; i != n; ++i)
+    {
+        list.push_back(make_value<T>(i));
+    }
+}
+
+template <typename L>
+void BM_push_back(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    for(auto _ : state)
+    {
+        L list;
+        fill(list, n);
+        benchmark::DoNotOptimize(&*list.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// sum of all elements, measures how well the traversal uses the cache
+template <typename L>
+void BM_iterate(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    L list;
+    fill(list, n);
+
+    for(auto _ : state)
+    {
+        size_t sum = 0;
+        for(auto b = list.begin(); b != list.end(); ++b)
+        {
+            sum += *reinterpret_cast<const unsigned char*>(&*b);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// insert in the middle, the walk to n/2 dominates
+template <typename L>
+void BM_insert_middle(benchmark::State &state)
+{
+    using T = element_t<L>;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+
+    L list;
+    fill(list, n);
+
+    for(auto _ : state)
+    {
+        list.insert(n / 2, value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename L>
+void BM_index_middle(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    L list;
+    fill(list, n);
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(&list[n / 2]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// list[i] for every i in increasing order, the access pattern of index based loops
+template <typename L>
+void BM_index_sequential(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    L list;
+    fill(list, n);
+
+    for(auto _ : state)
+    {
+        for(size_t i = 0; i != n; ++i)
+        {
+            benchmark::DoNotOptimize(&list[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename L>
+void BM_reverse(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    L list;
+    fill(list, n);
+
+    for(auto _ : state)
+    {
+        list.reverse();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// containers without a cursor or an index pay O(n) per access in BM_index_sequential,
+// sequential_max_n keeps them from running for minutes
+// assign a list of the same length over an existing one
+template <typename L>
+void BM_copy_assign(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    L source, target;
+    fill(source, n);
+    fill(target, n);
+
+    for(auto _ : state)
+    {
+        target = source;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename L>
+void BM_clear_refill(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    L list;
+    fill(list, n);
+
+    for(auto _ : state)
+    {
+        list.clear();
+        fill(list, n);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename L>
+void register_container(const std::string &name, const bench_config &config, size_t sequential_max_n)
+{
+    // a node holds the element and a pointer
+    const size_t node_size = sizeof(element_t<L>) + sizeof(void*);
+
+    apply_sizes(benchmark::RegisterBenchmark((name + "/push_back").c_str(), BM_push_back<L>), config, node_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/iterate").c_str(), BM_iterate<L>), config, node_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/insert_middle").c_str(), BM_insert_middle<L>), config, node_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/operator[]").c_str(), BM_index_middle<L>), config, node_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/operator[]_sequential").c_str(), BM_index_sequential<L>), config, node_size, sequential_max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/reverse").c_str(), BM_reverse<L>), config, node_size, config.max_n);
+}
+
+template <typename T>
+void register_element(const std::string &type_name, const bench_config &config)
+{
+    register_container<adstl::sllist<T>>("adstl::sllist<" + type_name + ">", config, config.max_n);
+    const size_t node_size = sizeof(T) + sizeof(void*);
+    apply_sizes(benchmark::RegisterBenchmark(("adstl::sllist<" + type_name + ">/copy_assign").c_str(), BM_copy_assign<adstl::sllist<T>>), config, 2 * node_size, config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark(("adstl::sllist<" + type_name + ">/clear_refill").c_str(), BM_clear_refill<adstl::sllist<T>>), config, node_size, config.max_n);
+    register_container<adstl::unrolled_list<T>>("adstl::unrolled_list<" + type_name + ">", config, 100000);
+    register_container<adstl::indexed_skiplist<T>>("adstl::indexed_skiplist<" + type_name + ">", config, config.max_n);
+    register_container<forward_list_adapter<T>>("std::forward_list<" + type_name + ">", config, 10000);
+}
+
+}
+
+void register_sllist_benchmarks(const bench_config &config)
+{
+    register_element<int>("int", config);
+    register_element<payload<16>>("payload<16>", config);
+    register_element<payload<64>>("payload<64>", config);
+    register_element<payload<256>>("payload<256>", config);
+}
+
+}
@@ -0,0 +1,144 @@
+#include "bench.hpp"
+#include "stack.hpp"
+#include "concurrent_stack.hpp"
+
+#include <mutex>
+#include <stack>
+#include <string>
+#include <vector>
+
+namespace adstl_bench
+{
+
+namespace
+{
+
+template <typename S, typename T>
+void BM_push_pop(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+
+    for(auto _ : state)
+    {
+        S s;
+        for(size_t i = 0; i != n; ++i)
+        {
+            s.push(value);
+        }
+        benchmark::DoNotOptimize(&s.top());
+        for(size_t i = 0; i != n; ++i)
+        {
+            s.pop();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n * 2);
+}
+
+// latency of every single push, relocation on growth shows up in the max/p99 counters
+template <typename S, typename T>
+void BM_push_latency(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+
+    for(auto _ : state)
+    {
+        latency_recorder recorder(n);
+        S s;
+        for(size_t i = 0; i != n; ++i)
+        {
+            recorder.measure([&] { s.push(value); });
+        }
+        benchmark::DoNotOptimize(&s.top());
+
+        state.PauseTiming();
+        recorder.report(state);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// the mutex guarded stack concurrent_stack is meant to replace
+template <typename T>
+class locked_stack
+{
+    public:
+
+        template <typename U>
+        void push(U &&element)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            data.push(std::forward<U>(element));
+        }
+
+        bool try_pop(T &out)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(data.empty())
+            {
+                return false;
+            }
+            out = std::move(data.top());
+            data.pop();
+            return true;
+        }
+
+    private:
+        std::mutex mutex;
+        adstl::stack<T> data;
+};
+
+// every thread pushes and pops on one shared stack, items are counted per thread
+template <typename S, typename T>
+void BM_shared_push_pop(benchmark::State &state)
+{
+    static S s;
+    const T value = make_value<T>(1);
+    T out = value;
+
+    for(auto _ : state)
+    {
+        s.push(value);
+        s.try_pop(out);
+    }
+    benchmark::DoNotOptimize(&out);
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+template <typename S, typename T>
+void register_shared(const std::string &name)
+{
+    benchmark::RegisterBenchmark((name + "/shared_push_pop").c_str(), BM_shared_push_pop<S, T>)->ThreadRange(1, 32)->UseRealTime();
+}
+
+template <typename S, typename T>
+void register_container(const std::string &name, const bench_config &config)
+{
+    apply_sizes(benchmark::RegisterBenchmark((name + "/push_pop").c_str(), BM_push_pop<S, T>), config, sizeof(T), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/push_latency").c_str(), BM_push_latency<S, T>)->Iterations(1), config, sizeof(T) + sizeof(double), 10000000);
+}
+
+template <typename T>
+void register_element(const std::string &type_name, const bench_config &config)
+{
+    register_container<adstl::stack<T>, T>("adstl::stack<" + type_name + ">", config);
+    register_container<adstl::segmented_stack<T>, T>("adstl::segmented_stack<" + type_name + ">", config);
+    register_container<std::stack<T>, T>("std::stack<" + type_name + ">", config);
+    register_container<std::stack<T, std::vector<T>>, T>("std::stack<" + type_name + ", std::vector>", config);
+}
+
+}
+
+void register_stack_benchmarks(const bench_config &config)
+{
+    register_element<int>("int", config);
+    register_element<payload<16>>("payload<16>", config);
+    register_element<payload<64>>("payload<64>", config);
+    register_element<payload<256>>("payload<256>", config);
+
+    register_shared<adstl::concurrent_stack<int>, int>("adstl::concurrent_stack<int>");
+    register_shared<locked_stack<int>, int>("mutex+adstl::stack<int>");
+}
+
+}
@@ -0,0 +1,242 @@
+#include "bench.hpp"
+#include "vector.hpp"
+#include "small_vector.hpp"
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace adstl_bench
+{
+
+namespace
+{
+
+template <typename V>
+void BM_push_back(benchmark::State &state)
+{
+    using T = element_t<V>;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+
+    for(auto _ : state)
+    {
+        V v;
+        for(size_t i = 0; i != n; ++i)
+        {
+            v.push_back(value);
+        }
+        benchmark::DoNotOptimize(&v[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename V>
+void BM_emplace_back(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+
+    for(auto _ : state)
+    {
+        V v;
+        for(size_t i = 0; i != n; ++i)
+        {
+            v.emplace_back(i);
+        }
+        benchmark::DoNotOptimize(&v[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// latency of every single push_back, growth steps show up in the max/p99 counters
+template <typename V>
+void BM_push_back_latency(benchmark::State &state)
+{
+    using T = element_t<V>;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+
+    for(auto _ : state)
+    {
+        latency_recorder recorder(n);
+        V v;
+        for(size_t i = 0; i != n; ++i)
+        {
+            recorder.measure([&] { v.push_back(value); });
+        }
+        benchmark::DoNotOptimize(&v[0]);
+
+        state.PauseTiming();
+        recorder.report(state);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// one insert in the middle of an n element vector per iteration
+template <typename V>
+void BM_insert_middle(benchmark::State &state)
+{
+    using T = element_t<V>;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+
+    V v;
+    for(size_t i = 0; i != n; ++i)
+    {
+        v.push_back(value);
+    }
+
+    for(auto _ : state)
+    {
+        v.insert(v.cbegin() + n / 2, value);
+        v.pop_back();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename V>
+void BM_copy(benchmark::State &state)
+{
+    using T = element_t<V>;
+    const size_t n = state.range(0);
+
+    V src;
+    for(size_t i = 0; i != n; ++i)
+    {
+        src.push_back(make_value<T>(i));
+    }
+
+    for(auto _ : state)
+    {
+        V copy(src);
+        benchmark::DoNotOptimize(&copy[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n * sizeof(T));
+}
+
+template <typename V>
+void BM_move(benchmark::State &state)
+{
+    using T = element_t<V>;
+    const size_t n = state.range(0);
+
+    V src;
+    for(size_t i = 0; i != n; ++i)
+    {
+        src.push_back(make_value<T>(i));
+    }
+
+    for(auto _ : state)
+    {
+        V moved(std::move(src));
+        benchmark::DoNotOptimize(&moved[0]);
+        src = std::move(moved);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// short lived vectors with a handful of elements, where the first allocation dominates
+template <typename V>
+void BM_short_lived(benchmark::State &state)
+{
+    using T = element_t<V>;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+
+    for(auto _ : state)
+    {
+        V v;
+        for(size_t i = 0; i != n; ++i)
+        {
+            v.push_back(value);
+        }
+        benchmark::DoNotOptimize(&v[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// discards everything, so only the formatting is measured
+class null_buffer : public std::streambuf
+{
+    protected:
+        int_type overflow(int_type c) override { return c; }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// operator<< against the element by element loop it replaced
+template <typename T, bool Buffered>
+void BM_print(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    adstl::vector<T> v;
+    for(size_t i = 0; i != n; ++i)
+    {
+        v.push_back(static_cast<T>(i * 7919 % 1000003) / T(7));
+    }
+
+    null_buffer sink;
+    std::ostream os(&sink);
+
+    for(auto _ : state)
+    {
+        if constexpr (Buffered)
+        {
+            os << v;
+        }
+        else
+        {
+            for(auto it = v.cbegin(); it != v.cend(); ++it)
+            {
+                os << *it << " ";
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename V>
+void register_container(const std::string &name, const bench_config &config)
+{
+    using T = element_t<V>;
+
+    apply_sizes(benchmark::RegisterBenchmark((name + "/push_back").c_str(), BM_push_back<V>), config, sizeof(T), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/emplace_back").c_str(), BM_emplace_back<V>), config, sizeof(T), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/push_back_latency").c_str(), BM_push_back_latency<V>)->Iterations(1), config, sizeof(T) + sizeof(double), 10000000);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/insert_middle").c_str(), BM_insert_middle<V>), config, sizeof(T), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/copy").c_str(), BM_copy<V>), config, 2 * sizeof(T), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark((name + "/move").c_str(), BM_move<V>), config, sizeof(T), config.max_n);
+}
+
+template <typename T>
+void register_element(const std::string &type_name, const bench_config &config)
+{
+    register_container<adstl::vector<T>>("adstl::vector<" + type_name + ">", config);
+    register_container<std::vector<T>>("std::vector<" + type_name + ">", config);
+}
+
+}
+
+void register_vector_benchmarks(const bench_config &config)
+{
+    register_element<int>("int", config);
+    register_element<payload<16>>("payload<16>", config);
+    register_element<payload<64>>("payload<64>", config);
+    register_element<payload<256>>("payload<256>", config);
+
+    for(auto *b : { benchmark::RegisterBenchmark("adstl::vector<int>/short_lived", BM_short_lived<adstl::vector<int>>),
+                    benchmark::RegisterBenchmark("adstl::small_vector<int, 16>/short_lived", BM_short_lived<adstl::small_vector<int, 16>>),
+                    benchmark::RegisterBenchmark("std::vector<int>/short_lived", BM_short_lived<std::vector<int>>) })
+    {
+        b->Arg(4)->Arg(8)->Arg(16);
+    }
+
+    apply_sizes(benchmark::RegisterBenchmark("adstl::vector<int>/print", BM_print<int, true>), config, sizeof(int), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark("adstl::vector<int>/print_per_element", BM_print<int, false>), config, sizeof(int), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark("adstl::vector<double>/print", BM_print<double, true>), config, sizeof(double), config.max_n);
+    apply_sizes(benchmark::RegisterBenchmark("adstl::vector<double>/print_per_element", BM_print<double, false>), config, sizeof(double), config.max_n);
+}
+
+}
@@ -0,0 +1,321 @@
+/*
+    PARALLEL ALGORITHMS
+*/
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "thread_pool.hpp"
+
+namespace adstl
+{
+
+namespace parallel
+{
+
+// Parallel algorithms over contiguous ranges: adstl::vector and adstl::small_vector
+// iterators, raw pointers, or anything else where &*it addresses contiguous memory and
+// last - first gives the length.
+//
+//     adstl::vector<int> v = ...;
+//     adstl::parallel::sort(v.begin(), v.end());
+//     long total = adstl::parallel::reduce(v.begin(), v.end(), 0L);
+//
+// Work runs on thread_pool::default_pool(). Ranges shorter than grain_size() elements run
+// sequentially on the calling thread, longer ones are cut into chunks of at least
+// grain_size() elements. Functions passed in must be safe to call concurrently.
+
+inline std::atomic<size_t> &grain_size_setting()
+{
+    static std::atomic<size_t> grain(4096);
+    return grain;
+}
+
+inline size_t grain_size() { return grain_size_setting().load(std::memory_order_relaxed); }
+inline void set_grain_size(size_t grain) { grain_size_setting().store(grain ? grain : 1, std::memory_order_relaxed); }
+
+namespace detail
+{
+
+template <typename It>
+using value_t = std::decay_t<decltype(*std::declval<It&>())>;
+
+template <typename It>
+size_t distance(It first, It last)
+{
+    return static_cast<size_t>(last - first);
+}
+
+// raw pointer to the first element, only called on non empty ranges
+template <typename It>
+auto data(It first)
+{
+    return std::addressof(*first);
+}
+
+// number of chunks to split n elements into, 1 means run sequentially
+inline size_t chunk_count(size_t n)
+{
+    size_t grain = grain_size();
+    if(n < 2 * grain)
+    {
+        return 1;
+    }
+
+    // a few chunks per worker so stealing can even out uneven chunks
+    size_t max_chunks = thread_pool::default_pool().size() * 4;
+    return std::min(n / grain, max_chunks);
+}
+
+// calls f(chunk, begin, end) for every chunk of [0, n) in parallel
+template <typename F>
+void for_chunks(size_t n, size_t chunks, F &&f)
+{
+    thread_pool::task_group group;
+    for(size_t c = 1; c < chunks; ++c)
+    {
+        group.run([&f, c, n, chunks] { f(c, n * c / chunks, n * (c + 1) / chunks); });
+    }
+    f(0, 0, n / chunks);
+    group.wait();
+}
+
+}
+
+template <typename It, typename F>
+void for_each(It first, It last, F f)
+{
+    size_t n = detail::distance(first, last);
+    if(n == 0)
+    {
+        return;
+    }
+
+    auto p = detail::data(first);
+    detail::for_chunks(n, detail::chunk_count(n), [&](size_t, size_t begin, size_t end) {
+        std::for_each(p + begin, p + end, f);
+    });
+}
+
+// d_first may be first (in place), otherwise the ranges must not overlap
+template <typename It, typename Out, typename F>
+Out transform(It first, It last, Out d_first, F op)
+{
+    size_t n = detail::distance(first, last);
+    if(n == 0)
+    {
+        return d_first;
+    }
+
+    auto p = detail::data(first);
+    auto d = detail::data(d_first);
+    detail::for_chunks(n, detail::chunk_count(n), [&](size_t, size_t begin, size_t end) {
+        std::transform(p + begin, p + end, d + begin, op);
+    });
+
+    return d_first + n;
+}
+
+// op has to be associative, chunks are combined left to right
+template <typename It, typename T, typename Op = std::plus<>>
+T reduce(It first, It last, T init, Op op = Op())
+{
+    size_t n = detail::distance(first, last);
+    if(n == 0)
+    {
+        return init;
+    }
+
+    auto p = detail::data(first);
+    size_t chunks = detail::chunk_count(n);
+    if(chunks == 1)
+    {
+        return std::accumulate(p, p + n, std::move(init), op);
+    }
+
+    // each chunk starts from its first element, so no identity element is needed
+    std::vector<T> partial(chunks, init);
+    detail::for_chunks(n, chunks, [&](size_t c, size_t begin, size_t end) {
+        partial[c] = std::accumulate(p + begin + 1, p + end, T(p[begin]), op);
+    });
+
+    for(T &value : partial)
+    {
+        init = op(std::move(init), std::move(value));
+    }
+    return init;
+}
+
+// d_first may be first (in place), otherwise the ranges must not overlap; op has to be associative
+template <typename It, typename Out, typename Op = std::plus<>>
+Out inclusive_scan(It first, It last, Out d_first, Op op = Op())
+{
+    using T = detail::value_t<It>;
+
+    size_t n = detail::distance(first, last);
+    if(n == 0)
+    {
+        return d_first;
+    }
+
+    auto p = detail::data(first);
+    auto d = detail::data(d_first);
+    size_t chunks = detail::chunk_count(n);
+
+    // scan every chunk on its own, then add the total of everything before it
+    detail::for_chunks(n, chunks, [&](size_t, size_t begin, size_t end) {
+        std::partial_sum(p + begin, p + end, d + begin, op);
+    });
+
+    if(chunks > 1)
+    {
+        std::vector<T> offset;
+        offset.reserve(chunks);
+        offset.push_back(d[n / chunks - 1]);
+        for(size_t c = 1; c + 1 < chunks; ++c)
+        {
+            offset.push_back(op(offset.back(), d[n * (c + 1) / chunks - 1]));
+        }
+
+        detail::for_chunks(n, chunks, [&](size_t c, size_t begin, size_t end) {
+            if(c == 0)
+            {
+                return;
+            }
+            const T &carry = offset[c - 1];
+            for(size_t i = begin; i != end; ++i)
+            {
+                d[i] = op(carry, d[i]);
+            }
+        });
+    }
+
+    return d_first + n;
+}
+
+// merge sort: chunks are sorted in parallel, then merged pairwise in parallel rounds
+template <typename It, typename Compare = std::less<>>
+void sort(It first, It last, Compare comp = Compare())
+{
+    size_t n = detail::distance(first, last);
+    if(n == 0)
+    {
+        return;
+    }
+
+    auto p = detail::data(first);
+    size_t chunks = detail::chunk_count(n);
+    if(chunks == 1)
+    {
+        std::sort(p, p + n, comp);
+        return;
+    }
+
+    std::vector<size_t> bounds(chunks + 1);
+    for(size_t c = 0; c <= chunks; ++c)
+    {
+        bounds[c] = n * c / chunks;
+    }
+
+    detail::for_chunks(n, chunks, [&](size_t c, size_t, size_t) {
+        std::sort(p + bounds[c], p + bounds[c + 1], comp);
+    });
+
+    for(size_t width = 1; width < chunks; width *= 2)
+    {
+        thread_pool::task_group group;
+        for(size_t c = 0; c + width < chunks; c += 2 * width)
+        {
+            size_t begin = bounds[c];
+            size_t middle = bounds[c + width];
+            size_t end = bounds[std::min(c + 2 * width, chunks)];
+            group.run([=, &comp] { std::inplace_merge(p + begin, p + middle, p + end, comp); });
+        }
+        group.wait();
+    }
+}
+
+// stable, returns the iterator to the first element for which pred is false
+template <typename It, typename Pred>
+It partition(It first, It last, Pred pred)
+{
+    using T = detail::value_t<It>;
+
+    size_t n = detail::distance(first, last);
+    if(n == 0)
+    {
+        return first;
+    }
+
+    auto p = detail::data(first);
+    size_t chunks = detail::chunk_count(n);
+
+    // the scatter below can not be undone halfway if a move throws
+    if(chunks == 1 || !std::is_nothrow_move_constructible_v<T> || !std::is_nothrow_move_assignable_v<T>)
+    {
+        return first + (std::stable_partition(p, p + n, pred) - p);
+    }
+
+    // 1. evaluate pred once per element and count the matches of every chunk
+    std::unique_ptr<bool[]> keep(new bool[n]);
+    std::vector<size_t> matches(chunks);
+    detail::for_chunks(n, chunks, [&](size_t c, size_t begin, size_t end) {
+        size_t count = 0;
+        for(size_t i = begin; i != end; ++i)
+        {
+            keep[i] = static_cast<bool>(pred(p[i]));
+            count += keep[i];
+        }
+        matches[c] = count;
+    });
+
+    // 2. where every chunk writes its matches and the rest
+    std::vector<size_t> true_pos(chunks), false_pos(chunks);
+    size_t total = std::accumulate(matches.begin(), matches.end(), size_t(0));
+    for(size_t c = 0, t = 0, f = total; c < chunks; ++c)
+    {
+        true_pos[c] = t;
+        false_pos[c] = f;
+        t += matches[c];
+        f += (n * (c + 1) / chunks - n * c / chunks) - matches[c];
+    }
+
+    // 3. scatter into a buffer and move back
+    std::allocator<T> alloc;
+    T *buffer = alloc.allocate(n);
+
+    detail::for_chunks(n, chunks, [&](size_t c, size_t begin, size_t end) {
+        size_t t = true_pos[c], f = false_pos[c];
+        for(size_t i = begin; i != end; ++i)
+        {
+            ::new (static_cast<void*>(buffer + (keep[i] ? t++ : f++))) T(std::move(p[i]));
+        }
+    });
+
+    detail::for_chunks(n, chunks, [&](size_t, size_t begin, size_t end) {
+        for(size_t i = begin; i != end; ++i)
+        {
+            p[i] = std::move(buffer[i]);
+            buffer[i].~T();
+        }
+    });
+
+    alloc.deallocate(buffer, n);
+
+    return first + total;
+}
+
+}
+
+}
+
+#endif
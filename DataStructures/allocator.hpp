@@ -0,0 +1,249 @@
+/*
+    ALLOCATORS
+*/
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace adstl
+{
+
+// Bump pointer arena. Memory is carved out of geometrically growing chunks and is never
+// returned one allocation at a time, release() drops all of the chunks at once.
+// Not thread safe, an arena is meant to be owned by one request/thread.
+class monotonic_arena final
+{
+    public:
+
+        explicit monotonic_arena(size_t initial_size = 4096)
+            : current(nullptr), cursor(nullptr), end(nullptr),
+              initial_size(initial_size), next_size(initial_size), allocated(0) {}
+        monotonic_arena(const monotonic_arena&) = delete;
+        monotonic_arena& operator=(const monotonic_arena&) = delete;
+        ~monotonic_arena() { release(); }
+
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+        void deallocate(void*, size_t, size_t = alignof(std::max_align_t)) noexcept {} // memory is reclaimed by release()
+        void release() noexcept;
+
+        size_t bytes_allocated() const { return allocated; }
+
+    private:
+
+        struct chunk
+        {
+            chunk *prev;
+        };
+
+        void grow(size_t);
+
+        chunk *current;
+        char *cursor;
+        char *end;
+        size_t initial_size;
+        size_t next_size;
+        size_t allocated;
+};
+
+inline void* monotonic_arena::allocate(size_t bytes, size_t alignment)
+{
+    std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(cursor) + alignment - 1) & ~(alignment - 1);
+
+    if(current == nullptr || p + bytes > reinterpret_cast<std::uintptr_t>(end))
+    {
+        grow(bytes + alignment);
+        p = (reinterpret_cast<std::uintptr_t>(cursor) + alignment - 1) & ~(alignment - 1);
+    }
+
+    cursor = reinterpret_cast<char*>(p + bytes);
+    allocated += bytes;
+
+    return reinterpret_cast<void*>(p);
+}
+
+inline void monotonic_arena::grow(size_t min_size)
+{
+    size_t chunk_size = next_size > min_size + sizeof(chunk) ? next_size : min_size + sizeof(chunk);
+
+    char *raw = static_cast<char*>(::operator new(chunk_size));
+    chunk *new_chunk = reinterpret_cast<chunk*>(raw);
+    new_chunk->prev = current;
+
+    current = new_chunk;
+    cursor = raw + sizeof(chunk);
+    end = raw + chunk_size;
+    next_size = chunk_size * 2;
+}
+
+inline void monotonic_arena::release() noexcept
+{
+    while(current)
+    {
+        chunk *prev = current->prev;
+        ::operator delete(static_cast<void*>(current));
+        current = prev;
+    }
+
+    cursor = end = nullptr;
+    next_size = initial_size;
+    allocated = 0;
+}
+
+// Fixed size block pool on top of a monotonic_arena. Small requests are rounded up to a
+// size class and recycled through a per-class free list, bigger ones go straight to the
+// arena. release() returns everything to the system at once.
+class block_pool final
+{
+    public:
+
+        explicit block_pool(size_t initial_size = 4096) : arena(initial_size), free_lists() {}
+        block_pool(const block_pool&) = delete;
+        block_pool& operator=(const block_pool&) = delete;
+
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+        void deallocate(void*, size_t bytes, size_t alignment = alignof(std::max_align_t)) noexcept;
+        void release() noexcept;
+
+        size_t bytes_allocated() const { return arena.bytes_allocated(); }
+
+    private:
+
+        static constexpr size_t granularity = alignof(std::max_align_t);
+        static constexpr size_t max_block_size = 512;
+
+        struct free_block
+        {
+            free_block *next;
+        };
+
+        static bool pooled(size_t bytes, size_t alignment)
+        {
+            return bytes <= max_block_size && alignment <= granularity;
+        }
+
+        static size_t size_class(size_t bytes)
+        {
+            return bytes ? (bytes - 1) / granularity : 0;
+        }
+
+        monotonic_arena arena;
+        free_block *free_lists[max_block_size / granularity];
+};
+
+inline void* block_pool::allocate(size_t bytes, size_t alignment)
+{
+    if(!pooled(bytes, alignment))
+    {
+        return arena.allocate(bytes, alignment);
+    }
+
+    size_t index = size_class(bytes);
+    if(free_block *block = free_lists[index])
+    {
+        free_lists[index] = block->next;
+        return block;
+    }
+
+    return arena.allocate((index + 1) * granularity, granularity);
+}
+
+inline void block_pool::deallocate(void *p, size_t bytes, size_t alignment) noexcept
+{
+    if(p == nullptr || !pooled(bytes, alignment))
+    {
+        return;
+    }
+
+    size_t index = size_class(bytes);
+    free_block *block = ::new (p) free_block;
+    block->next = free_lists[index];
+    free_lists[index] = block;
+}
+
+inline void block_pool::release() noexcept
+{
+    for(free_block *&list : free_lists)
+    {
+        list = nullptr;
+    }
+    arena.release();
+}
+
+// STL allocator handing out memory from a monotonic_arena.
+// Containers keep their arena on copy/move assignment and swap, like std::pmr allocators.
+template <typename T>
+class arena_allocator final
+{
+    template <typename> friend class arena_allocator;
+
+    public:
+
+        using value_type = T;
+
+        explicit arena_allocator(monotonic_arena &arena) noexcept : arena(&arena) {}
+        template <typename U> arena_allocator(const arena_allocator<U> &rhs) noexcept : arena(rhs.arena) {}
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *p, size_t n) noexcept
+        {
+            arena->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        monotonic_arena* resource() const { return arena; }
+
+        template <typename U>
+        bool operator==(const arena_allocator<U> &rhs) const { return arena == rhs.arena; }
+        template <typename U>
+        bool operator!=(const arena_allocator<U> &rhs) const { return arena != rhs.arena; }
+
+    private:
+        monotonic_arena *arena;
+};
+
+// STL allocator handing out fixed size blocks from a block_pool, freed blocks are reused.
+// Containers keep their pool on copy/move assignment and swap, like std::pmr allocators.
+template <typename T>
+class pool_allocator final
+{
+    template <typename> friend class pool_allocator;
+
+    public:
+
+        using value_type = T;
+
+        explicit pool_allocator(block_pool &pool) noexcept : pool(&pool) {}
+        template <typename U> pool_allocator(const pool_allocator<U> &rhs) noexcept : pool(rhs.pool) {}
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(pool->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *p, size_t n) noexcept
+        {
+            pool->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        block_pool* resource() const { return pool; }
+
+        template <typename U>
+        bool operator==(const pool_allocator<U> &rhs) const { return pool == rhs.pool; }
+        template <typename U>
+        bool operator!=(const pool_allocator<U> &rhs) const { return pool != rhs.pool; }
+
+    private:
+        block_pool *pool;
+};
+
+}
+
+#endif
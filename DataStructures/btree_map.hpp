@@ -0,0 +1,1561 @@
+/*
+    BTREE MAP
+*/
+
+#ifndef BTREE_MAP_H
+#define BTREE_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "config.hpp" // Include the configuration header
+#include "type_traits.hpp"
+#include "vector.hpp"
+#include "expected.hpp"
+#include "instrumentation.hpp"
+
+namespace adstl
+{
+
+// Ordered map and set on a B+tree. The elements live in the leaves only, up to a few dozen
+// side by side in one node, and the leaves are linked in key order:
+//
+//     inner           [ k0 | k1 ]                separator keys and child pointers
+//                    /     |     \    (a < k0 <= d < k1 <= f)
+//     leaves  [a b c] <-> [d e] <-> [f g]        sorted elements, prev/next links
+//
+// A node is NodeBytes big (256, four cache lines) and starts on a cache line, so a lookup
+// touches log_B(n) nodes instead of the log2(n) scattered nodes of a red-black tree, and
+// lower_bound followed by ++ walks the leaves without going back through the parents.
+// Insert and erase are O(log n); full nodes are split, nodes that drop below half full
+// borrow from or are merged with a sibling. Appending in key order splits the last leaf
+// unevenly, so a tree built by ascending inserts stays packed.
+//
+// A sorted range is bulk loaded in O(n) into packed leaves, the inner levels are built
+// bottom up on top of them:
+//
+//     adstl::btree_map<int, int> index(adstl::sorted_unique, std::move(sorted_vector));
+//
+// insert(first, last) into an empty tree takes the same path when the range turns out
+// to be sorted.
+//
+// The inner nodes hold copies of keys, so Key has to be copy constructible, and the
+// elements and keys have to be nothrow move constructible to be shifted inside nodes.
+// Every insert or erase invalidates iterators. The map stores std::pair<Key, T>, the key
+// must not be changed through an iterator.
+
+template <typename Key, typename T, typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<Key, T>>, size_t NodeBytes = 256>
+class btree_map;
+
+template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>, size_t NodeBytes = 256>
+class btree_set;
+
+// tag for the constructors that take a range already sorted by key without duplicates
+struct sorted_unique_t { explicit sorted_unique_t() = default; };
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace detail
+{
+
+template <typename Compare, typename = void>
+inline constexpr bool is_transparent_compare_v = false;
+
+template <typename Compare>
+inline constexpr bool is_transparent_compare_v<Compare, std::void_t<typename Compare::is_transparent>> = true;
+
+// slots of a node of the given size: header bytes first, then per bytes a slot, at least 4
+constexpr size_t slots_for(size_t bytes, size_t header, size_t per)
+{
+    return bytes > header + 4 * per ? (bytes - header) / per : 4;
+}
+
+// the code shared by btree_map and btree_set, Policy says how an element holds its key
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+class btree
+{
+    public:
+
+        using key_type = typename Policy::key_type;
+        using value_type = typename Policy::value_type;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = Compare;
+        using allocator_type = Allocator;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+
+        static_assert(std::is_nothrow_move_constructible_v<value_type> && std::is_nothrow_move_constructible_v<key_type>,
+                      "btree: elements and keys have to be nothrow move constructible");
+
+        // elements per leaf and separator keys per inner node: a leaf has a count and two
+        // links in front of its elements, an inner node a count and one child more than keys
+        static constexpr size_t leaf_slots = slots_for(NodeBytes, (sizeof(size_t) + 2 * sizeof(void*) + alignof(value_type) - 1) / alignof(value_type) * alignof(value_type), sizeof(value_type));
+        static constexpr size_t inner_slots = slots_for(NodeBytes, sizeof(size_t) + sizeof(void*), sizeof(key_type) + sizeof(void*));
+
+    private:
+
+        struct node_base
+        {
+            size_t count; // elements of a leaf, keys of an inner node
+        };
+
+        struct alignas(64) leaf_node : node_base
+        {
+            value_type* values() { return reinterpret_cast<value_type*>(storage); }
+            const value_type* values() const { return reinterpret_cast<const value_type*>(storage); }
+
+            leaf_node *prev;
+            leaf_node *next;
+            alignas(value_type) unsigned char storage[leaf_slots * sizeof(value_type)];
+        };
+
+        // children[i] holds the keys in [keys[i - 1], keys[i])
+        struct alignas(64) inner_node : node_base
+        {
+            key_type* keys() { return reinterpret_cast<key_type*>(storage); }
+            const key_type* keys() const { return reinterpret_cast<const key_type*>(storage); }
+
+            node_base *children[inner_slots + 1];
+            alignas(key_type) unsigned char storage[inner_slots * sizeof(key_type)];
+        };
+
+        // the inner nodes passed on the way down and the child taken in each
+        struct path_entry
+        {
+            inner_node *node;
+            size_t index;
+        };
+
+        // a node of the level being bulk loaded and the smallest key below it
+        struct level_entry
+        {
+            node_base *node;
+            const key_type *low;
+        };
+
+        using value_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+        using value_traits = std::allocator_traits<value_allocator>;
+        using key_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<key_type>;
+        using key_traits = std::allocator_traits<key_allocator>;
+        using leaf_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<leaf_node>;
+        using leaf_traits = std::allocator_traits<leaf_allocator>;
+        using inner_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<inner_node>;
+        using inner_traits = std::allocator_traits<inner_allocator>;
+
+        // every path from the root has the same length and the nodes on the leftmost one
+        // are at least half full, 40 levels are more than 2^64 elements
+        static constexpr size_t max_height = 40;
+
+        template <bool Const>
+        class basic_iterator
+        {
+            friend class btree;
+
+            public:
+
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type = typename Policy::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+                using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+                basic_iterator() : leaf(nullptr), pos(0) {}
+                // iterator to const_iterator
+                template <bool C = Const, typename = std::enable_if_t<C>>
+                basic_iterator(const basic_iterator<false> &rhs) : leaf(rhs.leaf), pos(rhs.pos) {}
+
+                reference operator*() const { return leaf->values()[pos]; }
+                pointer operator->() const { return leaf->values() + pos; }
+
+                // the leaves are linked, stepping to the next one does not go through the parents
+                basic_iterator& operator++()
+                {
+                    if(++pos == leaf->count && leaf->next)
+                    {
+                        leaf = leaf->next;
+                        pos = 0;
+                    }
+                    return *this;
+                }
+
+                basic_iterator operator++(int)
+                {
+                    basic_iterator old = *this;
+                    ++*this;
+                    return old;
+                }
+
+                basic_iterator& operator--()
+                {
+                    if(pos == 0)
+                    {
+                        leaf = leaf->prev;
+                        pos = leaf->count;
+                    }
+                    --pos;
+                    return *this;
+                }
+
+                basic_iterator operator--(int)
+                {
+                    basic_iterator old = *this;
+                    --*this;
+                    return old;
+                }
+
+                friend bool operator==(const basic_iterator &lhs, const basic_iterator &rhs) { return lhs.leaf == rhs.leaf && lhs.pos == rhs.pos; }
+                friend bool operator!=(const basic_iterator &lhs, const basic_iterator &rhs) { return !(lhs == rhs); }
+
+            private:
+
+                template <bool> friend class basic_iterator;
+
+                basic_iterator(leaf_node *leaf, size_t pos) : leaf(leaf), pos(pos) {}
+
+                leaf_node *leaf; // end() is one past the last element of the last leaf
+                size_t pos;
+        };
+
+    public:
+
+        // a set hands out const elements only
+        using const_iterator = basic_iterator<true>;
+        using iterator = std::conditional_t<Policy::constant_elements, const_iterator, basic_iterator<false>>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        btree() : btree(Allocator()) {}
+        explicit btree(const Allocator &a, const Compare &c = Compare())
+            : comp(c), alloc(a), root(nullptr), first(nullptr), last(nullptr), sz(0), height(0) {}
+        btree(const btree &rhs)
+            : btree(rhs, value_traits::select_on_container_copy_construction(rhs.alloc)) {}
+        btree(btree&&) noexcept;
+        ~btree() { release_nodes(); }
+
+        btree& operator=(const btree&);
+        btree& operator=(btree&&)
+            noexcept(value_traits::propagate_on_container_move_assignment::value || value_traits::is_always_equal::value);
+
+        allocator_type get_allocator() const { return allocator_type(alloc); }
+        key_compare key_comp() const { return comp; }
+        void swap(btree&) noexcept;
+
+        iterator begin() { return iterator(first, 0); }
+        iterator end() { return iterator(last, last ? last->count : 0); }
+        const_iterator begin() const { return const_iterator(first, 0); }
+        const_iterator end() const { return const_iterator(last, last ? last->count : 0); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        size_t size() const { return sz; }
+        bool empty() const { return sz == 0; }
+        size_t max_size() const;
+        void clear() { release_nodes(); }
+
+        // lookups, the templates only take part with a transparent Compare
+        iterator find(const key_type &key) { return find_key(key); }
+        const_iterator find(const key_type &key) const { return const_cast<btree&>(*this).find_key(key); }
+        bool contains(const key_type &key) const { return find(key) != end(); }
+        size_t count(const key_type &key) const { return contains(key); }
+
+        // first element not less than key / greater than key, for range scans
+        iterator lower_bound(const key_type &key) { return lower_key(key); }
+        const_iterator lower_bound(const key_type &key) const { return const_cast<btree&>(*this).lower_key(key); }
+        iterator upper_bound(const key_type &key) { return upper_key(key); }
+        const_iterator upper_bound(const key_type &key) const { return const_cast<btree&>(*this).upper_key(key); }
+        std::pair<iterator, iterator> equal_range(const key_type &key) { return equal_key(key); }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const { return const_cast<btree&>(*this).equal_key(key); }
+
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        iterator find(const K &key) { return find_key(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        const_iterator find(const K &key) const { return const_cast<btree&>(*this).find_key(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        bool contains(const K &key) const { return find(key) != end(); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        size_t count(const K &key) const { return contains(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        iterator lower_bound(const K &key) { return lower_key(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        const_iterator lower_bound(const K &key) const { return const_cast<btree&>(*this).lower_key(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        iterator upper_bound(const K &key) { return upper_key(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        const_iterator upper_bound(const K &key) const { return const_cast<btree&>(*this).upper_key(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        std::pair<iterator, iterator> equal_range(const K &key) { return equal_key(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C>>>
+        std::pair<const_iterator, const_iterator> equal_range(const K &key) const { return const_cast<btree&>(*this).equal_key(key); }
+
+        // a sorted range into an empty tree is bulk loaded
+        template <typename It> void insert(It, It);
+        void insert(std::initializer_list<value_type> list) { insert(list.begin(), list.end()); }
+
+        // the iterator to the next element
+        iterator erase(const_iterator);
+        template <typename It = iterator, typename = std::enable_if_t<!std::is_same_v<It, const_iterator>>>
+        iterator erase(iterator it) { return erase(const_iterator(it)); }
+        iterator erase(const_iterator, const_iterator);
+        size_t erase(const key_type &key) { return erase_key(key); }
+        template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_compare_v<C> &&
+                  !std::is_convertible_v<const K&, const_iterator>>>
+        size_t erase(const K &key) { return erase_key(key); }
+
+    protected:
+
+        btree(const btree&, const Allocator&);
+
+        // finds key, or constructs value_type(args...) in its place when it is not there yet
+        template <typename K, typename... Args> std::pair<iterator, bool> emplace_key(const K&, Args&&...);
+        // builds the tree from n elements sorted by key without duplicates, the tree is empty
+        template <typename It> void assign_sorted(It, size_t);
+
+    private:
+
+        template <typename K> leaf_node* descend(const K&, path_entry*) const; // the leaf that holds key, or would
+        template <typename K> size_t lower_index(const leaf_node*, const K&) const;
+        template <typename K> size_t upper_index(const leaf_node*, const K&) const;
+        template <typename K> size_t child_index(const inner_node*, const K&) const;
+
+        template <typename K> iterator find_key(const K&);
+        template <typename K> iterator lower_key(const K&);
+        template <typename K> iterator upper_key(const K&);
+        template <typename K> std::pair<iterator, iterator> equal_key(const K&);
+        template <typename K> size_t erase_key(const K&);
+
+        // an iterator one past the end of a leaf points to the start of the next one
+        iterator make_iterator(leaf_node *leaf, size_t pos)
+        {
+            if(pos == leaf->count && leaf->next)
+            {
+                return iterator(leaf->next, 0);
+            }
+            return iterator(leaf, pos);
+        }
+
+        template <typename It> bool strictly_sorted(It, It) const;
+
+        template <typename... Args> iterator insert_split(leaf_node*, size_t, path_entry*, Args&&...);
+        template <typename... Args> void construct_at(leaf_node*, size_t, Args&&...);
+        void place_at(leaf_node*, size_t, value_type*); // moves an already built element in
+        void split_leaf(leaf_node*, leaf_node*, size_t);
+        void split_inner(inner_node*, size_t, key_type*, node_base*, inner_node*, bool);
+        void insert_child(inner_node*, size_t, key_type*, node_base*);
+
+        iterator erase_at(leaf_node*, size_t, path_entry*);
+        size_t borrow_left(leaf_node*, leaf_node*, key_type&);
+        size_t borrow_right(leaf_node*, leaf_node*, key_type&);
+        void merge_leaves(leaf_node*, leaf_node*);
+        void rebalance_inner(path_entry*);
+        void rotate_right(inner_node*, inner_node*, key_type&);
+        void rotate_left(inner_node*, inner_node*, key_type&);
+        void merge_inner(inner_node*, inner_node*, inner_node*, size_t);
+        void remove_separator(inner_node*, size_t);
+
+        // moves n elements or keys, the ranges may overlap, the source is left destroyed
+        template <typename U> void move_elements(U*, size_t, U*) noexcept;
+
+        leaf_node* new_leaf();
+        inner_node* new_inner();
+        void delete_leaf(leaf_node*) noexcept;
+        void delete_inner(inner_node*) noexcept;
+        void destroy_keys(inner_node*) noexcept;
+        void destroy_inner(node_base*, size_t) noexcept;
+        void release_nodes() noexcept; // destroys every element and node and leaves the tree empty
+        void take_nodes(btree&) noexcept;
+
+        Compare comp;
+        value_allocator alloc;
+        node_base *root;   // a leaf while height is 0
+        leaf_node *first;
+        leaf_node *last;
+        size_t sz;
+        size_t height;     // inner levels above the leaves
+};
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+btree<Policy, Compare, Allocator, NodeBytes>::btree(const btree &rhs, const Allocator &a)
+    : btree(a, rhs.comp)
+{
+    // the elements come out sorted, the copy gets packed leaves
+    assign_sorted(rhs.begin(), rhs.sz);
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+btree<Policy, Compare, Allocator, NodeBytes>::btree(btree &&rhs) noexcept
+    : comp(std::move(rhs.comp)), alloc(std::move(rhs.alloc)), root(nullptr), first(nullptr), last(nullptr), sz(0), height(0)
+{
+    take_nodes(rhs);
+}
+
+// cpy=
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+btree<Policy, Compare, Allocator, NodeBytes>& btree<Policy, Compare, Allocator, NodeBytes>::operator=(const btree &rhs)
+{
+    if(this != &rhs)
+    {
+        btree copy(rhs, value_traits::propagate_on_container_copy_assignment::value ? rhs.alloc : alloc);
+        release_nodes();
+        if constexpr (value_traits::propagate_on_container_copy_assignment::value)
+        {
+            alloc = rhs.alloc;
+        }
+
+        // copy was built with the allocator we keep, its nodes can be taken over
+        comp = copy.comp;
+        take_nodes(copy);
+    }
+    return *this;
+}
+
+// move=
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+btree<Policy, Compare, Allocator, NodeBytes>& btree<Policy, Compare, Allocator, NodeBytes>::operator=(btree &&rhs)
+    noexcept(value_traits::propagate_on_container_move_assignment::value || value_traits::is_always_equal::value)
+{
+    if(this == &rhs)
+    {
+        return *this;
+    }
+
+    comp = std::move(rhs.comp);
+    release_nodes();
+
+    if constexpr (!value_traits::propagate_on_container_move_assignment::value && !value_traits::is_always_equal::value)
+    {
+        // rhs nodes belong to a different allocator, we can only move the elements one by one
+        if(alloc != rhs.alloc)
+        {
+            assign_sorted(std::make_move_iterator(rhs.begin()), rhs.sz);
+            rhs.release_nodes();
+            return *this;
+        }
+    }
+
+    if constexpr (value_traits::propagate_on_container_move_assignment::value)
+    {
+        alloc = std::move(rhs.alloc);
+    }
+    take_nodes(rhs);
+    return *this;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::swap(btree &rhs) noexcept
+{
+    using std::swap;
+    if constexpr (value_traits::propagate_on_container_swap::value)
+    {
+        swap(alloc, rhs.alloc);
+    }
+    swap(comp, rhs.comp);
+    swap(root, rhs.root);
+    swap(first, rhs.first);
+    swap(last, rhs.last);
+    swap(sz, rhs.sz);
+    swap(height, rhs.height);
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+size_t btree<Policy, Compare, Allocator, NodeBytes>::max_size() const
+{
+    // a leaf per leaf_slots / 2 elements at worst
+    const size_t nodes_max = std::numeric_limits<std::ptrdiff_t>::max() / sizeof(leaf_node);
+    const size_t alloc_max = value_traits::max_size(alloc);
+    const size_t bytes_max = nodes_max * (leaf_slots / 2);
+    return alloc_max < bytes_max ? alloc_max : bytes_max;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename It>
+void btree<Policy, Compare, Allocator, NodeBytes>::insert(It first_it, It last_it)
+{
+    if constexpr (!is_input_only_iterator_v<It>)
+    {
+        // the check costs one compare per element, the load saves a descent per element
+        if(sz == 0 && strictly_sorted(first_it, last_it))
+        {
+            assign_sorted(first_it, static_cast<size_t>(std::distance(first_it, last_it)));
+            return;
+        }
+    }
+
+    for(; first_it != last_it; ++first_it)
+    {
+        emplace_key(Policy::key(*first_it), *first_it);
+    }
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename It>
+bool btree<Policy, Compare, Allocator, NodeBytes>::strictly_sorted(It first_it, It last_it) const
+{
+    if(first_it == last_it)
+    {
+        return true;
+    }
+    for(It next = std::next(first_it); next != last_it; first_it = next, ++next)
+    {
+        if(!comp(Policy::key(*first_it), Policy::key(*next)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename It>
+void btree<Policy, Compare, Allocator, NodeBytes>::assign_sorted(It it, size_t n)
+{
+    if(n == 0)
+    {
+        return;
+    }
+
+    // leaves as full as possible with the elements spread evenly, so none is less than half full
+    const size_t leaves = (n + leaf_slots - 1) / leaf_slots;
+
+    // every inner node gets at least two children, there are fewer of them than leaves
+    adstl::vector<level_entry> level;
+    adstl::vector<level_entry> parents;
+    adstl::vector<inner_node*> inners;
+    level.reserve(leaves);
+    parents.reserve(leaves);
+    inners.reserve(leaves);
+
+    key_allocator key_alloc(alloc);
+    ADSTL_TRY
+    {
+        size_t done = 0;
+        for(size_t l = 0; l != leaves; ++l)
+        {
+            leaf_node *leaf = new_leaf();
+            leaf->prev = last;
+            (last ? last->next : first) = leaf;
+            last = leaf;
+
+            const size_t take = (n - done) / (leaves - l);
+            value_type *values = leaf->values();
+            for(; leaf->count != take; ++leaf->count, ++it)
+            {
+                value_traits::construct(alloc, values + leaf->count, *it);
+            }
+            done += take;
+            level.push_back(level_entry{leaf, &Policy::key(values[0])});
+        }
+
+        // the inner levels from the bottom up, a separator is the smallest key under its child
+        while(level.size() > 1)
+        {
+            const size_t nodes = (level.size() + inner_slots) / (inner_slots + 1);
+            parents.clear();
+
+            size_t next = 0;
+            for(size_t k = 0; k != nodes; ++k)
+            {
+                inner_node *node = new_inner();
+                inners.push_back(node);
+                node->children[0] = level[next].node;
+                parents.push_back(level_entry{node, level[next].low});
+
+                const size_t take = (level.size() - next) / (nodes - k);
+                for(size_t c = 1; c != take; ++c)
+                {
+                    key_traits::construct(key_alloc, node->keys() + node->count, *level[next + c].low);
+                    node->children[c] = level[next + c].node;
+                    ++node->count;
+                }
+                next += take;
+            }
+            level.swap(parents);
+            ++height;
+        }
+    }
+    ADSTL_CATCH_ALL
+    {
+        for(inner_node *node : inners)
+        {
+            destroy_keys(node);
+            delete_inner(node);
+        }
+        height = 0;
+        root = nullptr;
+        release_nodes();
+        ADSTL_RETHROW;
+    }
+
+    root = level[0].node;
+    sz = n;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+typename btree<Policy, Compare, Allocator, NodeBytes>::leaf_node* btree<Policy, Compare, Allocator, NodeBytes>::descend(const K &key, path_entry *path) const
+{
+    node_base *node = root;
+    for(size_t level = 0; level != height; ++level)
+    {
+        inner_node *inner = static_cast<inner_node*>(node);
+        const size_t i = child_index(inner, key);
+        if(path)
+        {
+            path[level] = path_entry{inner, i};
+        }
+        node = inner->children[i];
+    }
+    return static_cast<leaf_node*>(node);
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+size_t btree<Policy, Compare, Allocator, NodeBytes>::lower_index(const leaf_node *leaf, const K &key) const
+{
+    const value_type *values = leaf->values();
+    return std::lower_bound(values, values + leaf->count, key,
+                            [this](const value_type &value, const K &k) { return comp(Policy::key(value), k); }) - values;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+size_t btree<Policy, Compare, Allocator, NodeBytes>::upper_index(const leaf_node *leaf, const K &key) const
+{
+    const value_type *values = leaf->values();
+    return std::upper_bound(values, values + leaf->count, key,
+                            [this](const K &k, const value_type &value) { return comp(k, Policy::key(value)); }) - values;
+}
+
+// keys equal to a separator live to its right
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+size_t btree<Policy, Compare, Allocator, NodeBytes>::child_index(const inner_node *node, const K &key) const
+{
+    const key_type *keys = node->keys();
+    return std::upper_bound(keys, keys + node->count, key,
+                            [this](const K &k, const key_type &separator) { return comp(k, separator); }) - keys;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+typename btree<Policy, Compare, Allocator, NodeBytes>::iterator btree<Policy, Compare, Allocator, NodeBytes>::find_key(const K &key)
+{
+    iterator it = lower_key(key);
+    if(it != end() && !comp(key, Policy::key(*it)))
+    {
+        return it;
+    }
+    return end();
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+typename btree<Policy, Compare, Allocator, NodeBytes>::iterator btree<Policy, Compare, Allocator, NodeBytes>::lower_key(const K &key)
+{
+    if(root == nullptr)
+    {
+        return end();
+    }
+    leaf_node *leaf = descend(key, nullptr);
+    return make_iterator(leaf, lower_index(leaf, key));
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+typename btree<Policy, Compare, Allocator, NodeBytes>::iterator btree<Policy, Compare, Allocator, NodeBytes>::upper_key(const K &key)
+{
+    if(root == nullptr)
+    {
+        return end();
+    }
+    leaf_node *leaf = descend(key, nullptr);
+    return make_iterator(leaf, upper_index(leaf, key));
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+std::pair<typename btree<Policy, Compare, Allocator, NodeBytes>::iterator, typename btree<Policy, Compare, Allocator, NodeBytes>::iterator>
+btree<Policy, Compare, Allocator, NodeBytes>::equal_key(const K &key)
+{
+    // keys are unique, the range holds one element at most
+    iterator lower = lower_key(key);
+    iterator upper = lower;
+    if(lower != end() && !comp(key, Policy::key(*lower)))
+    {
+        ++upper;
+    }
+    return {lower, upper};
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K, typename... Args>
+std::pair<typename btree<Policy, Compare, Allocator, NodeBytes>::iterator, bool>
+btree<Policy, Compare, Allocator, NodeBytes>::emplace_key(const K &key, Args&&... args)
+{
+    if(root == nullptr)
+    {
+        leaf_node *leaf = new_leaf();
+        ADSTL_TRY
+        {
+            value_traits::construct(alloc, leaf->values(), std::forward<Args>(args)...);
+        }
+        ADSTL_CATCH_ALL
+        {
+            delete_leaf(leaf);
+            ADSTL_RETHROW;
+        }
+        leaf->count = 1;
+        root = first = last = leaf;
+        sz = 1;
+        return {iterator(leaf, 0), true};
+    }
+
+    path_entry path[max_height];
+    leaf_node *leaf = descend(key, path);
+    const size_t pos = lower_index(leaf, key);
+    if(pos != leaf->count && !comp(key, Policy::key(leaf->values()[pos])))
+    {
+        return {iterator(leaf, pos), false};
+    }
+
+    if(leaf->count != leaf_slots) ADSTL_LIKELY
+    {
+        construct_at(leaf, pos, std::forward<Args>(args)...);
+        ++sz;
+        return {iterator(leaf, pos), true};
+    }
+    return {insert_split(leaf, pos, path, std::forward<Args>(args)...), true};
+}
+
+// the leaf has room, args may refer to an element of it, so the new element is built
+// before anything is shifted
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename... Args>
+void btree<Policy, Compare, Allocator, NodeBytes>::construct_at(leaf_node *leaf, size_t pos, Args&&... args)
+{
+    alignas(value_type) unsigned char value_buffer[sizeof(value_type)];
+    value_type *value = reinterpret_cast<value_type*>(value_buffer);
+    value_traits::construct(alloc, value, std::forward<Args>(args)...);
+    place_at(leaf, pos, value);
+    value_traits::destroy(alloc, value);
+}
+
+// the elements behind pos are shifted back by one and *value is moved into the gap
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::place_at(leaf_node *leaf, size_t pos, value_type *value)
+{
+    value_type *values = leaf->values();
+    move_elements(values + pos, leaf->count - pos, values + pos + 1);
+    value_traits::construct(alloc, values + pos, std::move(*value));
+    ++leaf->count;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename... Args>
+typename btree<Policy, Compare, Allocator, NodeBytes>::iterator btree<Policy, Compare, Allocator, NodeBytes>::insert_split(leaf_node *leaf, size_t pos, path_entry *path, Args&&... args)
+{
+    // the full inner nodes right above the leaf split with it, a new root when all of them do
+    size_t splits = 0;
+    while(splits != height && path[height - 1 - splits].node->count == inner_slots)
+    {
+        ++splits;
+    }
+    const size_t spares = splits + (splits == height);
+
+    // appending to the last leaf leaves it full and starts a new one, otherwise half and half
+    const bool append = leaf == last && pos == leaf->count;
+    const size_t mid = append ? leaf->count : leaf->count / 2;
+
+    // the nodes, the new element and the new separator are made before the tree is touched,
+    // from then on elements and keys are only moved
+    alignas(value_type) unsigned char value_buffer[sizeof(value_type)];
+    alignas(key_type) unsigned char key_buffer[sizeof(key_type)];
+    value_type *value = reinterpret_cast<value_type*>(value_buffer);
+    key_type *separator = reinterpret_cast<key_type*>(key_buffer);
+
+    inner_node *spare[max_height + 1];
+    leaf_node *right = new_leaf();
+    size_t made = 0;
+    bool built = false;
+    key_allocator key_alloc(alloc);
+    ADSTL_TRY
+    {
+        for(; made != spares; ++made)
+        {
+            spare[made] = new_inner();
+        }
+        value_traits::construct(alloc, value, std::forward<Args>(args)...);
+        built = true;
+        // the first key of the new leaf
+        key_traits::construct(key_alloc, separator, Policy::key(pos == mid ? *value : leaf->values()[mid]));
+    }
+    ADSTL_CATCH_ALL
+    {
+        if(built)
+        {
+            value_traits::destroy(alloc, value);
+        }
+        while(made--)
+        {
+            delete_inner(spare[made]);
+        }
+        delete_leaf(right);
+        ADSTL_RETHROW;
+    }
+
+    split_leaf(leaf, right, mid);
+    leaf_node *target = pos < mid ? leaf : right;
+    const size_t at = pos < mid ? pos : pos - mid;
+    place_at(target, at, value);
+    value_traits::destroy(alloc, value);
+    ++sz;
+
+    // the separator and the new node go up until a parent has room
+    node_base *child = right;
+    for(size_t level = height; level-- != 0;)
+    {
+        inner_node *node = path[level].node;
+        const size_t i = path[level].index;
+        if(node->count != inner_slots)
+        {
+            insert_child(node, i, separator, child);
+            return iterator(target, at);
+        }
+        inner_node *sibling = spare[--made];
+        split_inner(node, i, separator, child, sibling, append);
+        child = sibling;
+    }
+
+    // the root split, the tree grows by one level
+    inner_node *top = spare[--made];
+    top->children[0] = root;
+    insert_child(top, 0, separator, child);
+    root = top;
+    ++height;
+    return iterator(target, at);
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::split_leaf(leaf_node *leaf, leaf_node *right, size_t mid)
+{
+    move_elements(leaf->values() + mid, leaf->count - mid, right->values());
+    right->count = leaf->count - mid;
+    leaf->count = mid;
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    (leaf->next ? leaf->next->prev : last) = right;
+    leaf->next = right;
+}
+
+// node is full, (*separator, child) goes in at index i: the upper half of node moves to
+// sibling and *separator is left holding the key that goes up between the two
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::split_inner(inner_node *node, size_t i, key_type *separator, node_base *child, inner_node *sibling, bool append)
+{
+    const size_t count = node->count;
+    const size_t mid = append ? count - 1 : count / 2;
+
+    move_elements(node->keys() + mid + 1, count - mid - 1, sibling->keys());
+    std::copy(node->children + mid + 1, node->children + count + 1, sibling->children);
+    sibling->count = count - mid - 1;
+    node->count = mid;
+
+    alignas(key_type) unsigned char key_buffer[sizeof(key_type)];
+    key_type *up = reinterpret_cast<key_type*>(key_buffer);
+    move_elements(node->keys() + mid, 1, up);
+    if(i <= mid)
+    {
+        insert_child(node, i, separator, child);
+    }
+    else
+    {
+        insert_child(sibling, i - mid - 1, separator, child);
+    }
+    move_elements(up, 1, separator);
+}
+
+// moves *separator in at key index i and child in right behind it, node has room
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::insert_child(inner_node *node, size_t i, key_type *separator, node_base *child)
+{
+    key_type *keys = node->keys();
+    move_elements(keys + i, node->count - i, keys + i + 1);
+    move_elements(separator, 1, keys + i);
+    std::copy_backward(node->children + i + 1, node->children + node->count + 1, node->children + node->count + 2);
+    node->children[i + 1] = child;
+    ++node->count;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Policy, Compare, Allocator, NodeBytes>::iterator btree<Policy, Compare, Allocator, NodeBytes>::erase(const_iterator it)
+{
+    path_entry path[max_height];
+    descend(Policy::key(*it), path);
+    return erase_at(it.leaf, it.pos, path);
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Policy, Compare, Allocator, NodeBytes>::iterator btree<Policy, Compare, Allocator, NodeBytes>::erase(const_iterator first_it, const_iterator last_it)
+{
+    // erasing moves the elements behind, count them before last is invalidated
+    size_t n = static_cast<size_t>(std::distance(first_it, last_it));
+    iterator it(first_it.leaf, first_it.pos);
+    while(n--)
+    {
+        it = erase(it);
+    }
+    return it;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename K>
+size_t btree<Policy, Compare, Allocator, NodeBytes>::erase_key(const K &key)
+{
+    if(root == nullptr)
+    {
+        return 0;
+    }
+
+    path_entry path[max_height];
+    leaf_node *leaf = descend(key, path);
+    const size_t pos = lower_index(leaf, key);
+    if(pos == leaf->count || comp(key, Policy::key(leaf->values()[pos])))
+    {
+        return 0;
+    }
+    erase_at(leaf, pos, path);
+    return 1;
+}
+
+// a leaf left less than half full takes elements from a sibling or is merged with it, a
+// merge takes a key from the parent, which may in turn have to borrow or merge
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Policy, Compare, Allocator, NodeBytes>::iterator btree<Policy, Compare, Allocator, NodeBytes>::erase_at(leaf_node *leaf, size_t pos, path_entry *path)
+{
+    value_type *values = leaf->values();
+    value_traits::destroy(alloc, values + pos);
+    move_elements(values + pos + 1, leaf->count - pos - 1, values + pos);
+    --leaf->count;
+    --sz;
+
+    if(height == 0)
+    {
+        if(sz == 0)
+        {
+            delete_leaf(leaf);
+            root = first = last = nullptr;
+            return end();
+        }
+        return make_iterator(leaf, pos);
+    }
+    if(leaf->count >= leaf_slots / 2)
+    {
+        return make_iterator(leaf, pos);
+    }
+
+    inner_node *parent = path[height - 1].node;
+    const size_t i = path[height - 1].index;
+    if(i != 0)
+    {
+        leaf_node *left = static_cast<leaf_node*>(parent->children[i - 1]);
+        if(left->count + leaf->count > leaf_slots)
+        {
+            pos += borrow_left(left, leaf, parent->keys()[i - 1]);
+            return make_iterator(leaf, pos);
+        }
+        pos += left->count;
+        merge_leaves(left, leaf);
+        key_allocator key_alloc(alloc);
+        key_traits::destroy(key_alloc, parent->keys() + i - 1);
+        remove_separator(parent, i - 1);
+        rebalance_inner(path);
+        return make_iterator(left, pos);
+    }
+
+    leaf_node *right = static_cast<leaf_node*>(parent->children[1]);
+    if(leaf->count + right->count > leaf_slots)
+    {
+        borrow_right(leaf, right, parent->keys()[0]);
+        return make_iterator(leaf, pos);
+    }
+    merge_leaves(leaf, right);
+    key_allocator key_alloc(alloc);
+    key_traits::destroy(key_alloc, parent->keys());
+    remove_separator(parent, 0);
+    rebalance_inner(path);
+    return make_iterator(leaf, pos);
+}
+
+// moves the last elements of left to the front of leaf and returns how many, 0 when the
+// new separator can not be copied: the leaf stays less than half full, which costs space only
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+size_t btree<Policy, Compare, Allocator, NodeBytes>::borrow_left(leaf_node *left, leaf_node *leaf, key_type &separator)
+{
+    const size_t k = (left->count - leaf->count + 1) / 2;
+    alignas(key_type) unsigned char key_buffer[sizeof(key_type)];
+    key_type *low = reinterpret_cast<key_type*>(key_buffer);
+    key_allocator key_alloc(alloc);
+    ADSTL_TRY
+    {
+        key_traits::construct(key_alloc, low, Policy::key(left->values()[left->count - k]));
+    }
+    ADSTL_CATCH_ALL
+    {
+        return 0;
+    }
+
+    move_elements(leaf->values(), leaf->count, leaf->values() + k);
+    move_elements(left->values() + left->count - k, k, leaf->values());
+    left->count -= k;
+    leaf->count += k;
+
+    key_traits::destroy(key_alloc, &separator);
+    move_elements(low, 1, &separator);
+    return k;
+}
+
+// moves the first elements of right to the back of leaf, the positions in leaf stay the same
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+size_t btree<Policy, Compare, Allocator, NodeBytes>::borrow_right(leaf_node *leaf, leaf_node *right, key_type &separator)
+{
+    const size_t k = (right->count - leaf->count + 1) / 2;
+    alignas(key_type) unsigned char key_buffer[sizeof(key_type)];
+    key_type *low = reinterpret_cast<key_type*>(key_buffer);
+    key_allocator key_alloc(alloc);
+    ADSTL_TRY
+    {
+        key_traits::construct(key_alloc, low, Policy::key(right->values()[k]));
+    }
+    ADSTL_CATCH_ALL
+    {
+        return 0;
+    }
+
+    move_elements(right->values(), k, leaf->values() + leaf->count);
+    move_elements(right->values() + k, right->count - k, right->values());
+    right->count -= k;
+    leaf->count += k;
+
+    key_traits::destroy(key_alloc, &separator);
+    move_elements(low, 1, &separator);
+    return k;
+}
+
+// appends the elements of right to left and unlinks right
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::merge_leaves(leaf_node *left, leaf_node *right)
+{
+    move_elements(right->values(), right->count, left->values() + left->count);
+    left->count += right->count;
+
+    left->next = right->next;
+    (right->next ? right->next->prev : last) = left;
+    delete_leaf(right);
+}
+
+// the inner node at the bottom of path lost a key, fixes it and the ones above
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::rebalance_inner(path_entry *path)
+{
+    for(size_t level = height - 1; level != 0; --level)
+    {
+        inner_node *node = path[level].node;
+        if(node->count >= inner_slots / 2)
+        {
+            return;
+        }
+
+        inner_node *parent = path[level - 1].node;
+        const size_t i = path[level - 1].index;
+        if(i != 0)
+        {
+            inner_node *left = static_cast<inner_node*>(parent->children[i - 1]);
+            if(left->count + node->count + 1 > inner_slots)
+            {
+                rotate_right(left, node, parent->keys()[i - 1]);
+                return;
+            }
+            merge_inner(left, node, parent, i - 1);
+        }
+        else
+        {
+            inner_node *right = static_cast<inner_node*>(parent->children[1]);
+            if(node->count + right->count + 1 > inner_slots)
+            {
+                rotate_left(node, right, parent->keys()[0]);
+                return;
+            }
+            merge_inner(node, right, parent, 0);
+        }
+    }
+
+    // the root lost its last separator, its only child takes over
+    inner_node *top = static_cast<inner_node*>(root);
+    if(top->count == 0)
+    {
+        root = top->children[0];
+        delete_inner(top);
+        --height;
+    }
+}
+
+// moves keys and children from the back of left to the front of node through the parent's separator
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::rotate_right(inner_node *left, inner_node *node, key_type &separator)
+{
+    const size_t lc = left->count;
+    const size_t nc = node->count;
+    const size_t k = (lc - nc + 1) / 2;
+
+    move_elements(node->keys(), nc, node->keys() + k);
+    std::copy_backward(node->children, node->children + nc + 1, node->children + nc + 1 + k);
+
+    move_elements(&separator, 1, node->keys() + k - 1);
+    move_elements(left->keys() + lc - k + 1, k - 1, node->keys());
+    std::copy(left->children + lc - k + 1, left->children + lc + 1, node->children);
+    move_elements(left->keys() + lc - k, 1, &separator);
+
+    left->count = lc - k;
+    node->count = nc + k;
+}
+
+// moves keys and children from the front of right to the back of node through the parent's separator
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::rotate_left(inner_node *node, inner_node *right, key_type &separator)
+{
+    const size_t nc = node->count;
+    const size_t rc = right->count;
+    const size_t k = (rc - nc + 1) / 2;
+
+    move_elements(&separator, 1, node->keys() + nc);
+    move_elements(right->keys(), k - 1, node->keys() + nc + 1);
+    std::copy(right->children, right->children + k, node->children + nc + 1);
+    move_elements(right->keys() + k - 1, 1, &separator);
+
+    move_elements(right->keys() + k, rc - k, right->keys());
+    std::copy(right->children + k, right->children + rc + 1, right->children);
+
+    right->count = rc - k;
+    node->count = nc + k;
+}
+
+// left takes the separator at index s of parent and everything in right, right is freed
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::merge_inner(inner_node *left, inner_node *right, inner_node *parent, size_t s)
+{
+    const size_t lc = left->count;
+    move_elements(parent->keys() + s, 1, left->keys() + lc);
+    move_elements(right->keys(), right->count, left->keys() + lc + 1);
+    std::copy(right->children, right->children + right->count + 1, left->children + lc + 1);
+    left->count = lc + 1 + right->count;
+
+    delete_inner(right);
+    remove_separator(parent, s);
+}
+
+// closes the gap of the already destroyed key s and of the child to its right
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::remove_separator(inner_node *node, size_t s)
+{
+    move_elements(node->keys() + s + 1, node->count - s - 1, node->keys() + s);
+    std::copy(node->children + s + 2, node->children + node->count + 1, node->children + s + 1);
+    --node->count;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename U>
+void btree<Policy, Compare, Allocator, NodeBytes>::move_elements(U *src, size_t n, U *dst) noexcept
+{
+    if(n == 0)
+    {
+        return;
+    }
+    if constexpr (std::is_same_v<U, value_type>)
+    {
+        ADSTL_COUNT(btree_map, elements_moved, n);
+    }
+
+    if constexpr (is_trivially_relocatable_v<U>)
+    {
+        std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(U));
+    }
+    else
+    {
+        using u_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+        using u_traits = std::allocator_traits<u_allocator>;
+        u_allocator a(alloc);
+
+        // front to back when moving down, back to front when moving up, so nothing is overwritten
+        if(dst < src)
+        {
+            for(size_t i = 0; i != n; ++i)
+            {
+                u_traits::construct(a, dst + i, std::move(src[i]));
+                u_traits::destroy(a, src + i);
+            }
+        }
+        else
+        {
+            for(size_t i = n; i--;)
+            {
+                u_traits::construct(a, dst + i, std::move(src[i]));
+                u_traits::destroy(a, src + i);
+            }
+        }
+    }
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Policy, Compare, Allocator, NodeBytes>::leaf_node* btree<Policy, Compare, Allocator, NodeBytes>::new_leaf()
+{
+    leaf_allocator a(alloc);
+    leaf_node *leaf = ::new (static_cast<void*>(leaf_traits::allocate(a, 1))) leaf_node;
+    ADSTL_COUNT(btree_map, allocations, 1);
+    ADSTL_COUNT(btree_map, bytes_allocated, sizeof(leaf_node));
+    ADSTL_COUNT(btree_map, node_allocations, 1);
+    leaf->count = 0;
+    leaf->prev = leaf->next = nullptr;
+    return leaf;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Policy, Compare, Allocator, NodeBytes>::inner_node* btree<Policy, Compare, Allocator, NodeBytes>::new_inner()
+{
+    inner_allocator a(alloc);
+    inner_node *node = ::new (static_cast<void*>(inner_traits::allocate(a, 1))) inner_node;
+    ADSTL_COUNT(btree_map, allocations, 1);
+    ADSTL_COUNT(btree_map, bytes_allocated, sizeof(inner_node));
+    node->count = 0;
+    return node;
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::delete_leaf(leaf_node *leaf) noexcept
+{
+    leaf_allocator a(alloc);
+    leaf_traits::deallocate(a, leaf, 1);
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::delete_inner(inner_node *node) noexcept
+{
+    inner_allocator a(alloc);
+    inner_traits::deallocate(a, node, 1);
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::destroy_keys(inner_node *node) noexcept
+{
+    if constexpr (!std::is_trivially_destructible_v<key_type>)
+    {
+        key_allocator key_alloc(alloc);
+        for(size_t i = 0; i != node->count; ++i)
+        {
+            key_traits::destroy(key_alloc, node->keys() + i);
+        }
+    }
+}
+
+// frees the inner nodes below node, level inner levels deep, the leaves are freed through their links
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::destroy_inner(node_base *node, size_t level) noexcept
+{
+    if(level == 0)
+    {
+        return;
+    }
+
+    inner_node *inner = static_cast<inner_node*>(node);
+    if(level > 1)
+    {
+        for(size_t i = 0; i <= inner->count; ++i)
+        {
+            destroy_inner(inner->children[i], level - 1);
+        }
+    }
+    destroy_keys(inner);
+    delete_inner(inner);
+}
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::release_nodes() noexcept
+{
+    if(root)
+    {
+        destroy_inner(root, height);
+    }
+
+    for(leaf_node *leaf = first; leaf;)
+    {
+        leaf_node *next = leaf->next;
+        if constexpr (!std::is_trivially_destructible_v<value_type>)
+        {
+            for(size_t i = 0; i != leaf->count; ++i)
+            {
+                value_traits::destroy(alloc, leaf->values() + i);
+            }
+        }
+        delete_leaf(leaf);
+        leaf = next;
+    }
+
+    root = nullptr;
+    first = last = nullptr;
+    sz = 0;
+    height = 0;
+}
+
+// takes the nodes of rhs, this tree is empty
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Policy, Compare, Allocator, NodeBytes>::take_nodes(btree &rhs) noexcept
+{
+    root = rhs.root;
+    first = rhs.first;
+    last = rhs.last;
+    sz = rhs.sz;
+    height = rhs.height;
+
+    rhs.root = nullptr;
+    rhs.first = rhs.last = nullptr;
+    rhs.sz = rhs.height = 0;
+}
+
+template <typename Key, typename T>
+struct ordered_map_policy
+{
+    using key_type = Key;
+    using value_type = std::pair<Key, T>;
+    static constexpr bool constant_elements = false;
+
+    static const Key& key(const value_type &value) { return value.first; }
+};
+
+template <typename Key>
+struct ordered_set_policy
+{
+    using key_type = Key;
+    using value_type = Key;
+    static constexpr bool constant_elements = true;
+
+    static const Key& key(const Key &value) { return value; }
+};
+
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator, size_t NodeBytes>
+class btree_map final : public detail::btree<detail::ordered_map_policy<Key, T>, Compare, Allocator, NodeBytes>
+{
+    using base = detail::btree<detail::ordered_map_policy<Key, T>, Compare, Allocator, NodeBytes>;
+
+    public:
+
+        using mapped_type = T;
+        using typename base::key_type;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        using base::base;
+        btree_map() = default;
+        btree_map(std::initializer_list<value_type> list, const Allocator &a = Allocator()) : base(a) { insert(list); }
+        template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+        btree_map(It first, It last, const Allocator &a = Allocator()) : base(a) { insert(first, last); }
+
+        // bulk load, the range is sorted by key and has no duplicate keys
+        template <typename It>
+        btree_map(sorted_unique_t, It first, It last, const Allocator &a = Allocator()) : base(a)
+        {
+            this->assign_sorted(first, static_cast<size_t>(std::distance(first, last)));
+        }
+
+        template <typename A, typename G, size_t N>
+        btree_map(sorted_unique_t, vector<value_type, A, G, N> &&sorted, const Allocator &a = Allocator()) : base(a)
+        {
+            this->assign_sorted(std::make_move_iterator(sorted.begin()), sorted.size());
+            sorted.clear();
+        }
+
+        using base::insert;
+        std::pair<iterator, bool> insert(const value_type &value) { return this->emplace_key(value.first, value); }
+        std::pair<iterator, bool> insert(value_type &&value) { return this->emplace_key(value.first, std::move(value)); }
+
+        // nothing is constructed when the key is already there, as long as it can be found
+        // without building a key_type
+        template <typename... Args> std::pair<iterator, bool> emplace(Args&&...);
+        // the hint is not needed, the descent from the root touches a few nodes
+        template <typename... Args>
+        iterator emplace_hint(const_iterator, Args&&... args) { return emplace(std::forward<Args>(args)...).first; }
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type &key, Args&&... args)
+        {
+            return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type &&key, Args&&... args)
+        {
+            return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        T& operator[](const key_type &key) { return try_emplace(key).first->second; }
+        T& operator[](key_type &&key) { return try_emplace(std::move(key)).first->second; }
+
+        // bounds checked access
+        T& at(const key_type&);
+        const T& at(const key_type&) const;
+        // no exceptions, errc::out_of_range when the key is missing
+        expected<T&> try_at(const key_type &key);
+        expected<const T&> try_at(const key_type &key) const;
+};
+
+template <typename Key, typename T, typename Compare, typename Allocator, size_t NodeBytes>
+template <typename... Args>
+std::pair<typename btree_map<Key, T, Compare, Allocator, NodeBytes>::iterator, bool>
+btree_map<Key, T, Compare, Allocator, NodeBytes>::emplace(Args&&... args)
+{
+    if constexpr (sizeof...(Args) == 2)
+    {
+        using first_arg = std::decay_t<std::tuple_element_t<0, std::tuple<Args...>>>;
+        if constexpr (std::is_same_v<first_arg, Key> || detail::is_transparent_compare_v<Compare>)
+        {
+            // the key can be looked up as it is
+            const auto &key = std::get<0>(std::forward_as_tuple(args...));
+            return this->emplace_key(key, std::forward<Args>(args)...);
+        }
+        else
+        {
+            value_type value(std::forward<Args>(args)...);
+            return insert(std::move(value));
+        }
+    }
+    else if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, value_type> && ...))
+    {
+        return insert(std::forward<Args>(args)...);
+    }
+    else
+    {
+        value_type value(std::forward<Args>(args)...);
+        return insert(std::move(value));
+    }
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator, size_t NodeBytes>
+T& btree_map<Key, T, Compare, Allocator, NodeBytes>::at(const key_type &key)
+{
+    iterator it = this->find(key);
+    if(it != this->end()) ADSTL_LIKELY
+    {
+        return it->second;
+    }
+    ADSTL_FAIL(std::out_of_range("btree_map::at: key not found."));
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator, size_t NodeBytes>
+const T& btree_map<Key, T, Compare, Allocator, NodeBytes>::at(const key_type &key) const
+{
+    const_iterator it = this->find(key);
+    if(it != this->end()) ADSTL_LIKELY
+    {
+        return it->second;
+    }
+    ADSTL_FAIL(std::out_of_range("btree_map::at: key not found."));
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator, size_t NodeBytes>
+expected<T&> btree_map<Key, T, Compare, Allocator, NodeBytes>::try_at(const key_type &key)
+{
+    iterator it = this->find(key);
+    if(it != this->end()) ADSTL_LIKELY
+    {
+        return it->second;
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator, size_t NodeBytes>
+expected<const T&> btree_map<Key, T, Compare, Allocator, NodeBytes>::try_at(const key_type &key) const
+{
+    const_iterator it = this->find(key);
+    if(it != this->end()) ADSTL_LIKELY
+    {
+        return it->second;
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename Key, typename Compare, typename Allocator, size_t NodeBytes>
+class btree_set final : public detail::btree<detail::ordered_set_policy<Key>, Compare, Allocator, NodeBytes>
+{
+    using base = detail::btree<detail::ordered_set_policy<Key>, Compare, Allocator, NodeBytes>;
+
+    public:
+
+        using typename base::key_type;
+        using typename base::value_type;
+        using typename base::iterator;
+
+        using base::base;
+        btree_set() = default;
+        btree_set(std::initializer_list<value_type> list, const Allocator &a = Allocator()) : base(a) { insert(list); }
+        template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+        btree_set(It first, It last, const Allocator &a = Allocator()) : base(a) { insert(first, last); }
+
+        // bulk load, the range is sorted and has no duplicates
+        template <typename It>
+        btree_set(sorted_unique_t, It first, It last, const Allocator &a = Allocator()) : base(a)
+        {
+            this->assign_sorted(first, static_cast<size_t>(std::distance(first, last)));
+        }
+
+        template <typename A, typename G, size_t N>
+        btree_set(sorted_unique_t, vector<Key, A, G, N> &&sorted, const Allocator &a = Allocator()) : base(a)
+        {
+            this->assign_sorted(std::make_move_iterator(sorted.begin()), sorted.size());
+            sorted.clear();
+        }
+
+        using base::insert;
+        std::pair<iterator, bool> insert(const value_type &value) { return this->emplace_key(value, value); }
+        std::pair<iterator, bool> insert(value_type &&value) { return this->emplace_key(value, std::move(value)); }
+
+        template <typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            if constexpr (sizeof...(Args) == 1 && ((std::is_same_v<std::decay_t<Args>, Key> || detail::is_transparent_compare_v<Compare>) && ...))
+            {
+                return this->emplace_key(args..., std::forward<Args>(args)...);
+            }
+            else
+            {
+                return insert(Key(std::forward<Args>(args)...));
+            }
+        }
+
+        // the hint is not needed, the descent from the root touches a few nodes
+        template <typename... Args>
+        iterator emplace_hint(typename base::const_iterator, Args&&... args) { return emplace(std::forward<Args>(args)...).first; }
+};
+
+template <typename Policy, typename Compare, typename Allocator, size_t NodeBytes>
+void swap(detail::btree<Policy, Compare, Allocator, NodeBytes> &lhs, detail::btree<Policy, Compare, Allocator, NodeBytes> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
@@ -0,0 +1,246 @@
+/*
+    CONCURRENT STACK
+*/
+
+#ifndef CONCURRENT_STACK_H
+#define CONCURRENT_STACK_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include "hazard_pointer.hpp"
+
+namespace adstl
+{
+
+// Lock-free stack (Treiber stack) for many producer and consumer threads.
+//
+// push and try_pop are lock-free. Popped nodes go through hazard pointers, so a node is
+// never freed or reused while another thread is still reading it (no ABA). When the CAS on
+// top fails the thread backs off into an elimination array where a push and a pop can meet
+// and hand the element over without touching top at all, which keeps throughput up under
+// heavy contention.
+//
+// Nodes come from operator new, the arena and pool allocators are not thread safe.
+template <typename T>
+class concurrent_stack final
+{
+    public:
+
+        using s_type = T;
+
+        concurrent_stack() : top(nullptr), slots() {}
+        concurrent_stack(const concurrent_stack&) = delete;
+        concurrent_stack& operator=(const concurrent_stack&) = delete;
+        ~concurrent_stack();
+
+        template <typename U> void push(U&&);
+        template <typename... Args> void emplace(Args&&...);
+        bool try_pop(T&);
+
+        bool empty() const { return top.load(std::memory_order_acquire) == nullptr; } // only a snapshot under concurrency
+
+    private:
+
+        struct node
+        {
+            template <typename... Args>
+            explicit node(Args&&... args) : value(std::forward<Args>(args)...), next(nullptr) {}
+
+            T value;
+            node *next;
+        };
+
+        // one cache line per slot, a slot holds nullptr, a node offered by a push or taken()
+        struct alignas(64) slot
+        {
+            std::atomic<void*> offer{nullptr};
+        };
+
+        static constexpr size_t elimination_slots = 16;
+        static constexpr size_t elimination_spins = 256;
+
+        static void* taken()
+        {
+            static char marker;
+            return &marker;
+        }
+
+        static size_t random_slot();
+
+        void push_node(node*);
+        bool offer(node*);
+        node* take();
+
+        std::atomic<node*> top;
+        slot slots[elimination_slots];
+};
+
+template <typename T>
+concurrent_stack<T>::~concurrent_stack()
+{
+    // nobody else can touch the stack any more, nodes can be freed right away
+    node *n = top.load(std::memory_order_acquire);
+    while(n)
+    {
+        node *next = n->next;
+        delete n;
+        n = next;
+    }
+}
+
+template <typename T>
+template <typename U>
+void concurrent_stack<T>::push(U &&element)
+{
+    push_node(new node(std::forward<U>(element)));
+}
+
+template <typename T>
+template <typename... Args>
+void concurrent_stack<T>::emplace(Args&&... args)
+{
+    push_node(new node(std::forward<Args>(args)...));
+}
+
+template <typename T>
+bool concurrent_stack<T>::try_pop(T &out)
+{
+    node *n = nullptr;
+
+    {
+        hazard_pointers::guard guard;
+        for(;;)
+        {
+            n = guard.protect(top);
+            if(n == nullptr)
+            {
+                // a push might be waiting in the elimination array right now
+                if((n = take()))
+                {
+                    break;
+                }
+                return false;
+            }
+
+            // n is protected, n->next can be read even if another thread pops n meanwhile
+            if(top.compare_exchange_strong(n, n->next, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                // n was published through top, other threads may still hold it in a guard
+                struct retire_on_exit
+                {
+                    ~retire_on_exit() { hazard_pointers::retire(n); }
+                    node *n;
+                } retire{n};
+
+                guard.reset();
+                out = std::move(n->value);
+                return true;
+            }
+
+            if((n = take()))
+            {
+                break;
+            }
+        }
+    }
+
+    // taken straight from a push, no other thread ever saw it
+    struct delete_on_exit
+    {
+        ~delete_on_exit() { delete n; }
+        node *n;
+    } owner{n};
+
+    out = std::move(n->value);
+    return true;
+}
+
+template <typename T>
+void concurrent_stack<T>::push_node(node *n)
+{
+    node *old = top.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        n->next = old;
+        if(top.compare_exchange_strong(old, n, std::memory_order_release, std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        if(offer(n))
+        {
+            return;
+        }
+        old = top.load(std::memory_order_relaxed);
+    }
+}
+
+// parks n in a free slot for a while, true when a pop took it
+template <typename T>
+bool concurrent_stack<T>::offer(node *n)
+{
+    std::atomic<void*> &s = slots[random_slot()].offer;
+
+    void *expected = nullptr;
+    if(!s.compare_exchange_strong(expected, n, std::memory_order_release, std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i != elimination_spins; ++i)
+    {
+        if(s.load(std::memory_order_relaxed) == taken())
+        {
+            break;
+        }
+    }
+
+    // only the offering thread empties the slot again, so a new offer can not reuse it
+    // (and the address of n) before this CAS has run
+    expected = n;
+    if(s.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    s.store(nullptr, std::memory_order_relaxed);
+    return true;
+}
+
+// takes a node offered by a concurrent push, nullptr when the chosen slot is empty
+template <typename T>
+typename concurrent_stack<T>::node* concurrent_stack<T>::take()
+{
+    std::atomic<void*> &s = slots[random_slot()].offer;
+
+    void *offered = s.load(std::memory_order_relaxed);
+    if(offered == nullptr || offered == taken())
+    {
+        return nullptr;
+    }
+
+    // nothing in the node is read before the CAS, whoever wins the slot owns the node
+    if(s.compare_exchange_strong(offered, taken(), std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        return static_cast<node*>(offered);
+    }
+    return nullptr;
+}
+
+template <typename T>
+size_t concurrent_stack<T>::random_slot()
+{
+    // xorshift, seeded per thread from the address of its state
+    static thread_local std::uint32_t state = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(&state) >> 4) | 1;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state % elimination_slots;
+}
+
+}
+
+#endif
@@ -4,4 +4,14 @@
 // Uncomment the following line to enable throwable operations
 #define ADSTL_THROWABLE
 
+// Nothing can be thrown in a -fno-exceptions build, errors then go through the try_ members
+// that return adstl::expected, see expected.hpp
+#if defined(ADSTL_THROWABLE) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS)
+#undef ADSTL_THROWABLE
+#endif
+
+// Uncomment the following line to count allocations, reallocations and element moves/copies
+// per container type, see instrumentation.hpp
+// #define ADSTL_INSTRUMENTATION
+
 #endif
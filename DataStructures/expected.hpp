@@ -0,0 +1,238 @@
+/*
+    EXPECTED
+*/
+
+#ifndef EXPECTED_H
+#define EXPECTED_H
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "config.hpp" // Include the configuration header
+
+// Error reporting that works the same with and without exceptions.
+//
+// The try_ members (try_at, try_insert, try_top, try_pop) never throw for a bad index or an
+// empty container, they return adstl::expected holding either the result or an adstl::errc:
+//
+//     if (auto top = stack.try_top()) use(*top);
+//     else if (top.error() == adstl::errc::empty) ...
+//
+// The success path is one compare and a branch marked ADSTL_LIKELY, no unwinding tables
+// are needed. The throwing members keep their behaviour with ADSTL_THROWABLE, without it
+// an error that can not be returned (top() of an empty stack) aborts through ADSTL_FAIL
+// instead of running into undefined behaviour.
+
+// branch hints, [[likely]] and [[unlikely]] are C++20, older standards get no hint
+#if __cplusplus >= 202002L
+#define ADSTL_LIKELY [[likely]]
+#define ADSTL_UNLIKELY [[unlikely]]
+#else
+#define ADSTL_LIKELY
+#define ADSTL_UNLIKELY
+#endif
+
+// ADSTL_FAIL(exception) throws with ADSTL_THROWABLE and aborts otherwise, for members that
+// have no value to return on error
+#ifdef ADSTL_THROWABLE
+#define ADSTL_FAIL(exception) throw exception
+#else
+#define ADSTL_FAIL(exception) std::abort()
+#endif
+
+// rollback blocks, with -fno-exceptions the handler is dead code and nothing is rethrown
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define ADSTL_TRY try
+#define ADSTL_CATCH_ALL catch(...)
+#define ADSTL_RETHROW throw
+#else
+#define ADSTL_TRY if(true)
+#define ADSTL_CATCH_ALL else
+#define ADSTL_RETHROW ((void)0)
+#endif
+
+namespace adstl
+{
+
+enum class errc : unsigned char
+{
+    out_of_range = 1, // index or position past the end
+    empty,            // top or pop of an empty container
+};
+
+inline const char* describe(errc e)
+{
+    switch(e)
+    {
+        case errc::out_of_range: return "out of range";
+        case errc::empty: return "container is empty";
+    }
+    return "unknown error";
+}
+
+// tag to build an expected that holds an error, adstl::unexpected(errc::empty)
+struct unexpected
+{
+    explicit constexpr unexpected(errc e) : code(e) {}
+    errc code;
+};
+
+// value or error, operator* and operator-> do not check, value() fails with ADSTL_FAIL
+template <typename T>
+class [[nodiscard]] expected
+{
+    public:
+
+        using value_type = T;
+
+        expected(const T &v) : has_val(true) { ::new (static_cast<void*>(std::addressof(val))) T(v); }
+        expected(T &&v) : has_val(true) { ::new (static_cast<void*>(std::addressof(val))) T(std::move(v)); }
+        expected(unexpected e) : err(e.code), has_val(false) {}
+
+        expected(const expected &rhs) : has_val(rhs.has_val)
+        {
+            if(has_val)
+                ::new (static_cast<void*>(std::addressof(val))) T(rhs.val);
+            else
+                err = rhs.err;
+        }
+
+        expected(expected &&rhs) noexcept(std::is_nothrow_move_constructible_v<T>) : has_val(rhs.has_val)
+        {
+            if(has_val)
+                ::new (static_cast<void*>(std::addressof(val))) T(std::move(rhs.val));
+            else
+                err = rhs.err;
+        }
+
+        expected& operator=(const expected &rhs)
+        {
+            if(this != &rhs)
+            {
+                destroy();
+                ::new (static_cast<void*>(this)) expected(rhs);
+            }
+            return *this;
+        }
+
+        expected& operator=(expected &&rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if(this != &rhs)
+            {
+                destroy();
+                ::new (static_cast<void*>(this)) expected(std::move(rhs));
+            }
+            return *this;
+        }
+
+        ~expected() { destroy(); }
+
+        bool has_value() const noexcept { return has_val; }
+        explicit operator bool() const noexcept { return has_val; }
+
+        T& operator*() & { return val; }
+        const T& operator*() const & { return val; }
+        T&& operator*() && { return std::move(val); }
+        T* operator->() { return std::addressof(val); }
+        const T* operator->() const { return std::addressof(val); }
+
+        T& value() & { check(); return val; }
+        const T& value() const & { check(); return val; }
+        T&& value() && { check(); return std::move(val); }
+
+        template <typename U> T value_or(U &&other) const & { return has_val ? val : static_cast<T>(std::forward<U>(other)); }
+        template <typename U> T value_or(U &&other) && { return has_val ? std::move(val) : static_cast<T>(std::forward<U>(other)); }
+
+        // only meaningful when has_value() is false
+        errc error() const noexcept { return err; }
+
+    private:
+
+        void check() const
+        {
+            if(!has_val)
+            {
+                ADSTL_FAIL(std::logic_error(std::string("expected::value: ") + describe(err)));
+            }
+        }
+
+        void destroy()
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                if(has_val)
+                    val.~T();
+            }
+        }
+
+        union
+        {
+            T val;
+            errc err;
+        };
+        bool has_val;
+};
+
+// reference result, e.g. try_at and try_top, a pointer underneath
+template <typename T>
+class [[nodiscard]] expected<T&>
+{
+    public:
+
+        using value_type = T&;
+
+        expected(T &v) noexcept : ptr(std::addressof(v)), err() {}
+        expected(unexpected e) noexcept : ptr(nullptr), err(e.code) {}
+
+        bool has_value() const noexcept { return ptr != nullptr; }
+        explicit operator bool() const noexcept { return ptr != nullptr; }
+
+        T& operator*() const { return *ptr; }
+        T* operator->() const { return ptr; }
+
+        T& value() const
+        {
+            if(!ptr)
+            {
+                ADSTL_FAIL(std::logic_error(std::string("expected::value: ") + describe(err)));
+            }
+            return *ptr;
+        }
+
+        template <typename U> std::remove_cv_t<T> value_or(U &&other) const { return ptr ? *ptr : static_cast<std::remove_cv_t<T>>(std::forward<U>(other)); }
+
+        errc error() const noexcept { return err; }
+
+    private:
+        T *ptr;
+        errc err;
+};
+
+// success or error, e.g. try_insert on the lists
+template <>
+class [[nodiscard]] expected<void>
+{
+    public:
+
+        using value_type = void;
+
+        expected() noexcept : err(), has_val(true) {}
+        expected(unexpected e) noexcept : err(e.code), has_val(false) {}
+
+        bool has_value() const noexcept { return has_val; }
+        explicit operator bool() const noexcept { return has_val; }
+
+        errc error() const noexcept { return err; }
+
+    private:
+        errc err;
+        bool has_val;
+};
+
+}
+
+#endif
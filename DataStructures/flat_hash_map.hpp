@@ -0,0 +1,1103 @@
+/*
+    FLAT HASH MAP
+*/
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "config.hpp" // Include the configuration header
+#include "type_traits.hpp"
+#include "growth.hpp"
+#include "expected.hpp"
+#include "instrumentation.hpp"
+
+namespace adstl
+{
+
+// Open addressing hash map and set, the elements live in one contiguous array of slots
+// and a parallel array of one control byte per slot:
+//
+//     empty   0b10000000
+//     deleted 0b11111110
+//     full    0b0hhhhhhh  the low 7 bits of the element's hash
+//
+// Slots are probed 16 at a time: the group's control bytes are compared against the 7 bit
+// tag with one SSE2 compare and movemask, and only the slots whose tag matches have their
+// keys compared. A lookup stops at the first group that has an empty slot, so a miss
+// usually costs one group load. Groups are visited quadratically.
+//
+// The table holds at most 7/8 of its capacity. The capacity is a power of two, at least 16;
+// when the table is full the growth policy picks the next capacity (see growth.hpp) and it
+// is rounded up to a power of two. reserve(n) makes room for n elements without a rehash.
+//
+// With a Hash and a KeyEqual that both define is_transparent, find, contains, count and
+// erase take any key type the two accept, e.g. a std::string_view for std::string keys:
+//
+//     adstl::flat_hash_map<std::string, int, adstl::string_hash, std::equal_to<>> m;
+//     m.find(std::string_view("key"));
+//
+// Inserting or erasing invalidates iterators, a rehash also invalidates references.
+// The map stores std::pair<Key, T>, the key must not be changed through an iterator.
+
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<Key, T>>, typename GrowthPolicy = geometric_growth<2, 1>>
+class flat_hash_map;
+
+template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<Key>, typename GrowthPolicy = geometric_growth<2, 1>>
+class flat_hash_set;
+
+// transparent hash for std::string keys, looks up std::string_view and const char* as well
+struct string_hash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>()(s); }
+};
+
+namespace detail
+{
+
+using ctrl_t = signed char;
+
+inline constexpr ctrl_t ctrl_empty = -128;
+inline constexpr ctrl_t ctrl_deleted = -2;
+inline constexpr ctrl_t ctrl_sentinel = -1; // after the last slot, stops iteration
+inline constexpr size_t group_width = 16;
+
+// control bytes of an empty table, lookups need no capacity check
+inline ctrl_t* empty_group()
+{
+    alignas(16) static ctrl_t bytes[group_width] = {ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+                                                    ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+                                                    ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty};
+    return bytes;
+}
+
+// 16 control bytes, every match returns one bit per byte
+struct group
+{
+    #if defined(__SSE2__)
+
+    explicit group(const ctrl_t *p) : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+    uint32_t match(ctrl_t tag) const
+    {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), bytes)));
+    }
+
+    uint32_t match_empty() const { return match(ctrl_empty); }
+
+    // empty and deleted are the only bytes below the sentinel
+    uint32_t match_empty_or_deleted() const
+    {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), bytes)));
+    }
+
+    uint32_t match_full_or_sentinel() const
+    {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(ctrl_deleted))));
+    }
+
+    __m128i bytes;
+
+    #else
+
+    explicit group(const ctrl_t *p) { std::memcpy(bytes, p, group_width); }
+
+    template <typename F>
+    uint32_t mask(F &&f) const
+    {
+        uint32_t m = 0;
+        for(size_t i = 0; i != group_width; ++i)
+        {
+            m |= static_cast<uint32_t>(f(bytes[i])) << i;
+        }
+        return m;
+    }
+
+    uint32_t match(ctrl_t tag) const { return mask([tag](ctrl_t c) { return c == tag; }); }
+    uint32_t match_empty() const { return match(ctrl_empty); }
+    uint32_t match_empty_or_deleted() const { return mask([](ctrl_t c) { return c < ctrl_sentinel; }); }
+    uint32_t match_full_or_sentinel() const { return mask([](ctrl_t c) { return c > ctrl_deleted; }); }
+
+    ctrl_t bytes[group_width];
+
+    #endif
+};
+
+inline size_t lowest_bit(uint32_t mask) { return static_cast<size_t>(__builtin_ctz(mask)); }
+
+// std::hash of an integer is the integer itself, mix it so the tag and the group index
+// both get well spread bits (murmur3 finalizer)
+inline uint64_t mix_hash(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline ctrl_t hash_tag(uint64_t h) { return static_cast<ctrl_t>(h & 0x7f); }
+inline size_t hash_group(uint64_t h) { return static_cast<size_t>(h >> 7); }
+
+// groups offset, offset + 1, offset + 3, offset + 6, ... visits every group of a power of two table
+class probe_sequence
+{
+    public:
+        probe_sequence(size_t start, size_t group_mask) : group_mask(group_mask), offset(start & group_mask), index(0) {}
+
+        size_t slot() const { return offset * group_width; }
+        void next()
+        {
+            ++index;
+            offset = (offset + index) & group_mask;
+        }
+
+    private:
+        size_t group_mask;
+        size_t offset;
+        size_t index;
+};
+
+template <typename Hash, typename KeyEqual, typename = void>
+inline constexpr bool is_transparent_v = false;
+
+template <typename Hash, typename KeyEqual>
+inline constexpr bool is_transparent_v<Hash, KeyEqual, std::void_t<typename Hash::is_transparent, typename KeyEqual::is_transparent>> = true;
+
+// the code shared by flat_hash_map and flat_hash_set, Policy says how a slot holds its key
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+class flat_hash_table
+{
+    public:
+
+        using key_type = typename Policy::key_type;
+        using value_type = typename Policy::value_type;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using allocator_type = Allocator;
+        using growth_policy = GrowthPolicy;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+
+    private:
+
+        using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+        using slot_traits = std::allocator_traits<slot_allocator>;
+        using ctrl_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<ctrl_t>;
+        using ctrl_traits = std::allocator_traits<ctrl_allocator>;
+
+        template <bool Const>
+        class basic_iterator
+        {
+            friend class flat_hash_table;
+
+            public:
+
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename Policy::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+                using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+                basic_iterator() : ctrl(nullptr), slot(nullptr) {}
+                // iterator to const_iterator
+                template <bool C = Const, typename = std::enable_if_t<C>>
+                basic_iterator(const basic_iterator<false> &rhs) : ctrl(rhs.ctrl), slot(rhs.slot) {}
+
+                reference operator*() const { return *slot; }
+                pointer operator->() const { return slot; }
+
+                basic_iterator& operator++()
+                {
+                    ++ctrl;
+                    ++slot;
+                    skip_free();
+                    return *this;
+                }
+
+                basic_iterator operator++(int)
+                {
+                    basic_iterator old = *this;
+                    ++*this;
+                    return old;
+                }
+
+                friend bool operator==(const basic_iterator &lhs, const basic_iterator &rhs) { return lhs.ctrl == rhs.ctrl; }
+                friend bool operator!=(const basic_iterator &lhs, const basic_iterator &rhs) { return lhs.ctrl != rhs.ctrl; }
+
+            private:
+
+                template <bool> friend class basic_iterator;
+
+                basic_iterator(ctrl_t *ctrl, value_type *slot) : ctrl(ctrl), slot(slot) {}
+
+                // on to the next full slot or the sentinel, a group at a time
+                void skip_free()
+                {
+                    for(;;)
+                    {
+                        uint32_t mask = group(ctrl).match_full_or_sentinel();
+                        if(mask)
+                        {
+                            size_t i = lowest_bit(mask);
+                            ctrl += i;
+                            slot += i;
+                            return;
+                        }
+                        ctrl += group_width;
+                        slot += group_width;
+                    }
+                }
+
+                ctrl_t *ctrl;
+                value_type *slot;
+        };
+
+    public:
+
+        // a set hands out const elements only
+        using const_iterator = basic_iterator<true>;
+        using iterator = std::conditional_t<Policy::constant_elements, const_iterator, basic_iterator<false>>;
+
+        flat_hash_table() : flat_hash_table(Allocator()) {}
+        explicit flat_hash_table(const Allocator &a, const Hash &h = Hash(), const KeyEqual &e = KeyEqual())
+            : hash_fn(h), equal_fn(e), alloc(a), ctrl(empty_group()), slots(nullptr), cap(0), sz(0), growth_left(0) {}
+        flat_hash_table(const flat_hash_table &rhs)
+            : flat_hash_table(rhs, slot_traits::select_on_container_copy_construction(rhs.alloc)) {}
+        flat_hash_table(flat_hash_table&&) noexcept;
+        ~flat_hash_table();
+
+        flat_hash_table& operator=(const flat_hash_table&);
+        flat_hash_table& operator=(flat_hash_table&&)
+            noexcept(slot_traits::propagate_on_container_move_assignment::value || slot_traits::is_always_equal::value);
+
+        allocator_type get_allocator() const { return allocator_type(alloc); }
+        hasher hash_function() const { return hash_fn; }
+        key_equal key_eq() const { return equal_fn; }
+        void swap(flat_hash_table&) noexcept;
+
+        iterator begin() { return make_begin<iterator>(); }
+        iterator end() { return iterator(ctrl + cap, slots + cap); }
+        const_iterator begin() const { return const_cast<flat_hash_table&>(*this).template make_begin<const_iterator>(); }
+        const_iterator end() const { return const_iterator(ctrl + cap, slots + cap); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        size_t size() const { return sz; }
+        bool empty() const { return sz == 0; }
+        size_t capacity() const { return cap; }
+        size_t max_size() const;
+        float load_factor() const { return cap ? static_cast<float>(sz) / static_cast<float>(cap) : 0.0f; }
+
+        void reserve(size_t); // room for n elements without a rehash
+        void rehash(size_t n) { resize(capacity_for(n > sz ? n : sz)); } // rebuild with room for n, drops deleted slots
+        void clear();
+
+        // lookups, the templates only take part with a transparent Hash and KeyEqual
+        iterator find(const key_type &key) { return find_key(key); }
+        const_iterator find(const key_type &key) const { return const_cast<flat_hash_table&>(*this).find_key(key); }
+        bool contains(const key_type &key) const { return find(key) != end(); }
+        size_t count(const key_type &key) const { return contains(key); }
+
+        template <typename K, typename H = Hash, typename = std::enable_if_t<is_transparent_v<H, KeyEqual>>>
+        iterator find(const K &key) { return find_key(key); }
+        template <typename K, typename H = Hash, typename = std::enable_if_t<is_transparent_v<H, KeyEqual>>>
+        const_iterator find(const K &key) const { return const_cast<flat_hash_table&>(*this).find_key(key); }
+        template <typename K, typename H = Hash, typename = std::enable_if_t<is_transparent_v<H, KeyEqual>>>
+        bool contains(const K &key) const { return find(key) != end(); }
+        template <typename K, typename H = Hash, typename = std::enable_if_t<is_transparent_v<H, KeyEqual>>>
+        size_t count(const K &key) const { return contains(key); }
+
+        template <typename It> void insert(It, It);
+        void insert(std::initializer_list<value_type> list) { insert(list.begin(), list.end()); }
+
+        // the iterator to the next element
+        iterator erase(const_iterator);
+        template <typename It = iterator, typename = std::enable_if_t<!std::is_same_v<It, const_iterator>>>
+        iterator erase(iterator it) { return erase(const_iterator(it)); }
+        size_t erase(const key_type &key) { return erase_key(key); }
+        template <typename K, typename H = Hash, typename = std::enable_if_t<is_transparent_v<H, KeyEqual> &&
+                  !std::is_convertible_v<const K&, const_iterator>>>
+        size_t erase(const K &key) { return erase_key(key); }
+
+    protected:
+
+        flat_hash_table(const flat_hash_table&, const Allocator&);
+
+        // finds key, or constructs value_type(args...) in a new slot when it is not there yet
+        template <typename K, typename... Args> std::pair<iterator, bool> emplace_key(const K&, Args&&...);
+
+    private:
+
+        static constexpr size_t min_capacity = group_width;
+
+        template <typename It>
+        It make_begin()
+        {
+            if(sz == 0)
+            {
+                return It(ctrl + cap, slots + cap);
+            }
+            It it(ctrl, slots);
+            it.skip_free();
+            return it;
+        }
+
+        template <typename K> uint64_t hash_of(const K &key) const { return mix_hash(static_cast<uint64_t>(hash_fn(key))); }
+        size_t group_mask() const { return cap ? cap / group_width - 1 : 0; }
+
+        template <typename K> iterator find_key(const K&);
+        template <typename K> size_t erase_key(const K&);
+
+        size_t find_free(uint64_t hash) const;  // first empty or deleted slot on the probe sequence
+        size_t prepare_insert(uint64_t hash);   // claims a slot for a new element, grows when needed
+        void set_ctrl(size_t i, ctrl_t c) { ctrl[i] = c; }
+        void erase_slot(size_t i);              // marks an already destroyed slot free
+
+        static size_t capacity_for(size_t n);   // smallest capacity that holds n elements
+        static size_t max_load(size_t capacity) { return capacity - capacity / 8; }
+        void grow();
+        void resize(size_t);                    // move every element to a table of the given capacity
+        void allocate_storage(size_t, ctrl_t*&, value_type*&);
+        void deallocate_storage(ctrl_t*, value_type*, size_t);
+        void release_storage(); // frees the storage and leaves the table empty
+        void destroy_elements();
+
+        Hash hash_fn;
+        KeyEqual equal_fn;
+        slot_allocator alloc;
+        ctrl_t *ctrl;       // cap control bytes, the sentinel, then padding so every group load stays inside
+        value_type *slots;
+        size_t cap;
+        size_t sz;
+        size_t growth_left; // inserts into empty slots left before the table has to grow
+};
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::flat_hash_table(const flat_hash_table &rhs, const Allocator &a)
+    : flat_hash_table(a, rhs.hash_fn, rhs.equal_fn)
+{
+    if(rhs.sz == 0)
+    {
+        return;
+    }
+
+    // same capacity and same control bytes, every element is copied to the same slot
+    ctrl_t *new_ctrl;
+    value_type *new_slots;
+    allocate_storage(rhs.cap, new_ctrl, new_slots);
+    std::memcpy(new_ctrl, rhs.ctrl, rhs.cap + group_width);
+
+    size_t i = 0;
+    ADSTL_TRY
+    {
+        for(; i != rhs.cap; ++i)
+        {
+            if(new_ctrl[i] >= 0)
+            {
+                slot_traits::construct(alloc, new_slots + i, rhs.slots[i]);
+            }
+        }
+    }
+    ADSTL_CATCH_ALL
+    {
+        while(i--)
+        {
+            if(new_ctrl[i] >= 0)
+            {
+                slot_traits::destroy(alloc, new_slots + i);
+            }
+        }
+        deallocate_storage(new_ctrl, new_slots, rhs.cap);
+        ADSTL_RETHROW;
+    }
+
+    ctrl = new_ctrl;
+    slots = new_slots;
+    cap = rhs.cap;
+    sz = rhs.sz;
+    growth_left = rhs.growth_left;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::flat_hash_table(flat_hash_table &&rhs) noexcept
+    : hash_fn(std::move(rhs.hash_fn)), equal_fn(std::move(rhs.equal_fn)), alloc(std::move(rhs.alloc)),
+      ctrl(rhs.ctrl), slots(rhs.slots), cap(rhs.cap), sz(rhs.sz), growth_left(rhs.growth_left)
+{
+    rhs.ctrl = empty_group();
+    rhs.slots = nullptr;
+    rhs.cap = rhs.sz = rhs.growth_left = 0;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::~flat_hash_table()
+{
+    destroy_elements();
+    release_storage();
+}
+
+// cpy=
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>& flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::operator=(const flat_hash_table &rhs)
+{
+    if(this != &rhs)
+    {
+        flat_hash_table copy(rhs, slot_traits::propagate_on_container_copy_assignment::value ? rhs.alloc : alloc);
+        destroy_elements();
+        release_storage();
+        if constexpr (slot_traits::propagate_on_container_copy_assignment::value)
+        {
+            alloc = rhs.alloc;
+        }
+
+        // copy was built with the allocator we keep, its storage can be taken over
+        hash_fn = copy.hash_fn;
+        equal_fn = copy.equal_fn;
+        std::swap(ctrl, copy.ctrl);
+        std::swap(slots, copy.slots);
+        std::swap(cap, copy.cap);
+        std::swap(sz, copy.sz);
+        std::swap(growth_left, copy.growth_left);
+    }
+    return *this;
+}
+
+// move=
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>& flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::operator=(flat_hash_table &&rhs)
+    noexcept(slot_traits::propagate_on_container_move_assignment::value || slot_traits::is_always_equal::value)
+{
+    if(this == &rhs)
+    {
+        return *this;
+    }
+
+    hash_fn = std::move(rhs.hash_fn);
+    equal_fn = std::move(rhs.equal_fn);
+
+    if constexpr (!slot_traits::propagate_on_container_move_assignment::value && !slot_traits::is_always_equal::value)
+    {
+        // rhs storage belongs to a different allocator, we can only move the elements one by one
+        if(alloc != rhs.alloc)
+        {
+            clear();
+            reserve(rhs.sz);
+            for(auto &value : rhs)
+            {
+                emplace_key(Policy::key(value), std::move(value));
+            }
+            rhs.clear();
+            return *this;
+        }
+    }
+
+    destroy_elements();
+    release_storage();
+
+    if constexpr (slot_traits::propagate_on_container_move_assignment::value)
+    {
+        alloc = std::move(rhs.alloc);
+    }
+
+    ctrl = rhs.ctrl;
+    slots = rhs.slots;
+    cap = rhs.cap;
+    sz = rhs.sz;
+    growth_left = rhs.growth_left;
+
+    rhs.ctrl = empty_group();
+    rhs.slots = nullptr;
+    rhs.cap = rhs.sz = rhs.growth_left = 0;
+    return *this;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::swap(flat_hash_table &rhs) noexcept
+{
+    using std::swap;
+    if constexpr (slot_traits::propagate_on_container_swap::value)
+    {
+        swap(alloc, rhs.alloc);
+    }
+    swap(hash_fn, rhs.hash_fn);
+    swap(equal_fn, rhs.equal_fn);
+    swap(ctrl, rhs.ctrl);
+    swap(slots, rhs.slots);
+    swap(cap, rhs.cap);
+    swap(sz, rhs.sz);
+    swap(growth_left, rhs.growth_left);
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+size_t flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::max_size() const
+{
+    // slot and control byte per element
+    const size_t bytes_max = std::numeric_limits<std::ptrdiff_t>::max() / (sizeof(value_type) + 1);
+    const size_t alloc_max = slot_traits::max_size(alloc);
+    return alloc_max < bytes_max ? alloc_max : bytes_max;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::reserve(size_t n)
+{
+    if(n > max_load(cap))
+    {
+        if(n > max_size())
+        {
+            #ifdef ADSTL_THROWABLE
+            throw std::length_error("flat_hash_map::reserve: requested size exceeds max_size().");
+            #endif
+
+            return;
+        }
+
+        resize(capacity_for(n));
+    }
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::clear()
+{
+    // the storage is kept for reuse
+    destroy_elements();
+    if(cap)
+    {
+        std::memset(ctrl, static_cast<unsigned char>(ctrl_empty), cap);
+    }
+    sz = 0;
+    growth_left = max_load(cap);
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+template <typename It>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::insert(It first, It last)
+{
+    if constexpr (is_random_access_iterator_v<It>)
+    {
+        reserve(sz + static_cast<size_t>(last - first));
+    }
+
+    for(; first != last; ++first)
+    {
+        emplace_key(Policy::key(*first), *first);
+    }
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+typename flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::iterator flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::erase(const_iterator pos)
+{
+    size_t i = pos.ctrl - ctrl;
+    slot_traits::destroy(alloc, slots + i);
+    erase_slot(i);
+
+    iterator next(ctrl + i, slots + i);
+    next.skip_free();
+    return next;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+template <typename K>
+typename flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::iterator flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::find_key(const K &key)
+{
+    const uint64_t hash = hash_of(key);
+    const ctrl_t tag = hash_tag(hash);
+
+    for(probe_sequence seq(hash_group(hash), group_mask());; seq.next())
+    {
+        group g(ctrl + seq.slot());
+        for(uint32_t mask = g.match(tag); mask; mask &= mask - 1)
+        {
+            size_t i = seq.slot() + lowest_bit(mask);
+            if(equal_fn(Policy::key(slots[i]), key)) ADSTL_LIKELY
+            {
+                return iterator(ctrl + i, slots + i);
+            }
+        }
+
+        // a probe for this key would have stopped here, it is not in the table
+        if(g.match_empty())
+        {
+            return end();
+        }
+    }
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+template <typename K>
+size_t flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::erase_key(const K &key)
+{
+    iterator it = find_key(key);
+    if(it == end())
+    {
+        return 0;
+    }
+
+    size_t i = it.ctrl - ctrl;
+    slot_traits::destroy(alloc, slots + i);
+    erase_slot(i);
+    return 1;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+template <typename K, typename... Args>
+std::pair<typename flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::iterator, bool>
+flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::emplace_key(const K &key, Args&&... args)
+{
+    iterator it = find_key(key);
+    if(it != end())
+    {
+        return {it, false};
+    }
+
+    const uint64_t hash = hash_of(key);
+    if(growth_left == 0) ADSTL_UNLIKELY
+    {
+        // growing frees the old slots and args may refer to one of them, key or value, so the
+        // element is built before the table is touched and moved into its slot afterwards
+        alignas(value_type) unsigned char buffer[sizeof(value_type)];
+        value_type *staged = reinterpret_cast<value_type*>(buffer);
+        slot_traits::construct(alloc, staged, std::forward<Args>(args)...);
+
+        size_t i = 0;
+        ADSTL_TRY
+        {
+            i = prepare_insert(hash);
+            ADSTL_TRY
+            {
+                slot_traits::construct(alloc, slots + i, std::move_if_noexcept(*staged));
+            }
+            ADSTL_CATCH_ALL
+            {
+                erase_slot(i);
+                ADSTL_RETHROW;
+            }
+        }
+        ADSTL_CATCH_ALL
+        {
+            slot_traits::destroy(alloc, staged);
+            ADSTL_RETHROW;
+        }
+        slot_traits::destroy(alloc, staged);
+        return {iterator(ctrl + i, slots + i), true};
+    }
+
+    // no growth, the slots stay where they are while args are read
+    size_t i = prepare_insert(hash);
+    ADSTL_TRY
+    {
+        slot_traits::construct(alloc, slots + i, std::forward<Args>(args)...);
+    }
+    ADSTL_CATCH_ALL
+    {
+        erase_slot(i);
+        ADSTL_RETHROW;
+    }
+    return {iterator(ctrl + i, slots + i), true};
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+size_t flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::find_free(uint64_t hash) const
+{
+    for(probe_sequence seq(hash_group(hash), group_mask());; seq.next())
+    {
+        uint32_t mask = group(ctrl + seq.slot()).match_empty_or_deleted();
+        if(mask)
+        {
+            return seq.slot() + lowest_bit(mask);
+        }
+    }
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+size_t flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::prepare_insert(uint64_t hash)
+{
+    size_t i = find_free(hash);
+
+    // a deleted slot can always be reused, an empty one only while the load limit allows
+    if(growth_left == 0 && ctrl[i] != ctrl_deleted) ADSTL_UNLIKELY
+    {
+        grow();
+        i = find_free(hash);
+    }
+
+    growth_left -= ctrl[i] == ctrl_empty;
+    set_ctrl(i, hash_tag(hash));
+    ++sz;
+    return i;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::erase_slot(size_t i)
+{
+    // Probes look at whole groups and stop at a group with an empty slot. If the group of
+    // i still has one, no probe ever went past it and i can be empty again, otherwise it
+    // has to stay a tombstone so the probes through it keep going.
+    size_t first = i - i % group_width;
+    if(group(ctrl + first).match_empty())
+    {
+        set_ctrl(i, ctrl_empty);
+        ++growth_left;
+    }
+    else
+    {
+        set_ctrl(i, ctrl_deleted);
+    }
+    --sz;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+size_t flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::capacity_for(size_t n)
+{
+    size_t capacity = min_capacity;
+    while(max_load(capacity) < n)
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::grow()
+{
+    // mostly tombstones, rebuilding at the same capacity frees them without using more memory
+    if(cap && sz <= max_load(cap) / 2)
+    {
+        resize(cap);
+        return;
+    }
+
+    if(sz >= max_load(max_size()))
+    {
+        ADSTL_FAIL(std::length_error("flat_hash_map: size exceeds max_size()."));
+    }
+
+    size_t wanted = GrowthPolicy::grow(cap, sizeof(value_type), max_size());
+    size_t needed = capacity_for(sz + 1);
+    resize(capacity_for(max_load(wanted > needed ? wanted : needed)));
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::resize(size_t new_capacity)
+{
+    ctrl_t *old_ctrl = ctrl;
+    value_type *old_slots = slots;
+    size_t old_capacity = cap;
+
+    ctrl_t *new_ctrl;
+    value_type *new_slots;
+    allocate_storage(new_capacity, new_ctrl, new_slots);
+    ADSTL_COUNT(flat_hash_map, reallocations, 1);
+
+    ctrl = new_ctrl;
+    slots = new_slots;
+    cap = new_capacity;
+
+    // nothing is freed until every element is in the new table
+    constexpr bool nothrow_move = std::is_nothrow_move_constructible_v<value_type>;
+    if constexpr (nothrow_move)
+        ADSTL_COUNT(flat_hash_map, elements_moved, sz);
+    else
+        ADSTL_COUNT(flat_hash_map, elements_copied, sz);
+
+    size_t i = 0;
+    ADSTL_TRY
+    {
+        for(; i != old_capacity; ++i)
+        {
+            if(old_ctrl[i] >= 0)
+            {
+                uint64_t hash = hash_of(Policy::key(old_slots[i]));
+                size_t target = find_free(hash);
+                slot_traits::construct(alloc, slots + target, std::move_if_noexcept(old_slots[i]));
+                set_ctrl(target, hash_tag(hash));
+            }
+        }
+    }
+    ADSTL_CATCH_ALL
+    {
+        // only copies were made, the old table is still complete
+        destroy_elements();
+        deallocate_storage(ctrl, slots, cap);
+        ctrl = old_ctrl;
+        slots = old_slots;
+        cap = old_capacity;
+        ADSTL_RETHROW;
+    }
+
+    for(i = 0; i != old_capacity; ++i)
+    {
+        if(old_ctrl[i] >= 0)
+        {
+            slot_traits::destroy(alloc, old_slots + i);
+        }
+    }
+    deallocate_storage(old_ctrl, old_slots, old_capacity);
+
+    growth_left = max_load(cap) - sz;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::allocate_storage(size_t capacity, ctrl_t *&new_ctrl, value_type *&new_slots)
+{
+    ctrl_allocator ctrl_alloc(alloc);
+    new_ctrl = ctrl_traits::allocate(ctrl_alloc, capacity + group_width);
+    ADSTL_TRY
+    {
+        new_slots = slot_traits::allocate(alloc, capacity);
+    }
+    ADSTL_CATCH_ALL
+    {
+        ctrl_traits::deallocate(ctrl_alloc, new_ctrl, capacity + group_width);
+        ADSTL_RETHROW;
+    }
+    ADSTL_COUNT_ALLOCATION(flat_hash_map, capacity, capacity * sizeof(value_type) + capacity + group_width);
+
+    std::memset(new_ctrl, static_cast<unsigned char>(ctrl_empty), capacity + group_width);
+    new_ctrl[capacity] = ctrl_sentinel;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::deallocate_storage(ctrl_t *old_ctrl, value_type *old_slots, size_t capacity)
+{
+    if(capacity)
+    {
+        ctrl_allocator ctrl_alloc(alloc);
+        ctrl_traits::deallocate(ctrl_alloc, old_ctrl, capacity + group_width);
+        slot_traits::deallocate(alloc, old_slots, capacity);
+    }
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::release_storage()
+{
+    deallocate_storage(ctrl, slots, cap);
+    ctrl = empty_group();
+    slots = nullptr;
+    cap = sz = growth_left = 0;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy>::destroy_elements()
+{
+    if constexpr (!std::is_trivially_destructible_v<value_type>)
+    {
+        for(size_t i = 0; i != cap; ++i)
+        {
+            if(ctrl[i] >= 0)
+            {
+                slot_traits::destroy(alloc, slots + i);
+            }
+        }
+    }
+}
+
+template <typename Key, typename T>
+struct map_policy
+{
+    using key_type = Key;
+    using value_type = std::pair<Key, T>;
+    static constexpr bool constant_elements = false;
+
+    static const Key& key(const value_type &value) { return value.first; }
+};
+
+template <typename Key>
+struct set_policy
+{
+    using key_type = Key;
+    using value_type = Key;
+    static constexpr bool constant_elements = true;
+
+    static const Key& key(const Key &value) { return value; }
+};
+
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+class flat_hash_map final : public detail::flat_hash_table<detail::map_policy<Key, T>, Hash, KeyEqual, Allocator, GrowthPolicy>
+{
+    using base = detail::flat_hash_table<detail::map_policy<Key, T>, Hash, KeyEqual, Allocator, GrowthPolicy>;
+
+    public:
+
+        using mapped_type = T;
+        using typename base::key_type;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        using base::base;
+        flat_hash_map() = default;
+        flat_hash_map(std::initializer_list<value_type> list, const Allocator &a = Allocator()) : base(a) { insert(list); }
+
+        using base::insert;
+        std::pair<iterator, bool> insert(const value_type &value) { return this->emplace_key(value.first, value); }
+        std::pair<iterator, bool> insert(value_type &&value) { return this->emplace_key(value.first, std::move(value)); }
+
+        // nothing is constructed when the key is already there, as long as it can be found
+        // without building a key_type
+        template <typename... Args> std::pair<iterator, bool> emplace(Args&&...);
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type &key, Args&&... args)
+        {
+            return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type &&key, Args&&... args)
+        {
+            return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        T& operator[](const key_type &key) { return try_emplace(key).first->second; }
+        T& operator[](key_type &&key) { return try_emplace(std::move(key)).first->second; }
+
+        // bounds checked access
+        T& at(const key_type&);
+        const T& at(const key_type&) const;
+        // no exceptions, errc::out_of_range when the key is missing
+        expected<T&> try_at(const key_type &key);
+        expected<const T&> try_at(const key_type &key) const;
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+template <typename... Args>
+std::pair<typename flat_hash_map<Key, T, Hash, KeyEqual, Allocator, GrowthPolicy>::iterator, bool>
+flat_hash_map<Key, T, Hash, KeyEqual, Allocator, GrowthPolicy>::emplace(Args&&... args)
+{
+    if constexpr (sizeof...(Args) == 2)
+    {
+        using first_arg = std::decay_t<std::tuple_element_t<0, std::tuple<Args...>>>;
+        if constexpr (std::is_same_v<first_arg, Key> || detail::is_transparent_v<Hash, KeyEqual>)
+        {
+            // the key can be looked up as it is
+            const auto &key = std::get<0>(std::forward_as_tuple(args...));
+            return this->emplace_key(key, std::forward<Args>(args)...);
+        }
+        else
+        {
+            value_type value(std::forward<Args>(args)...);
+            return insert(std::move(value));
+        }
+    }
+    else if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, value_type> && ...))
+    {
+        return insert(std::forward<Args>(args)...);
+    }
+    else
+    {
+        value_type value(std::forward<Args>(args)...);
+        return insert(std::move(value));
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+T& flat_hash_map<Key, T, Hash, KeyEqual, Allocator, GrowthPolicy>::at(const key_type &key)
+{
+    iterator it = this->find(key);
+    if(it != this->end()) ADSTL_LIKELY
+    {
+        return it->second;
+    }
+    ADSTL_FAIL(std::out_of_range("flat_hash_map::at: key not found."));
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+const T& flat_hash_map<Key, T, Hash, KeyEqual, Allocator, GrowthPolicy>::at(const key_type &key) const
+{
+    const_iterator it = this->find(key);
+    if(it != this->end()) ADSTL_LIKELY
+    {
+        return it->second;
+    }
+    ADSTL_FAIL(std::out_of_range("flat_hash_map::at: key not found."));
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+expected<T&> flat_hash_map<Key, T, Hash, KeyEqual, Allocator, GrowthPolicy>::try_at(const key_type &key)
+{
+    iterator it = this->find(key);
+    if(it != this->end()) ADSTL_LIKELY
+    {
+        return it->second;
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+expected<const T&> flat_hash_map<Key, T, Hash, KeyEqual, Allocator, GrowthPolicy>::try_at(const key_type &key) const
+{
+    const_iterator it = this->find(key);
+    if(it != this->end()) ADSTL_LIKELY
+    {
+        return it->second;
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename Key, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+class flat_hash_set final : public detail::flat_hash_table<detail::set_policy<Key>, Hash, KeyEqual, Allocator, GrowthPolicy>
+{
+    using base = detail::flat_hash_table<detail::set_policy<Key>, Hash, KeyEqual, Allocator, GrowthPolicy>;
+
+    public:
+
+        using typename base::key_type;
+        using typename base::value_type;
+        using typename base::iterator;
+
+        using base::base;
+        flat_hash_set() = default;
+        flat_hash_set(std::initializer_list<value_type> list, const Allocator &a = Allocator()) : base(a) { insert(list); }
+
+        using base::insert;
+        std::pair<iterator, bool> insert(const value_type &value) { return this->emplace_key(value, value); }
+        std::pair<iterator, bool> insert(value_type &&value) { return this->emplace_key(value, std::move(value)); }
+
+        template <typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            if constexpr (sizeof...(Args) == 1 && ((std::is_same_v<std::decay_t<Args>, Key> || detail::is_transparent_v<Hash, KeyEqual>) && ...))
+            {
+                return this->emplace_key(args..., std::forward<Args>(args)...);
+            }
+            else
+            {
+                return insert(Key(std::forward<Args>(args)...));
+            }
+        }
+};
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Allocator, typename GrowthPolicy>
+void swap(detail::flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy> &lhs, detail::flat_hash_table<Policy, Hash, KeyEqual, Allocator, GrowthPolicy> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
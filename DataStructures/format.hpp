@@ -0,0 +1,187 @@
+/*
+    FORMATTING
+*/
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <ostream>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace adstl
+{
+
+// How a container is printed: every element is followed by separator, after max_elements
+// elements the rest is cut off and "..." printed instead.
+struct format_options
+{
+    std::string_view separator = " ";
+    size_t max_elements = std::numeric_limits<size_t>::max();
+};
+
+namespace detail
+{
+
+template <typename T>
+inline constexpr bool is_character_v =
+    std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char> ||
+    std::is_same_v<T, wchar_t> || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+// numbers std::to_chars prints exactly like operator<< does on a plain stream
+template <typename T>
+inline constexpr bool to_chars_formattable_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !is_character_v<T>;
+
+// default flags, no width and the classic locale, nothing operator<< would print differently
+inline bool plain_stream(const std::ostream &os)
+{
+    return (os.flags() & ~std::ios_base::skipws) == std::ios_base::dec && os.width() == 0 &&
+           os.getloc() == std::locale::classic();
+}
+
+// collects formatted output and hands it to the stream in big chunks, one sentry per chunk
+class format_buffer
+{
+    public:
+
+        explicit format_buffer(std::ostream &os) : os(os), used(0) {}
+        format_buffer(const format_buffer&) = delete;
+        format_buffer& operator=(const format_buffer&) = delete;
+        ~format_buffer() { flush(); }
+
+        void flush()
+        {
+            if(used)
+            {
+                os.write(buffer, static_cast<std::streamsize>(used));
+                used = 0;
+            }
+        }
+
+        void append(std::string_view s)
+        {
+            if(s.size() > sizeof(buffer) - used)
+            {
+                flush();
+                if(s.size() > sizeof(buffer))
+                {
+                    os.write(s.data(), static_cast<std::streamsize>(s.size()));
+                    return;
+                }
+            }
+            std::memcpy(buffer + used, s.data(), s.size());
+            used += s.size();
+        }
+
+        template <typename T>
+        void append_number(T value, int precision)
+        {
+            if(!try_append(value, precision))
+            {
+                flush();
+                if(!try_append(value, precision))
+                {
+                    os << value; // longer than the whole buffer, only with a huge precision
+                }
+            }
+        }
+
+    private:
+
+        template <typename T>
+        bool try_append(T value, int precision)
+        {
+            std::to_chars_result r;
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                r = std::to_chars(buffer + used, buffer + sizeof(buffer), value, std::chars_format::general, precision);
+            }
+            else
+            {
+                (void)precision;
+                r = std::to_chars(buffer + used, buffer + sizeof(buffer), value);
+            }
+
+            if(r.ec != std::errc())
+            {
+                return false;
+            }
+            used = r.ptr - buffer;
+            return true;
+        }
+
+        std::ostream &os;
+        size_t used;
+        char buffer[16 * 1024];
+};
+
+}
+
+// Prints [first, last) with options. Arithmetic elements on a plain stream are formatted
+// with std::to_chars into a 16 KiB buffer and written a chunk at a time, the output is the
+// same as printing every element with operator<<.
+template <typename It>
+std::ostream& format_range(std::ostream &os, It first, It last, const format_options &options = format_options())
+{
+    using T = std::decay_t<decltype(*first)>;
+
+    size_t n = 0;
+    if constexpr (detail::to_chars_formattable_v<T>)
+    {
+        if(detail::plain_stream(os))
+        {
+            const int precision = static_cast<int>(os.precision());
+            detail::format_buffer buffer(os);
+
+            for(; first != last && n != options.max_elements; ++first, ++n)
+            {
+                buffer.append_number(*first, precision);
+                buffer.append(options.separator);
+            }
+            if(first != last)
+            {
+                buffer.append("...");
+            }
+            return os;
+        }
+    }
+
+    for(; first != last && n != options.max_elements; ++first, ++n)
+    {
+        os << *first << options.separator;
+    }
+    if(first != last)
+    {
+        os << "...";
+    }
+    return os;
+}
+
+template <typename Container>
+struct formatted_range
+{
+    const Container &container;
+    format_options options;
+
+    friend std::ostream& operator<<(std::ostream &os, const formatted_range &f)
+    {
+        return format_range(os, f.container.cbegin(), f.container.cend(), f.options);
+    }
+};
+
+// os << adstl::formatted(v, {", ", 100}) prints at most 100 elements separated by ", "
+template <typename Container>
+formatted_range<Container> formatted(const Container &container, format_options options = format_options())
+{
+    return formatted_range<Container>{container, options};
+}
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+    GROWTH POLICIES
+*/
+
+#ifndef GROWTH_H
+#define GROWTH_H
+
+#include <cstddef>
+
+namespace adstl
+{
+
+// A growth policy tells a contiguous container how big its next buffer should be.
+//
+//     static size_t grow(size_t capacity, size_t element_size, size_t max_size);
+//
+// returns the capacity after the current one, never more than max_size and never less
+// than capacity + 1 unless max_size is reached. Policies are plain types, so the
+// container's push path is specialized and inlined at compile time.
+
+// capacity * Num / Den, e.g. geometric_growth<3, 2> grows by 1.5x
+template <size_t Num = 2, size_t Den = 1>
+struct geometric_growth
+{
+    static_assert(Den > 0 && Num > Den, "geometric_growth: factor has to be greater than 1");
+
+    static constexpr size_t grow(size_t capacity, size_t, size_t max_size)
+    {
+        if (capacity >= max_size)
+            return max_size;
+
+        // capacity + capacity * (Num - Den) / Den, split so it can not overflow
+        size_t whole = capacity / Den;
+        size_t rest = capacity % Den;
+
+        if (whole > (max_size - capacity) / (Num - Den))
+            return max_size;
+
+        size_t extra = whole * (Num - Den) + rest * (Num - Den) / Den;
+        if (extra == 0)
+            extra = 1;
+
+        return extra > max_size - capacity ? max_size : capacity + extra;
+    }
+};
+
+// adds a fixed amount of memory on every growth, Pages * 4 KiB worth of elements
+template <size_t Pages = 16>
+struct chunked_growth
+{
+    static_assert(Pages > 0, "chunked_growth: chunk has to hold at least one page");
+
+    static constexpr size_t page_size = 4096;
+
+    static constexpr size_t grow(size_t capacity, size_t element_size, size_t max_size)
+    {
+        if (capacity >= max_size)
+            return max_size;
+
+        size_t extra = Pages * page_size / element_size;
+        if (extra == 0)
+            extra = 1;
+
+        return extra > max_size - capacity ? max_size : capacity + extra;
+    }
+};
+
+// Big buffers come straight from mmap in most malloc implementations, so rounding their
+// byte size up to whole pages costs nothing and gives the container the slack for free.
+inline constexpr size_t allocation_rounding_threshold = 128 * 1024;
+inline constexpr size_t allocation_page_size = 4096;
+
+constexpr size_t round_capacity(size_t capacity, size_t element_size, size_t max_size)
+{
+    if (capacity > max_size / element_size)
+        return capacity;
+
+    size_t bytes = capacity * element_size;
+    if (bytes < allocation_rounding_threshold)
+        return capacity;
+
+    size_t rounded = (bytes + allocation_page_size - 1) / allocation_page_size * allocation_page_size;
+    size_t rounded_capacity = rounded / element_size;
+
+    return rounded_capacity > max_size ? max_size : rounded_capacity;
+}
+
+}
+
+#endif
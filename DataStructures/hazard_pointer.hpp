@@ -0,0 +1,268 @@
+/*
+    HAZARD POINTERS
+*/
+
+#ifndef HAZARD_POINTER_H
+#define HAZARD_POINTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace adstl
+{
+
+// Safe memory reclamation for lock-free containers.
+//
+// A thread that is about to dereference a shared node publishes it through a
+// hazard_pointers::guard first, a thread that unlinked a node hands it to retire() instead
+// of deleting it. Retired nodes are freed in batches once no guard points at them, so a
+// node can not be freed (and its address reused, the ABA problem) under a reader.
+//
+// There is one process wide domain. Hazard records are never freed, a thread that exits
+// gives its record back for the next thread and leaves its still protected nodes behind
+// for whichever thread scans next.
+class hazard_pointers final
+{
+    struct alignas(64) record
+    {
+        std::atomic<const void*> hazard{nullptr};
+        std::atomic<bool> active{true};
+        record *next = nullptr;
+    };
+
+    struct retired_node
+    {
+        void *p;
+        void (*deleter)(void*);
+    };
+
+    struct domain
+    {
+        ~domain();
+
+        record* acquire();
+        void scan(std::vector<retired_node>&);
+        void orphan(std::vector<retired_node>&);
+
+        std::atomic<record*> records{nullptr};
+        std::atomic<size_t> record_count{0};
+
+        std::mutex orphans_mutex;
+        std::vector<retired_node> orphans;
+        std::atomic<bool> has_orphans{false};
+    };
+
+    // per thread cache of one record and the list of nodes retired by this thread
+    struct thread_state
+    {
+        thread_state() : owner(global()), cached(nullptr), retired() {}
+        ~thread_state();
+
+        domain &owner;
+        record *cached;
+        std::vector<retired_node> retired;
+    };
+
+    static domain& global()
+    {
+        static domain d;
+        return d;
+    }
+
+    static thread_state& local()
+    {
+        static thread_local thread_state state;
+        return state;
+    }
+
+    public:
+
+        // protects one node at a time, not copyable and not shared between threads
+        class guard final
+        {
+            public:
+
+                guard();
+                guard(const guard&) = delete;
+                guard& operator=(const guard&) = delete;
+                ~guard();
+
+                // loads src and keeps the loaded node alive until the next protect() or reset()
+                template <typename N> N* protect(const std::atomic<N*>&);
+                void reset() { rec->hazard.store(nullptr, std::memory_order_release); }
+
+            private:
+                record *rec;
+        };
+
+        // frees p with deleter once no guard protects it, p has to be unreachable for new readers
+        static void retire(void *p, void (*deleter)(void*));
+
+        template <typename N>
+        static void retire(N *p)
+        {
+            retire(static_cast<void*>(p), [](void *q) { delete static_cast<N*>(q); });
+        }
+};
+
+inline hazard_pointers::domain::~domain()
+{
+    // only runs at exit, no thread is reading any more
+    for(retired_node &r : orphans)
+    {
+        r.deleter(r.p);
+    }
+
+    record *r = records.load(std::memory_order_acquire);
+    while(r)
+    {
+        record *next = r->next;
+        delete r;
+        r = next;
+    }
+}
+
+inline hazard_pointers::record* hazard_pointers::domain::acquire()
+{
+    for(record *r = records.load(std::memory_order_acquire); r; r = r->next)
+    {
+        bool expected = false;
+        if(!r->active.load(std::memory_order_relaxed) && r->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            return r;
+        }
+    }
+
+    record *r = new record;
+    record *head = records.load(std::memory_order_relaxed);
+    do
+    {
+        r->next = head;
+    } while(!records.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+    record_count.fetch_add(1, std::memory_order_relaxed);
+
+    return r;
+}
+
+inline void hazard_pointers::domain::scan(std::vector<retired_node> &retired)
+{
+    if(has_orphans.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(orphans_mutex);
+        retired.insert(retired.end(), orphans.begin(), orphans.end());
+        orphans.clear();
+        has_orphans.store(false, std::memory_order_relaxed);
+    }
+
+    // pairs with the seq_cst store in guard::protect, a reader either published its hazard
+    // before we look or sees the node already unlinked and retries
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::vector<const void*> protected_nodes;
+    for(record *r = records.load(std::memory_order_acquire); r; r = r->next)
+    {
+        if(const void *p = r->hazard.load(std::memory_order_acquire))
+        {
+            protected_nodes.push_back(p);
+        }
+    }
+    std::sort(protected_nodes.begin(), protected_nodes.end());
+
+    auto kept = std::partition(retired.begin(), retired.end(), [&](const retired_node &r) {
+        return std::binary_search(protected_nodes.begin(), protected_nodes.end(), static_cast<const void*>(r.p));
+    });
+    for(auto it = kept; it != retired.end(); ++it)
+    {
+        it->deleter(it->p);
+    }
+    retired.erase(kept, retired.end());
+}
+
+inline void hazard_pointers::domain::orphan(std::vector<retired_node> &retired)
+{
+    if(retired.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(orphans_mutex);
+    orphans.insert(orphans.end(), retired.begin(), retired.end());
+    has_orphans.store(true, std::memory_order_relaxed);
+    retired.clear();
+}
+
+inline hazard_pointers::thread_state::~thread_state()
+{
+    owner.scan(retired);
+    owner.orphan(retired);
+
+    if(cached)
+    {
+        cached->active.store(false, std::memory_order_release);
+    }
+}
+
+inline hazard_pointers::guard::guard()
+{
+    thread_state &state = local();
+    if(state.cached)
+    {
+        rec = state.cached;
+        state.cached = nullptr;
+    }
+    else
+    {
+        rec = state.owner.acquire();
+    }
+}
+
+inline hazard_pointers::guard::~guard()
+{
+    reset();
+
+    thread_state &state = local();
+    if(state.cached == nullptr)
+    {
+        state.cached = rec;
+    }
+    else
+    {
+        rec->active.store(false, std::memory_order_release);
+    }
+}
+
+template <typename N>
+N* hazard_pointers::guard::protect(const std::atomic<N*> &src)
+{
+    N *p = src.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        rec->hazard.store(p, std::memory_order_seq_cst);
+        N *current = src.load(std::memory_order_seq_cst);
+        if(current == p)
+        {
+            return p;
+        }
+        p = current;
+    }
+}
+
+inline void hazard_pointers::retire(void *p, void (*deleter)(void*))
+{
+    thread_state &state = local();
+    state.retired.push_back({p, deleter});
+
+    // amortized O(1): a scan frees all but at most record_count nodes
+    size_t threshold = 2 * state.owner.record_count.load(std::memory_order_relaxed) + 64;
+    if(state.retired.size() >= threshold)
+    {
+        state.owner.scan(state.retired);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,689 @@
+/*
+    INDEXED SKIP LIST
+*/
+
+#ifndef INDEXED_SKIPLIST_H
+#define INDEXED_SKIPLIST_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "config.hpp" // Include the configuration header
+#include "format.hpp"
+#include "expected.hpp"
+#include "instrumentation.hpp"
+
+namespace adstl
+{
+
+template <typename T, typename Allocator = std::allocator<T>> class indexed_skiplist;
+template <typename T, typename Allocator> std::ostream& operator<<(std::ostream&, const indexed_skiplist<T, Allocator>&);
+
+// Sequence with the interface of sllist where operator[], insert and erase at any position
+// are O(log n) expected. Every node sits on a random number of levels (a quarter of the
+// nodes reach level 2, a sixteenth level 3, ...), and every link stores how many positions
+// it skips, so a lookup by index descends from the sparse top level to the bottom one.
+template <typename T, typename Allocator>
+class indexed_skiplist final
+{
+
+    friend std::ostream& operator<< <T, Allocator> (std::ostream&, const indexed_skiplist<T, Allocator>&);
+
+    struct node;
+
+    struct link
+    {
+        node *next;
+        size_t width; // positions skipped by following next, meaningless while next is nullptr
+    };
+
+    // the links of a node are stored right behind it, in the same allocation
+    struct node
+    {
+        T* value() { return reinterpret_cast<T*>(storage); }
+        link* links() { return reinterpret_cast<link*>(this + 1); }
+
+        size_t level;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static_assert(alignof(link) <= alignof(node));
+
+    using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    static constexpr size_t max_level = 32; // enough for 4^32 elements
+
+    private:
+        class iterator;
+        class const_iterator;
+
+    public:
+
+        using l_type = T;
+        using allocator_type = Allocator;
+        using iterator = iterator;
+        using const_iterator = const_iterator;
+
+        indexed_skiplist() : indexed_skiplist(Allocator()) {} // def ctor
+        explicit indexed_skiplist(const Allocator &a) : alloc(a), tail(nullptr), sz(0), top(0), seed(0x9E3779B97F4A7C15ull) { reset_heads(); }
+        indexed_skiplist(const indexed_skiplist&); // cpy ctor
+        indexed_skiplist(indexed_skiplist&&) noexcept; // move ctor
+        ~indexed_skiplist(); // dctor
+
+        indexed_skiplist& operator=(const indexed_skiplist&); // cpy=
+        indexed_skiplist& operator=(indexed_skiplist&&)
+            noexcept(node_traits::propagate_on_container_move_assignment::value || node_traits::is_always_equal::value); // move=
+
+        allocator_type get_allocator() const { return allocator_type(alloc); }
+        void swap(indexed_skiplist&) noexcept;
+
+        T& operator[](size_t);
+        const T& operator[](size_t) const;
+        // no exceptions, errc::out_of_range past the end
+        expected<T&> try_at(size_t);
+        expected<const T&> try_at(size_t) const;
+
+        // undefined on an empty list
+        T& front() { return *heads[0].next->value(); }
+        const T& front() const { return *heads[0].next->value(); }
+        T& back() { return *tail->value(); }
+        const T& back() const { return *tail->value(); }
+
+        // iterator interface
+        iterator begin() { return iterator(heads[0].next); }
+        const_iterator cbegin() const { return const_iterator(heads[0].next); }
+
+        iterator end() { return iterator(nullptr); }
+        const_iterator cend() const { return const_iterator(nullptr); }
+
+        size_t size() const { return sz; }
+        bool empty() const { return sz == 0; }
+
+        template <typename U> void push_back(U&&);
+        template <typename ... Args> void emplace_back(Args&& ...);
+        template <typename U> void push_front(U&&);
+        template <typename ... Args> void emplace_front(Args&& ...);
+        void pop_back();
+        void clear();
+
+        // inserts before position, position == size() appends
+        template <typename U> void insert(size_t, U&&);
+        template <typename U> expected<void> try_insert(size_t, U&&); // errc::out_of_range when position > size()
+        void erase(size_t);
+        void reverse(); // O(n), the levels of the nodes are kept and the upper links rebuilt
+
+    private:
+
+        class iterator
+        {
+            friend class indexed_skiplist;
+
+            public:
+                iterator(node *it) : it(it) {}
+
+                T& operator*() const
+                {
+                    return *it->value();
+                }
+
+                iterator& operator++()
+                {
+                    it = it->links()[0].next;
+                    return *this;
+                }
+
+                bool operator!=(const iterator &rhs) const
+                {
+                    return it != rhs.it;
+                }
+
+            private:
+                node *it;
+        };
+
+        class const_iterator
+        {
+            friend class indexed_skiplist;
+
+            public:
+                const_iterator(node *it) : it(it) {}
+
+                const T& operator*() const
+                {
+                    return *it->value();
+                }
+
+                const_iterator& operator++()
+                {
+                    it = it->links()[0].next;
+                    return *this;
+                }
+
+                bool operator!=(const const_iterator &rhs) const
+                {
+                    return it != rhs.it;
+                }
+
+            private:
+                node *it;
+        };
+
+        // node slots holding a node and its links
+        static size_t slots(size_t level) { return 1 + (level * sizeof(link) + sizeof(node) - 1) / sizeof(node); }
+
+        link* links_of(node *n) { return n ? n->links() : heads; }
+        size_t random_level() noexcept;
+        void reset_heads() noexcept;
+        template <typename ... Args> node* create_node(Args&& ...);
+        void destroy_node(node*) noexcept;
+        void free_nodes() noexcept; // destroy all nodes, list is left in a dangling state
+        void steal(indexed_skiplist&) noexcept;
+        node* find_node(size_t) const;
+        void find_predecessors(size_t, node**, size_t*); // last node before position and its position on every level
+        template <typename ... Args> void emplace_at(size_t, Args&& ...);
+        void rebuild_levels() noexcept; // relink levels above 0 following the level 0 order
+
+        node_allocator alloc;
+        link heads[max_level];
+        node *tail;
+        size_t sz;
+        size_t top; // levels in use
+        uint64_t seed;
+};
+
+template <typename T, typename Allocator>
+std::ostream& operator<<(std::ostream &os, const indexed_skiplist<T, Allocator> &list)
+{
+    return format_range(os, list.cbegin(), list.cend());
+}
+
+template <typename T, typename Allocator>
+size_t indexed_skiplist<T, Allocator>::random_level() noexcept
+{
+    // xorshift64, every pair of zero bits adds a level
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+
+    size_t level = 1 + __builtin_ctzll(seed | (uint64_t(1) << 62)) / 2;
+    return level < max_level ? level : max_level;
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::reset_heads() noexcept
+{
+    for(link &head : heads)
+    {
+        head.next = nullptr;
+        head.width = 0;
+    }
+    tail = nullptr;
+    sz = 0;
+    top = 0;
+}
+
+template <typename T, typename Allocator>
+template <typename ... Args>
+typename indexed_skiplist<T, Allocator>::node* indexed_skiplist<T, Allocator>::create_node(Args&& ... args)
+{
+    size_t level = random_level();
+    node *n = node_traits::allocate(alloc, slots(level));
+    ADSTL_COUNT(indexed_skiplist, allocations, 1);
+    ADSTL_COUNT(indexed_skiplist, bytes_allocated, slots(level) * sizeof(node));
+    ADSTL_COUNT(indexed_skiplist, node_allocations, 1);
+    ADSTL_TRY
+    {
+        ::new (static_cast<void*>(n->storage)) T(std::forward<Args>(args) ...);
+    }
+    ADSTL_CATCH_ALL
+    {
+        node_traits::deallocate(alloc, n, slots(level));
+        ADSTL_RETHROW;
+    }
+    n->level = level;
+    return n;
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::destroy_node(node *n) noexcept
+{
+    n->value()->~T();
+    node_traits::deallocate(alloc, n, slots(n->level));
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::free_nodes() noexcept
+{
+    node *current_node = heads[0].next;
+    while(current_node)
+    {
+        node *next_node = current_node->links()[0].next;
+        destroy_node(current_node);
+        current_node = next_node;
+    }
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::steal(indexed_skiplist &rhs) noexcept
+{
+    for(size_t i = 0; i != max_level; ++i)
+    {
+        heads[i] = rhs.heads[i];
+    }
+    tail = rhs.tail;
+    sz = rhs.sz;
+    top = rhs.top;
+    seed = rhs.seed;
+
+    rhs.reset_heads();
+}
+
+// node at index < sz
+template <typename T, typename Allocator>
+typename indexed_skiplist<T, Allocator>::node* indexed_skiplist<T, Allocator>::find_node(size_t index) const
+{
+    if(index == sz - 1)
+    {
+        return tail;
+    }
+
+    // positions count from 1, the heads are position 0
+    size_t target = index + 1;
+    size_t position = 0;
+    const link *links = heads;
+    node *current_node = nullptr;
+
+    for(size_t level = top; level-- > 0;)
+    {
+        while(links[level].next && position + links[level].width <= target)
+        {
+            position += links[level].width;
+            current_node = links[level].next;
+            links = current_node->links();
+        }
+    }
+    return current_node;
+}
+
+// fills preds and ranks for the levels [0, top), a nullptr pred stands for the heads
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::find_predecessors(size_t index, node **preds, size_t *ranks)
+{
+    size_t target = index + 1;
+    size_t position = 0;
+    node *current_node = nullptr;
+    link *links = heads;
+
+    for(size_t level = top; level-- > 0;)
+    {
+        while(links[level].next && position + links[level].width < target)
+        {
+            position += links[level].width;
+            current_node = links[level].next;
+            links = current_node->links();
+        }
+        preds[level] = current_node;
+        ranks[level] = position;
+    }
+}
+
+template <typename T, typename Allocator>
+template <typename ... Args>
+void indexed_skiplist<T, Allocator>::emplace_at(size_t index, Args&& ... args)
+{
+    node *preds[max_level];
+    size_t ranks[max_level];
+    find_predecessors(index, preds, ranks);
+
+    node *new_node = create_node(std::forward<Args>(args) ...);
+    size_t position = index + 1;
+    link *new_links = new_node->links();
+
+    for(; top < new_node->level; ++top)
+    {
+        preds[top] = nullptr;
+        ranks[top] = 0;
+    }
+
+    for(size_t level = 0; level != top; ++level)
+    {
+        link &pred_link = links_of(preds[level])[level];
+        if(level < new_node->level)
+        {
+            // the link over position is split in two
+            new_links[level].next = pred_link.next;
+            new_links[level].width = ranks[level] + pred_link.width + 1 - position;
+            pred_link.next = new_node;
+            pred_link.width = position - ranks[level];
+        }
+        else
+        {
+            ++pred_link.width;
+        }
+    }
+
+    if(new_links[0].next == nullptr)
+    {
+        tail = new_node;
+    }
+    ++sz;
+}
+
+// cpy ctor
+template <typename T, typename Allocator>
+indexed_skiplist<T, Allocator>::indexed_skiplist(const indexed_skiplist &rhs)
+    : indexed_skiplist(Allocator(node_traits::select_on_container_copy_construction(rhs.alloc)))
+{
+    for(const_iterator b = rhs.cbegin(); b != rhs.cend(); ++b)
+    {
+        push_back(*b);
+    }
+}
+
+// move ctor
+template <typename T, typename Allocator>
+indexed_skiplist<T, Allocator>::indexed_skiplist(indexed_skiplist &&rhs) noexcept : alloc(std::move(rhs.alloc))
+{
+    steal(rhs);
+}
+
+template <typename T, typename Allocator>
+indexed_skiplist<T, Allocator>::~indexed_skiplist()
+{
+    free_nodes();
+}
+
+// cpy=
+template <typename T, typename Allocator>
+indexed_skiplist<T, Allocator>& indexed_skiplist<T, Allocator>::operator=(const indexed_skiplist &rhs)
+{
+    if(this != &rhs)
+    {
+        clear();
+
+        if constexpr (node_traits::propagate_on_container_copy_assignment::value)
+            alloc = rhs.alloc;
+
+        for(const_iterator b = rhs.cbegin(); b != rhs.cend(); ++b)
+        {
+            push_back(*b);
+        }
+    }
+
+    return *this;
+}
+
+// move=
+template <typename T, typename Allocator>
+indexed_skiplist<T, Allocator>& indexed_skiplist<T, Allocator>::operator=(indexed_skiplist &&rhs)
+    noexcept(node_traits::propagate_on_container_move_assignment::value || node_traits::is_always_equal::value)
+{
+    if(this != &rhs)
+    {
+        clear();
+
+        if constexpr (!node_traits::propagate_on_container_move_assignment::value && !node_traits::is_always_equal::value)
+        {
+            // rhs nodes belong to a different allocator, we can only move the elements one by one
+            if(alloc != rhs.alloc)
+            {
+                for(iterator b = rhs.begin(); b != rhs.end(); ++b)
+                {
+                    push_back(std::move(*b));
+                }
+                return *this;
+            }
+        }
+
+        if constexpr (node_traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+
+        steal(rhs);
+    }
+
+    return *this;
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::swap(indexed_skiplist &rhs) noexcept
+{
+    if constexpr (node_traits::propagate_on_container_swap::value)
+    {
+        using std::swap;
+        swap(alloc, rhs.alloc);
+    }
+
+    for(size_t i = 0; i != max_level; ++i)
+    {
+        std::swap(heads[i], rhs.heads[i]);
+    }
+    std::swap(tail, rhs.tail);
+    std::swap(sz, rhs.sz);
+    std::swap(top, rhs.top);
+    std::swap(seed, rhs.seed);
+}
+
+// op []
+template <typename T, typename Allocator>
+T& indexed_skiplist<T, Allocator>::operator[](size_t index)
+{
+    if(index >= sz) ADSTL_UNLIKELY
+    {
+        ADSTL_FAIL(std::out_of_range("Index:" + std::to_string(index) + " is out of range"));
+    }
+    return *find_node(index)->value();
+}
+
+// op []
+template <typename T, typename Allocator>
+const T& indexed_skiplist<T, Allocator>::operator[](size_t index) const
+{
+    if(index >= sz) ADSTL_UNLIKELY
+    {
+        ADSTL_FAIL(std::out_of_range("Index:" + std::to_string(index) + " is out of range"));
+    }
+    return *find_node(index)->value();
+}
+
+template <typename T, typename Allocator>
+template <typename U>
+void indexed_skiplist<T, Allocator>::push_back(U &&data)
+{
+    emplace_at(sz, std::forward<U>(data));
+}
+
+template <typename T, typename Allocator>
+template <typename ... Args>
+void indexed_skiplist<T, Allocator>::emplace_back(Args&& ... args)
+{
+    emplace_at(sz, std::forward<Args>(args) ...);
+}
+
+template <typename T, typename Allocator>
+template <typename U>
+void indexed_skiplist<T, Allocator>::push_front(U &&data)
+{
+    emplace_at(0, std::forward<U>(data));
+}
+
+template <typename T, typename Allocator>
+template <typename ... Args>
+void indexed_skiplist<T, Allocator>::emplace_front(Args&& ... args)
+{
+    emplace_at(0, std::forward<Args>(args) ...);
+}
+
+template <typename T, typename Allocator>
+template <typename U>
+void indexed_skiplist<T, Allocator>::insert(size_t position, U &&data)
+{
+    if(position > sz)
+    {
+        #ifdef ADSTL_THROWABLE
+        throw std::out_of_range("Inserting on positon:" + std::to_string(position) + " while list have:" + std::to_string(sz) + " elements.");
+        #endif
+        return;
+    }
+
+    emplace_at(position, std::forward<U>(data));
+}
+
+template <typename T, typename Allocator>
+expected<T&> indexed_skiplist<T, Allocator>::try_at(size_t index)
+{
+    if(index < sz) ADSTL_LIKELY
+    {
+        return (*this)[index];
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator>
+expected<const T&> indexed_skiplist<T, Allocator>::try_at(size_t index) const
+{
+    if(index < sz) ADSTL_LIKELY
+    {
+        return (*this)[index];
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator>
+template <typename U>
+expected<void> indexed_skiplist<T, Allocator>::try_insert(size_t position, U &&data)
+{
+    if(position <= sz) ADSTL_LIKELY
+    {
+        insert(position, std::forward<U>(data));
+        return {};
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::erase(size_t position)
+{
+    if(position >= sz)
+    {
+        #ifdef ADSTL_THROWABLE
+        throw std::out_of_range("Index:" + std::to_string(position) + " is out of range");
+        #endif
+        return;
+    }
+
+    node *preds[max_level];
+    size_t ranks[max_level];
+    find_predecessors(position, preds, ranks);
+
+    node *erased = links_of(preds[0])[0].next;
+    link *erased_links = erased->links();
+
+    for(size_t level = 0; level != top; ++level)
+    {
+        link &pred_link = links_of(preds[level])[level];
+        if(level < erased->level)
+        {
+            pred_link.next = erased_links[level].next;
+            pred_link.width += erased_links[level].width - 1;
+        }
+        else
+        {
+            --pred_link.width;
+        }
+    }
+
+    while(top && heads[top - 1].next == nullptr)
+    {
+        --top;
+    }
+
+    if(erased == tail)
+    {
+        tail = preds[0];
+    }
+    --sz;
+
+    destroy_node(erased);
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::pop_back()
+{
+    if(sz == 0)
+    {
+        return;
+    }
+    erase(sz - 1);
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::clear()
+{
+    free_nodes();
+    reset_heads();
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::rebuild_levels() noexcept
+{
+    // last[level] is the node whose link on level is still open, at position rank[level]
+    link *last[max_level];
+    size_t rank[max_level];
+    for(size_t level = 1; level < top; ++level)
+    {
+        last[level] = heads;
+        rank[level] = 0;
+    }
+
+    size_t position = 0;
+    for(node *current_node = heads[0].next; current_node; current_node = current_node->links()[0].next)
+    {
+        ++position;
+        link *links = current_node->links();
+        for(size_t level = 1; level < current_node->level; ++level)
+        {
+            last[level][level].next = current_node;
+            last[level][level].width = position - rank[level];
+            last[level] = links;
+            rank[level] = position;
+        }
+    }
+
+    for(size_t level = 1; level < top; ++level)
+    {
+        last[level][level].next = nullptr;
+    }
+}
+
+template <typename T, typename Allocator>
+void indexed_skiplist<T, Allocator>::reverse()
+{
+    node *prev_node = nullptr;
+    node *current_node = heads[0].next;
+
+    tail = current_node;
+
+    while(current_node != nullptr)
+    {
+        link &next_link = current_node->links()[0];
+        node *next_node = next_link.next;
+        next_link.next = prev_node;
+        next_link.width = 1;
+        prev_node = current_node;
+        current_node = next_node;
+    }
+
+    heads[0].next = prev_node;
+    heads[0].width = 1;
+
+    rebuild_levels();
+}
+
+}
+
+#endif
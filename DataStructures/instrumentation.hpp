@@ -0,0 +1,264 @@
+/*
+    INSTRUMENTATION
+*/
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "config.hpp" // Include the configuration header
+
+// Containers report what they do through ADSTL_COUNT(container, counter, n),
+// ADSTL_PEAK(container, capacity) and ADSTL_COUNT_ALLOCATION(container, capacity, bytes).
+// Without ADSTL_INSTRUMENTATION they expand to nothing and none of the machinery below is
+// compiled.
+//
+// With it every thread counts into its own counters, adstl::instrumentation::collect()
+// adds up the counters of all running threads and of the threads that already exited:
+//
+//     auto s = adstl::instrumentation::collect();
+//     s[adstl::instrumentation::container::vector].reallocations;
+//     adstl::instrumentation::for_each_counter(s, [](const char *container, const char *counter, uint64_t value) { ... });
+
+#ifdef ADSTL_INSTRUMENTATION
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace adstl
+{
+
+namespace instrumentation
+{
+
+enum class container
+{
+    vector,
+    sllist,
+    segmented_vector,
+    unrolled_list,
+    indexed_skiplist,
+    flat_hash_map,    // flat_hash_map and flat_hash_set
+    btree_map,        // btree_map and btree_set
+    count_
+};
+
+enum class counter
+{
+    allocations,      // calls to the allocator
+    bytes_allocated,
+    reallocations,    // a buffer replaced by a bigger or smaller one
+    elements_moved,   // moved or relocated to another place by reallocation or insertion
+    elements_copied,  // copied instead of moved because the move constructor may throw
+    node_allocations, // nodes handed out to hold an element
+    peak_capacity,    // the biggest capacity() reached by one container, for the ones that have capacity()
+    count_
+};
+
+inline constexpr size_t container_count = static_cast<size_t>(container::count_);
+inline constexpr size_t counter_count = static_cast<size_t>(counter::count_);
+
+inline const char* name(container c)
+{
+    static const char *const names[container_count] = {"vector", "sllist", "segmented_vector", "unrolled_list", "indexed_skiplist", "flat_hash_map", "btree_map"};
+    return names[static_cast<size_t>(c)];
+}
+
+inline const char* name(counter c)
+{
+    static const char *const names[counter_count] = {"allocations", "bytes_allocated", "reallocations", "elements_moved",
+                                                     "elements_copied", "node_allocations", "peak_capacity"};
+    return names[static_cast<size_t>(c)];
+}
+
+struct counters
+{
+    uint64_t allocations = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t reallocations = 0;
+    uint64_t elements_moved = 0;
+    uint64_t elements_copied = 0;
+    uint64_t node_allocations = 0;
+    uint64_t peak_capacity = 0;
+
+    uint64_t& operator[](counter c)
+    {
+        uint64_t *fields[counter_count] = {&allocations, &bytes_allocated, &reallocations, &elements_moved,
+                                           &elements_copied, &node_allocations, &peak_capacity};
+        return *fields[static_cast<size_t>(c)];
+    }
+
+    uint64_t operator[](counter c) const { return const_cast<counters&>(*this)[c]; }
+};
+
+struct snapshot
+{
+    counters containers[container_count];
+
+    counters& operator[](container c) { return containers[static_cast<size_t>(c)]; }
+    const counters& operator[](container c) const { return containers[static_cast<size_t>(c)]; }
+};
+
+namespace detail
+{
+
+inline bool is_peak(size_t c) { return c == static_cast<size_t>(counter::peak_capacity); }
+
+// written only by the owning thread, atomics so collect() can read them at any time
+struct thread_counters
+{
+    std::atomic<uint64_t> values[container_count][counter_count] = {};
+};
+
+class registry
+{
+    public:
+
+        void attach(thread_counters *local)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            live.push_back(local);
+        }
+
+        // the counters of an exiting thread are folded into the retired totals
+        void detach(thread_counters *local)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fold(*local, retired);
+            for(size_t i = 0; i != live.size(); ++i)
+            {
+                if(live[i] == local)
+                {
+                    live[i] = live.back();
+                    live.pop_back();
+                    break;
+                }
+            }
+        }
+
+        snapshot collect()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            snapshot total = retired;
+            for(thread_counters *local : live)
+            {
+                fold(*local, total);
+            }
+            return total;
+        }
+
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            retired = snapshot();
+            for(thread_counters *local : live)
+            {
+                for(auto &row : local->values)
+                {
+                    for(auto &value : row)
+                    {
+                        value.store(0, std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+
+    private:
+
+        static void fold(const thread_counters &local, snapshot &total)
+        {
+            for(size_t c = 0; c != container_count; ++c)
+            {
+                for(size_t k = 0; k != counter_count; ++k)
+                {
+                    uint64_t value = local.values[c][k].load(std::memory_order_relaxed);
+                    uint64_t &sum = total.containers[c][static_cast<counter>(k)];
+                    sum = is_peak(k) ? (value > sum ? value : sum) : sum + value;
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<thread_counters*> live;
+        snapshot retired;
+};
+
+inline registry& global_registry()
+{
+    static registry r;
+    return r;
+}
+
+struct thread_slot
+{
+    thread_slot() { global_registry().attach(&counters); }
+    ~thread_slot() { global_registry().detach(&counters); }
+
+    thread_counters counters;
+};
+
+inline thread_counters& local_counters()
+{
+    thread_local thread_slot slot;
+    return slot.counters;
+}
+
+inline void add(container c, counter k, uint64_t n)
+{
+    std::atomic<uint64_t> &value = local_counters().values[static_cast<size_t>(c)][static_cast<size_t>(k)];
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void peak(container c, uint64_t n)
+{
+    std::atomic<uint64_t> &value = local_counters().values[static_cast<size_t>(c)][static_cast<size_t>(counter::peak_capacity)];
+    if(n > value.load(std::memory_order_relaxed))
+    {
+        value.store(n, std::memory_order_relaxed);
+    }
+}
+
+}
+
+// sums of all threads, peak_capacity is the maximum over all threads
+inline snapshot collect() { return detail::global_registry().collect(); }
+
+// zeroes the counters of every thread, counts racing with the reset may survive it
+inline void reset() { detail::global_registry().reset(); }
+
+// calls f(container name, counter name, value) for every counter, for exporting
+template <typename F>
+void for_each_counter(const snapshot &s, F &&f)
+{
+    for(size_t c = 0; c != container_count; ++c)
+    {
+        for(size_t k = 0; k != counter_count; ++k)
+        {
+            f(name(static_cast<container>(c)), name(static_cast<counter>(k)), s.containers[c][static_cast<counter>(k)]);
+        }
+    }
+}
+
+}
+
+}
+
+#define ADSTL_COUNT(c, k, n) \
+    ::adstl::instrumentation::detail::add(::adstl::instrumentation::container::c, ::adstl::instrumentation::counter::k, static_cast<uint64_t>(n))
+#define ADSTL_PEAK(c, n) \
+    ::adstl::instrumentation::detail::peak(::adstl::instrumentation::container::c, static_cast<uint64_t>(n))
+// one allocator call of the given size that leaves the container able to hold capacity elements
+#define ADSTL_COUNT_ALLOCATION(c, capacity, bytes) \
+    (ADSTL_COUNT(c, allocations, 1), ADSTL_COUNT(c, bytes_allocated, bytes), ADSTL_PEAK(c, capacity))
+
+#else
+
+#define ADSTL_COUNT(c, k, n) ((void)0)
+#define ADSTL_PEAK(c, n) ((void)0)
+#define ADSTL_COUNT_ALLOCATION(c, capacity, bytes) ((void)0)
+
+#endif
+
+#endif
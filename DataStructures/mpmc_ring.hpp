@@ -0,0 +1,548 @@
+/*
+    MPMC RING
+*/
+
+#ifndef MPMC_RING_H
+#define MPMC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+#include "expected.hpp"
+
+namespace adstl
+{
+
+// Bounded lock-free queue for many producer and consumer threads (Vyukov's ring).
+//
+// Every slot carries a sequence number that tells which ticket may use it next, a producer
+// claims ticket pos with one CAS on the enqueue position when the slot of pos has sequence
+// pos, fills it and publishes pos + 1, a consumer takes it when it reads pos + 1 and hands
+// the slot to the producer of pos + capacity. Producers and consumers only meet on the
+// slot they share, the two positions live on their own cache lines.
+//
+// try_push_n and try_pop_n claim a run of ready slots with a single CAS. A claimed slot can
+// not be given back, so when building an element or assigning it to the output may throw
+// they claim one slot at a time instead.
+//
+// The capacity is rounded up to a power of two (at least 2) and all slots are allocated in
+// one adstl::vector when the ring is built, push and pop never allocate. The allocator only
+// runs in the constructor and the destructor, so the arena and pool allocators work too.
+//
+// spsc_ring is the same queue for exactly one producer and one consumer thread, it needs
+// no CAS and no sequence numbers.
+enum class ring_access
+{
+    multi,  // any number of producers and consumers
+    single  // one producer thread and one consumer thread
+};
+
+template <typename T, typename Allocator = std::allocator<T>, ring_access Access = ring_access::multi>
+class mpmc_ring;
+
+template <typename T, typename Allocator = std::allocator<T>>
+using spsc_ring = mpmc_ring<T, Allocator, ring_access::single>;
+
+namespace detail
+{
+
+inline size_t ring_capacity(size_t n)
+{
+    size_t cap = 2;
+    while(cap < n)
+    {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+// one cache line per position, producers and consumers do not invalidate each other
+struct alignas(64) ring_position
+{
+    std::atomic<size_t> value{0};
+};
+
+}
+
+template <typename T, typename Allocator, ring_access Access>
+class mpmc_ring final
+{
+    // a claimed ticket can not be given back, so nothing may throw once a slot is claimed
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>,
+                  "mpmc_ring: T has to be nothrow move constructible and destructible");
+
+    public:
+
+        using value_type = T;
+        using allocator_type = Allocator;
+
+        explicit mpmc_ring(size_t capacity, const Allocator &a = Allocator());
+        mpmc_ring(const mpmc_ring&) = delete;
+        mpmc_ring& operator=(const mpmc_ring&) = delete;
+        ~mpmc_ring();
+
+        // false when the ring is full
+        template <typename U> bool try_push(U &&element) { return try_emplace(std::forward<U>(element)); }
+        template <typename... Args> bool try_emplace(Args&&...);
+        // false when the ring is empty
+        bool try_pop(T&);
+
+        // push up to n elements from first, pop up to n elements to out, return how many
+        template <typename It> size_t try_push_n(It, size_t);
+        template <typename OutIt> size_t try_pop_n(OutIt, size_t);
+
+        size_t capacity() const { return mask + 1; }
+        size_t size() const; // only a snapshot under concurrency
+        bool empty() const { return size() == 0; }
+
+    private:
+
+        struct slot
+        {
+            slot() : sequence(0) {}
+            // adstl::vector needs it to compile, the ring never copies or relocates its slots
+            slot(const slot &rhs) : sequence(rhs.sequence.load(std::memory_order_relaxed)) {}
+
+            T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+
+            std::atomic<size_t> sequence;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+
+        // a consumer releases the slot of ticket pos even if moving the value out throws
+        struct release_on_exit
+        {
+            ~release_on_exit()
+            {
+                s->value()->~T();
+                s->sequence.store(next, std::memory_order_release);
+            }
+            slot *s;
+            size_t next;
+        };
+
+        slot& at(size_t pos) { return slots[pos & mask]; }
+
+        // claims up to n published slots with one CAS and moves their elements to out
+        template <typename OutIt> size_t pop_run(OutIt&, size_t);
+
+        vector<slot, slot_allocator> slots;
+        size_t mask;
+        detail::ring_position enqueue_pos;
+        detail::ring_position dequeue_pos;
+};
+
+template <typename T, typename Allocator, ring_access Access>
+mpmc_ring<T, Allocator, Access>::mpmc_ring(size_t capacity, const Allocator &a)
+    : slots(slot_allocator(a)), mask(detail::ring_capacity(capacity) - 1)
+{
+    slots.reserve(mask + 1);
+    slots.resize(mask + 1);
+    for(size_t i = 0; i != slots.size(); ++i)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, typename Allocator, ring_access Access>
+mpmc_ring<T, Allocator, Access>::~mpmc_ring()
+{
+    // nobody else can touch the ring any more, destroy what is still queued
+    size_t last = enqueue_pos.value.load(std::memory_order_acquire);
+    for(size_t pos = dequeue_pos.value.load(std::memory_order_acquire); pos != last; ++pos)
+    {
+        at(pos).value()->~T();
+    }
+}
+
+template <typename T, typename Allocator, ring_access Access>
+template <typename... Args>
+bool mpmc_ring<T, Allocator, Access>::try_emplace(Args&&... args)
+{
+    if constexpr (!std::is_nothrow_constructible_v<T, Args&&...>)
+    {
+        // build it before a ticket is claimed, then it only has to be moved in
+        return try_emplace(T(std::forward<Args>(args)...));
+    }
+    else
+    {
+        size_t pos = enqueue_pos.value.load(std::memory_order_relaxed);
+        slot *s;
+        for(;;)
+        {
+            s = &at(pos);
+            size_t seq = s->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+            if(diff == 0)
+            {
+                if(enqueue_pos.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if(diff < 0)
+            {
+                return false; // the slot still holds the element from one lap ago
+            }
+            else
+            {
+                pos = enqueue_pos.value.load(std::memory_order_relaxed);
+            }
+        }
+
+        ::new (static_cast<void*>(s->storage)) T(std::forward<Args>(args)...);
+        s->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+}
+
+template <typename T, typename Allocator, ring_access Access>
+bool mpmc_ring<T, Allocator, Access>::try_pop(T &out)
+{
+    size_t pos = dequeue_pos.value.load(std::memory_order_relaxed);
+    slot *s;
+    for(;;)
+    {
+        s = &at(pos);
+        size_t seq = s->sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+
+        if(diff == 0)
+        {
+            if(dequeue_pos.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            return false; // not published yet
+        }
+        else
+        {
+            pos = dequeue_pos.value.load(std::memory_order_relaxed);
+        }
+    }
+
+    release_on_exit release{s, pos + mask + 1};
+    out = std::move(*s->value());
+    return true;
+}
+
+template <typename T, typename Allocator, ring_access Access>
+template <typename It>
+size_t mpmc_ring<T, Allocator, Access>::try_push_n(It first, size_t n)
+{
+    if constexpr (!std::is_nothrow_constructible_v<T, decltype(*first)>)
+    {
+        // every element is built before its ticket is claimed
+        size_t pushed = 0;
+        for(; pushed != n && try_emplace(*first); ++pushed, ++first) {}
+        return pushed;
+    }
+    else
+    {
+        size_t pos = enqueue_pos.value.load(std::memory_order_relaxed);
+        size_t k;
+        for(;;)
+        {
+            // the run of slots that are free for the tickets pos, pos + 1, ...
+            k = 0;
+            while(k != n && k <= mask && at(pos + k).sequence.load(std::memory_order_acquire) == pos + k)
+            {
+                ++k;
+            }
+
+            if(k == 0)
+            {
+                size_t seq = at(pos).sequence.load(std::memory_order_acquire);
+                if(n == 0 || static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos) < 0)
+                {
+                    return 0;
+                }
+                pos = enqueue_pos.value.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            // no one else can own the tickets below pos + k while enqueue_pos is still pos
+            if(enqueue_pos.value.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        for(size_t i = 0; i != k; ++i, ++first)
+        {
+            slot &s = at(pos + i);
+            ::new (static_cast<void*>(s.storage)) T(*first);
+            s.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return k;
+    }
+}
+
+template <typename T, typename Allocator, ring_access Access>
+template <typename OutIt>
+size_t mpmc_ring<T, Allocator, Access>::try_pop_n(OutIt out, size_t n)
+{
+    if constexpr (!(noexcept(*std::declval<OutIt&>() = std::declval<T&&>()) && noexcept(++std::declval<OutIt&>())))
+    {
+        // the slots of a run are all claimed at once and can not be given back, if handing
+        // an element out may throw they are claimed one at a time
+        size_t popped = 0;
+        for(; popped != n && pop_run(out, 1) == 1; ++popped) {}
+        return popped;
+    }
+    else
+    {
+        return pop_run(out, n);
+    }
+}
+
+template <typename T, typename Allocator, ring_access Access>
+template <typename OutIt>
+size_t mpmc_ring<T, Allocator, Access>::pop_run(OutIt &out, size_t n)
+{
+    size_t pos = dequeue_pos.value.load(std::memory_order_relaxed);
+    size_t k;
+    for(;;)
+    {
+        // the run of published slots for the tickets pos, pos + 1, ...
+        k = 0;
+        while(k != n && k <= mask && at(pos + k).sequence.load(std::memory_order_acquire) == pos + k + 1)
+        {
+            ++k;
+        }
+
+        if(k == 0)
+        {
+            size_t seq = at(pos).sequence.load(std::memory_order_acquire);
+            if(n == 0 || static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1) < 0)
+            {
+                return 0;
+            }
+            pos = dequeue_pos.value.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if(dequeue_pos.value.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    for(size_t i = 0; i != k; ++i)
+    {
+        slot &s = at(pos + i);
+        release_on_exit release{&s, pos + i + mask + 1};
+        *out = std::move(*s.value());
+        ++out;
+    }
+    return k;
+}
+
+template <typename T, typename Allocator, ring_access Access>
+size_t mpmc_ring<T, Allocator, Access>::size() const
+{
+    size_t tail = dequeue_pos.value.load(std::memory_order_acquire);
+    size_t head = enqueue_pos.value.load(std::memory_order_acquire);
+    return head > tail ? head - tail : 0;
+}
+
+// one producer and one consumer, each side owns its position and keeps a cached copy of
+// the other one, so the shared line is only read when the ring looks full or empty
+template <typename T, typename Allocator>
+class mpmc_ring<T, Allocator, ring_access::single> final
+{
+    static_assert(std::is_nothrow_destructible_v<T>, "spsc_ring: T has to be nothrow destructible");
+
+    public:
+
+        using value_type = T;
+        using allocator_type = Allocator;
+
+        explicit mpmc_ring(size_t capacity, const Allocator &a = Allocator());
+        mpmc_ring(const mpmc_ring&) = delete;
+        mpmc_ring& operator=(const mpmc_ring&) = delete;
+        ~mpmc_ring();
+
+        // producer side
+        template <typename U> bool try_push(U &&element) { return try_emplace(std::forward<U>(element)); }
+        template <typename... Args> bool try_emplace(Args&&...);
+        template <typename It> size_t try_push_n(It, size_t);
+
+        // consumer side
+        bool try_pop(T &out) { return try_pop_n(&out, 1) == 1; }
+        template <typename OutIt> size_t try_pop_n(OutIt, size_t);
+
+        size_t capacity() const { return mask + 1; }
+        size_t size() const; // only a snapshot under concurrency
+        bool empty() const { return size() == 0; }
+
+    private:
+
+        struct cell
+        {
+            T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        using cell_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<cell>;
+
+        struct alignas(64) producer_side
+        {
+            std::atomic<size_t> tail{0};
+            size_t head_cache = 0;
+        };
+
+        struct alignas(64) consumer_side
+        {
+            std::atomic<size_t> head{0};
+            size_t tail_cache = 0;
+        };
+
+        // room for up to n more elements, refreshes the cached head only when needed
+        size_t free_slots(size_t tail, size_t n);
+
+        cell& at(size_t pos) { return cells[pos & mask]; }
+
+        vector<cell, cell_allocator> cells;
+        size_t mask;
+        producer_side producer;
+        consumer_side consumer;
+};
+
+template <typename T, typename Allocator>
+mpmc_ring<T, Allocator, ring_access::single>::mpmc_ring(size_t capacity, const Allocator &a)
+    : cells(cell_allocator(a)), mask(detail::ring_capacity(capacity) - 1)
+{
+    cells.reserve(mask + 1);
+    cells.resize(mask + 1);
+}
+
+template <typename T, typename Allocator>
+mpmc_ring<T, Allocator, ring_access::single>::~mpmc_ring()
+{
+    size_t tail = producer.tail.load(std::memory_order_acquire);
+    for(size_t pos = consumer.head.load(std::memory_order_acquire); pos != tail; ++pos)
+    {
+        at(pos).value()->~T();
+    }
+}
+
+template <typename T, typename Allocator>
+size_t mpmc_ring<T, Allocator, ring_access::single>::free_slots(size_t tail, size_t n)
+{
+    size_t room = capacity() - (tail - producer.head_cache);
+    if(room < n)
+    {
+        producer.head_cache = consumer.head.load(std::memory_order_acquire);
+        room = capacity() - (tail - producer.head_cache);
+    }
+    return room < n ? room : n;
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+bool mpmc_ring<T, Allocator, ring_access::single>::try_emplace(Args&&... args)
+{
+    size_t tail = producer.tail.load(std::memory_order_relaxed);
+    if(free_slots(tail, 1) == 0)
+    {
+        return false;
+    }
+
+    // nothing is published before the element is built, a throwing constructor leaves no trace
+    ::new (static_cast<void*>(at(tail).storage)) T(std::forward<Args>(args)...);
+    producer.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, typename Allocator>
+template <typename It>
+size_t mpmc_ring<T, Allocator, ring_access::single>::try_push_n(It first, size_t n)
+{
+    size_t tail = producer.tail.load(std::memory_order_relaxed);
+    size_t k = free_slots(tail, n);
+
+    size_t i = 0;
+    ADSTL_TRY
+    {
+        for(; i != k; ++i, ++first)
+        {
+            ::new (static_cast<void*>(at(tail + i).storage)) T(*first);
+        }
+    }
+    ADSTL_CATCH_ALL
+    {
+        // publish what was built
+        producer.tail.store(tail + i, std::memory_order_release);
+        ADSTL_RETHROW;
+    }
+
+    producer.tail.store(tail + k, std::memory_order_release);
+    return k;
+}
+
+template <typename T, typename Allocator>
+template <typename OutIt>
+size_t mpmc_ring<T, Allocator, ring_access::single>::try_pop_n(OutIt out, size_t n)
+{
+    size_t head = consumer.head.load(std::memory_order_relaxed);
+    size_t ready = consumer.tail_cache - head;
+    if(ready < n)
+    {
+        consumer.tail_cache = producer.tail.load(std::memory_order_acquire);
+        ready = consumer.tail_cache - head;
+    }
+    size_t k = ready < n ? ready : n;
+
+    // one store hands all k cells back, also when moving an element out throws
+    struct release_on_exit
+    {
+        ~release_on_exit() { ring->consumer.head.store(head + done, std::memory_order_release); }
+        mpmc_ring *ring;
+        size_t head;
+        size_t done;
+    } release{this, head, 0};
+
+    struct destroy_on_exit
+    {
+        ~destroy_on_exit()
+        {
+            value->~T();
+            ++*done;
+        }
+        T *value;
+        size_t *done;
+    };
+
+    while(release.done != k)
+    {
+        destroy_on_exit element{at(head + release.done).value(), &release.done};
+        *out = std::move(*element.value);
+        ++out;
+    }
+    return k;
+}
+
+template <typename T, typename Allocator>
+size_t mpmc_ring<T, Allocator, ring_access::single>::size() const
+{
+    size_t head = consumer.head.load(std::memory_order_acquire);
+    size_t tail = producer.tail.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,639 @@
+/*
+    PRIORITY QUEUE
+*/
+
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+#include "expected.hpp"
+#include "config.hpp" // Include the configuration header
+
+namespace adstl
+{
+
+// Heaps stored in an array, the element with the highest priority on top: with the default
+// std::less that is the greatest element, std::greater<> makes a min queue.
+//
+// Arity is the number of children of a node. A binary heap (2) does the fewest compares per
+// level; a 4-ary heap has half the levels and the four children of a node sit next to each
+// other, usually in one cache line, so pushes and pops on big heaps miss the cache less often.
+//
+//     adstl::priority_queue<job, by_deadline> q(by_deadline(), std::move(jobs)); // O(n) heapify
+//     job next = q.push_pop(std::move(incoming));                               // one sift
+//
+// indexed_priority_queue hands out a handle for every element, so an element can be found
+// again to change its priority (decrease_key) or to take it out (erase), as Dijkstra's
+// algorithm and timer queues need.
+
+template <typename T, typename Compare = std::less<T>, typename Container = vector<T>, size_t Arity = 2>
+class priority_queue;
+
+template <typename T, typename Compare = std::less<T>, typename Container = vector<T>>
+using quaternary_priority_queue = priority_queue<T, Compare, Container, 4>;
+
+template <typename T, typename Compare = std::less<T>, size_t Arity = 2, typename Allocator = std::allocator<T>>
+class indexed_priority_queue;
+
+namespace detail
+{
+
+// the sift operations on an Arity-ary heap in a, anything with operator[]. The element to
+// place is held outside the heap while it moves, the elements it passes are moved once into
+// the hole it leaves, placed(i) is called for every element that lands at index i
+template <size_t Arity>
+struct d_ary_heap
+{
+    static_assert(Arity >= 2, "d_ary_heap: a node has to have at least two children");
+
+    static size_t parent(size_t i) { return (i - 1) / Arity; }
+    static size_t first_child(size_t i) { return Arity * i + 1; }
+
+    // fills the hole at i with value, moving it up past the elements it outranks
+    template <typename Elements, typename U, typename Less, typename Placed>
+    static void sift_up(Elements &a, size_t i, U &&value, Less less, Placed placed)
+    {
+        while(i != 0)
+        {
+            const size_t p = parent(i);
+            if(!less(a[p], value))
+            {
+                break;
+            }
+            a[i] = std::move(a[p]);
+            placed(i);
+            i = p;
+        }
+        a[i] = std::forward<U>(value);
+        placed(i);
+    }
+
+    // fills the hole at i of a heap of n elements with value, moving it down past its
+    // higher priority children
+    template <typename Elements, typename U, typename Less, typename Placed>
+    static void sift_down(Elements &a, size_t n, size_t i, U &&value, Less less, Placed placed)
+    {
+        for(;;)
+        {
+            const size_t child = first_child(i);
+            if(child >= n)
+            {
+                break;
+            }
+
+            const size_t end = n - child < Arity ? n : child + Arity;
+            size_t best = child;
+            for(size_t k = child + 1; k < end; ++k)
+            {
+                if(less(a[best], a[k]))
+                {
+                    best = k;
+                }
+            }
+            if(!less(value, a[best]))
+            {
+                break;
+            }
+            a[i] = std::move(a[best]);
+            placed(i);
+            i = best;
+        }
+        a[i] = std::forward<U>(value);
+        placed(i);
+    }
+
+    // Floyd's bottom up construction, O(n): every inner node is sifted down, the last first
+    template <typename Elements, typename Less, typename Placed>
+    static void make_heap(Elements &a, size_t n, Less less, Placed placed)
+    {
+        if(n < 2)
+        {
+            return;
+        }
+        for(size_t i = parent(n - 1) + 1; i-- != 0;)
+        {
+            auto value = std::move(a[i]);
+            sift_down(a, n, i, std::move(value), less, placed);
+        }
+    }
+};
+
+// placed callback of the heaps that do not track positions
+struct no_placement
+{
+    void operator()(size_t) const noexcept {}
+};
+
+}
+
+// Container needs operator[], push_back, pop_back, back, size and clear,
+// adstl::vector, adstl::small_vector and adstl::segmented_vector all fit.
+template <typename T, typename Compare, typename Container, size_t Arity>
+class priority_queue final
+{
+    using heap = detail::d_ary_heap<Arity>;
+
+    public:
+
+        using value_type = T;
+        using value_compare = Compare;
+        using container_type = Container;
+        using size_type = size_t;
+        static constexpr size_t arity = Arity;
+
+        priority_queue() : comp(), data() {} // def ctor
+        explicit priority_queue(const Compare &c) : comp(c), data() {}
+        // bulk construction, the elements are heapified in O(n)
+        explicit priority_queue(Container &&c) : priority_queue(Compare(), std::move(c)) {}
+        priority_queue(const Compare &c, const Container &elements) : comp(c), data(elements) { make_heap(); }
+        priority_queue(const Compare &c, Container &&elements) : comp(c), data(std::move(elements)) { make_heap(); }
+        template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+        priority_queue(It first, It last, const Compare &c = Compare()) : comp(c), data() { push_range(first, last); }
+
+        const T& top() const;
+        bool empty() const { return data.size() == 0; }
+        size_t size() const { return data.size(); }
+
+        template <typename U> void push(U&&);
+        template <typename... Args> void emplace(Args&&...);
+        // appends the range, a range at least as big as the heap is heapified with it in
+        // O(n), a smaller one is pushed element by element
+        template <typename It> void push_range(It, It);
+        void pop();
+
+        // push(value) then pop() with one sift at most, the value itself comes back
+        // without touching the heap when it outranks the top
+        template <typename U> T push_pop(U&&);
+        // pop() then push(value) with one sift, the queue must not be empty
+        template <typename U> T replace_top(U&&);
+
+        // no exceptions, errc::empty on an empty queue, try_pop moves the top out
+        expected<const T&> try_top() const;
+        expected<T> try_pop();
+
+        void clear() { data.clear(); }
+        void reserve(size_t n) { data.reserve(n); }
+        void swap(priority_queue&) noexcept;
+        // the elements in heap order
+        const Container& container() const { return data; }
+
+    private:
+
+        void make_heap() { heap::make_heap(data, data.size(), comp, detail::no_placement()); }
+        T take_top(); // moves the top out and closes the gap, the queue is not empty
+
+        Compare comp;
+        Container data;
+};
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+const T& priority_queue<T, Compare, Container, Arity>::top() const
+{
+    if(data.size()) ADSTL_LIKELY
+    {
+        return data[0];
+    }
+    ADSTL_FAIL(std::out_of_range("priority_queue::top: queue is empty."));
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+template <typename U>
+void priority_queue<T, Compare, Container, Arity>::push(U &&element)
+{
+    data.push_back(std::forward<U>(element));
+    T value = std::move(data.back());
+    heap::sift_up(data, data.size() - 1, std::move(value), comp, detail::no_placement());
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+template <typename... Args>
+void priority_queue<T, Compare, Container, Arity>::emplace(Args&&... args)
+{
+    data.emplace_back(std::forward<Args>(args)...);
+    T value = std::move(data.back());
+    heap::sift_up(data, data.size() - 1, std::move(value), comp, detail::no_placement());
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+template <typename It>
+void priority_queue<T, Compare, Container, Arity>::push_range(It first, It last)
+{
+    const size_t old_size = data.size();
+    for(; first != last; ++first)
+    {
+        data.push_back(*first);
+    }
+
+    // k sifts up cost O(k log n) at worst, heapifying everything O(n + k)
+    const size_t added = data.size() - old_size;
+    if(added >= old_size)
+    {
+        make_heap();
+        return;
+    }
+    for(size_t i = old_size; i != data.size(); ++i)
+    {
+        T value = std::move(data[i]);
+        heap::sift_up(data, i, std::move(value), comp, detail::no_placement());
+    }
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+void priority_queue<T, Compare, Container, Arity>::pop()
+{
+    if(data.size())
+    {
+        T last = std::move(data.back());
+        data.pop_back();
+        if(data.size())
+        {
+            heap::sift_down(data, data.size(), 0, std::move(last), comp, detail::no_placement());
+        }
+    }
+    #ifdef ADSTL_THROWABLE
+    else
+    {
+        throw std::out_of_range("priority_queue::pop: queue is empty.");
+    }
+    #endif
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+T priority_queue<T, Compare, Container, Arity>::take_top()
+{
+    T top = std::move(data[0]);
+    T last = std::move(data.back());
+    data.pop_back();
+    if(data.size())
+    {
+        heap::sift_down(data, data.size(), 0, std::move(last), comp, detail::no_placement());
+    }
+    return top;
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+template <typename U>
+T priority_queue<T, Compare, Container, Arity>::push_pop(U &&element)
+{
+    if(data.size() == 0 || !comp(element, data[0]))
+    {
+        return T(std::forward<U>(element));
+    }
+    T top = std::move(data[0]);
+    heap::sift_down(data, data.size(), 0, T(std::forward<U>(element)), comp, detail::no_placement());
+    return top;
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+template <typename U>
+T priority_queue<T, Compare, Container, Arity>::replace_top(U &&element)
+{
+    if(data.size() == 0) ADSTL_UNLIKELY
+    {
+        ADSTL_FAIL(std::out_of_range("priority_queue::replace_top: queue is empty."));
+    }
+    T top = std::move(data[0]);
+    heap::sift_down(data, data.size(), 0, T(std::forward<U>(element)), comp, detail::no_placement());
+    return top;
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+expected<const T&> priority_queue<T, Compare, Container, Arity>::try_top() const
+{
+    if(data.size()) ADSTL_LIKELY
+    {
+        return data[0];
+    }
+    return unexpected(errc::empty);
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+expected<T> priority_queue<T, Compare, Container, Arity>::try_pop()
+{
+    if(data.size()) ADSTL_LIKELY
+    {
+        return take_top();
+    }
+    return unexpected(errc::empty);
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+void priority_queue<T, Compare, Container, Arity>::swap(priority_queue &rhs) noexcept
+{
+    using std::swap;
+    swap(comp, rhs.comp);
+    data.swap(rhs.data);
+}
+
+// Priority queue whose elements can be reached through the handle push returned, for as
+// long as they are in the queue. The elements are kept in the heap array itself, so sifting
+// compares neighbouring elements, and a table maps every handle to the element's index.
+// Handles of popped or erased elements are reused by later pushes.
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+class indexed_priority_queue final
+{
+    using heap = detail::d_ary_heap<Arity>;
+
+    struct entry
+    {
+        template <typename... Args>
+        entry(size_t handle, Args&&... args) : value(std::forward<Args>(args)...), handle(handle) {}
+
+        T value;
+        size_t handle;
+    };
+
+    using entry_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<entry>;
+    using index_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_t>;
+
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    public:
+
+        using value_type = T;
+        using value_compare = Compare;
+        using allocator_type = Allocator;
+        using size_type = size_t;
+        using handle_type = size_t;
+        static constexpr size_t arity = Arity;
+
+        indexed_priority_queue() : indexed_priority_queue(Compare()) {} // def ctor
+        explicit indexed_priority_queue(const Compare &c, const Allocator &a = Allocator())
+            : comp(c), elements(entry_allocator(a)), positions(index_allocator(a)), free_handles(index_allocator(a)) {}
+        // bulk construction in O(n), the elements get the handles 0 to n - 1 in range order
+        template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+        indexed_priority_queue(It, It, const Compare &c = Compare(), const Allocator &a = Allocator());
+
+        allocator_type get_allocator() const { return allocator_type(elements.get_allocator()); }
+
+        const T& top() const;
+        handle_type top_handle() const;
+        bool empty() const { return elements.size() == 0; }
+        size_t size() const { return elements.size(); }
+
+        template <typename U> handle_type push(U &&element) { return emplace(std::forward<U>(element)); }
+        template <typename... Args> handle_type emplace(Args&&...);
+        void pop();
+
+        // no exceptions, errc::empty on an empty queue, try_pop moves the top out
+        expected<const T&> try_top() const;
+        expected<T> try_pop();
+
+        // the handle has to be in the queue for these
+        bool contains(handle_type h) const { return h < positions.size() && positions[h] != npos; }
+        const T& value(handle_type h) const { return elements[positions[h]].value; }
+        // gives the element a priority at least as high as before and moves it up, with
+        // Compare = std::greater<> (a min queue, as in Dijkstra) that is a smaller value
+        template <typename U> void decrease_key(handle_type, U&&);
+        // gives the element any new value, it moves up or down
+        template <typename U> void update(handle_type, U&&);
+        void erase(handle_type);
+
+        void clear();
+        void reserve(size_t);
+        void swap(indexed_priority_queue&) noexcept;
+
+    private:
+
+        // the heap is ordered by the values only
+        struct entry_less
+        {
+            bool operator()(const entry &lhs, const entry &rhs) const { return comp(lhs.value, rhs.value); }
+            const Compare &comp;
+        };
+
+        // keeps the handle table in step with the elements the heap moves
+        struct track
+        {
+            void operator()(size_t i) const noexcept { positions[elements[i].handle] = i; }
+            vector<entry, entry_allocator> &elements;
+            vector<size_t, index_allocator> &positions;
+        };
+
+        entry_less less() const { return entry_less{comp}; }
+        track tracker() { return track{elements, positions}; }
+        void remove_at(size_t); // takes the element at index i out, its handle is already released
+
+        Compare comp;
+        vector<entry, entry_allocator> elements;     // heap order
+        vector<size_t, index_allocator> positions;   // handle -> index in elements, npos when free
+        vector<size_t, index_allocator> free_handles;
+};
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+template <typename It, typename>
+indexed_priority_queue<T, Compare, Arity, Allocator>::indexed_priority_queue(It first, It last, const Compare &c, const Allocator &a)
+    : indexed_priority_queue(c, a)
+{
+    for(size_t h = 0; first != last; ++first, ++h)
+    {
+        elements.emplace_back(h, *first);
+        positions.push_back(h);
+    }
+    heap::make_heap(elements, elements.size(), less(), tracker());
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+const T& indexed_priority_queue<T, Compare, Arity, Allocator>::top() const
+{
+    if(elements.size()) ADSTL_LIKELY
+    {
+        return elements[0].value;
+    }
+    ADSTL_FAIL(std::out_of_range("indexed_priority_queue::top: queue is empty."));
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+typename indexed_priority_queue<T, Compare, Arity, Allocator>::handle_type indexed_priority_queue<T, Compare, Arity, Allocator>::top_handle() const
+{
+    if(elements.size()) ADSTL_LIKELY
+    {
+        return elements[0].handle;
+    }
+    ADSTL_FAIL(std::out_of_range("indexed_priority_queue::top_handle: queue is empty."));
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+template <typename... Args>
+typename indexed_priority_queue<T, Compare, Arity, Allocator>::handle_type indexed_priority_queue<T, Compare, Arity, Allocator>::emplace(Args&&... args)
+{
+    // the handle table grows before the element is built, so a throwing constructor or
+    // allocation leaves the queue as it was
+    const bool reuse = free_handles.size() != 0;
+    const size_t h = reuse ? free_handles.back() : positions.size();
+    if(!reuse)
+    {
+        positions.push_back(npos);
+    }
+    ADSTL_TRY
+    {
+        elements.emplace_back(h, std::forward<Args>(args)...);
+    }
+    ADSTL_CATCH_ALL
+    {
+        if(!reuse)
+        {
+            positions.pop_back();
+        }
+        ADSTL_RETHROW;
+    }
+    if(reuse)
+    {
+        free_handles.pop_back();
+    }
+
+    entry e = std::move(elements.back());
+    heap::sift_up(elements, elements.size() - 1, std::move(e), less(), tracker());
+    return h;
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+void indexed_priority_queue<T, Compare, Arity, Allocator>::pop()
+{
+    if(elements.size())
+    {
+        const size_t h = elements[0].handle;
+        free_handles.push_back(h);
+        positions[h] = npos;
+        remove_at(0);
+    }
+    #ifdef ADSTL_THROWABLE
+    else
+    {
+        throw std::out_of_range("indexed_priority_queue::pop: queue is empty.");
+    }
+    #endif
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+expected<const T&> indexed_priority_queue<T, Compare, Arity, Allocator>::try_top() const
+{
+    if(elements.size()) ADSTL_LIKELY
+    {
+        return elements[0].value;
+    }
+    return unexpected(errc::empty);
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+expected<T> indexed_priority_queue<T, Compare, Arity, Allocator>::try_pop()
+{
+    if(elements.size()) ADSTL_LIKELY
+    {
+        const size_t h = elements[0].handle;
+        free_handles.push_back(h);
+        positions[h] = npos;
+        expected<T> top(std::move(elements[0].value));
+        remove_at(0);
+        return top;
+    }
+    return unexpected(errc::empty);
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+template <typename U>
+void indexed_priority_queue<T, Compare, Arity, Allocator>::decrease_key(handle_type h, U &&element)
+{
+    const size_t i = positions[h];
+    elements[i].value = std::forward<U>(element);
+    entry e = std::move(elements[i]);
+    heap::sift_up(elements, i, std::move(e), less(), tracker());
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+template <typename U>
+void indexed_priority_queue<T, Compare, Arity, Allocator>::update(handle_type h, U &&element)
+{
+    const size_t i = positions[h];
+    elements[i].value = std::forward<U>(element);
+    entry e = std::move(elements[i]);
+    if(i != 0 && comp(elements[heap::parent(i)].value, e.value))
+    {
+        heap::sift_up(elements, i, std::move(e), less(), tracker());
+    }
+    else
+    {
+        heap::sift_down(elements, elements.size(), i, std::move(e), less(), tracker());
+    }
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+void indexed_priority_queue<T, Compare, Arity, Allocator>::erase(handle_type h)
+{
+    free_handles.push_back(h);
+    const size_t i = positions[h];
+    positions[h] = npos;
+    remove_at(i);
+}
+
+// the last element fills the gap and moves up or down from there
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+void indexed_priority_queue<T, Compare, Arity, Allocator>::remove_at(size_t i)
+{
+    const size_t last = elements.size() - 1;
+    if(i == last)
+    {
+        elements.pop_back();
+        return;
+    }
+
+    entry e = std::move(elements.back());
+    elements.pop_back();
+    if(i != 0 && comp(elements[heap::parent(i)].value, e.value))
+    {
+        heap::sift_up(elements, i, std::move(e), less(), tracker());
+    }
+    else
+    {
+        heap::sift_down(elements, last, i, std::move(e), less(), tracker());
+    }
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+void indexed_priority_queue<T, Compare, Arity, Allocator>::clear()
+{
+    elements.clear();
+    positions.clear();
+    free_handles.clear();
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+void indexed_priority_queue<T, Compare, Arity, Allocator>::reserve(size_t n)
+{
+    elements.reserve(n);
+    positions.reserve(n);
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+void indexed_priority_queue<T, Compare, Arity, Allocator>::swap(indexed_priority_queue &rhs) noexcept
+{
+    using std::swap;
+    swap(comp, rhs.comp);
+    elements.swap(rhs.elements);
+    positions.swap(rhs.positions);
+    free_handles.swap(rhs.free_handles);
+}
+
+template <typename T, typename Compare, typename Container, size_t Arity>
+void swap(priority_queue<T, Compare, Container, Arity> &lhs, priority_queue<T, Compare, Container, Arity> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template <typename T, typename Compare, size_t Arity, typename Allocator>
+void swap(indexed_priority_queue<T, Compare, Arity, Allocator> &lhs, indexed_priority_queue<T, Compare, Arity, Allocator> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
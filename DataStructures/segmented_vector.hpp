@@ -0,0 +1,463 @@
+/*
+    SEGMENTED VECTOR
+*/
+
+#ifndef SEGMENTED_VECTOR_H
+#define SEGMENTED_VECTOR_H
+
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "config.hpp" // Include the configuration header
+#include "format.hpp"
+#include "expected.hpp"
+#include "instrumentation.hpp"
+
+namespace adstl
+{
+
+// elements per segment, about 4 KiB worth of them but never less than 16
+template <typename T>
+inline constexpr size_t default_segment_size = sizeof(T) < 256 ? 4096 / sizeof(T) : 16;
+
+template <typename T, typename Allocator = std::allocator<T>, size_t SegmentSize = default_segment_size<T>> class segmented_vector;
+template <typename T, typename Allocator, size_t SegmentSize> std::ostream& operator<<(std::ostream&, const segmented_vector<T, Allocator, SegmentSize>&);
+
+// Sequence stored in a doubly linked chain of fixed size segments. Growing allocates one
+// new segment and never moves existing elements, so push_back/pop_back are O(1) in the
+// worst case and references to elements stay valid until the element is popped.
+// One emptied segment is kept as a spare, so pushing and popping around a segment
+// boundary does not hit the allocator every time.
+template <typename T, typename Allocator, size_t SegmentSize>
+class segmented_vector final
+{
+
+    static_assert(SegmentSize > 0, "segmented_vector: segments have to hold at least one element");
+
+    friend std::ostream& operator<< <T, Allocator, SegmentSize> (std::ostream&, const segmented_vector<T, Allocator, SegmentSize>&);
+
+    struct segment
+    {
+        T* data() { return reinterpret_cast<T*>(storage); }
+
+        segment *prev;
+        segment *next;
+        alignas(T) unsigned char storage[SegmentSize * sizeof(T)];
+    };
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using segment_allocator = typename alloc_traits::template rebind_alloc<segment>;
+    using segment_traits = std::allocator_traits<segment_allocator>;
+
+    private:
+        class iterator;
+        class const_iterator;
+
+    public:
+
+        using v_type = T;
+        using allocator_type = Allocator;
+        using iterator = iterator;
+        using const_iterator = const_iterator;
+
+        static constexpr size_t segment_size = SegmentSize;
+
+        segmented_vector() : segmented_vector(Allocator()) {} // def ctor
+        explicit segmented_vector(const Allocator &a)
+            : alloc(a), head(nullptr), tail(nullptr), spare(nullptr), tail_size(0), sz(0) {}
+        segmented_vector(const segmented_vector&); // cpy ctor
+        segmented_vector(segmented_vector&&) noexcept; // move ctor
+        ~segmented_vector(); // dctor
+
+        segmented_vector& operator=(const segmented_vector&); // cpy=
+        segmented_vector& operator=(segmented_vector&&)
+            noexcept(segment_traits::propagate_on_container_move_assignment::value || segment_traits::is_always_equal::value); // move=
+
+        allocator_type get_allocator() const { return allocator_type(alloc); }
+        void swap(segmented_vector&) noexcept;
+
+        void push_back(const T &elem) { emplace_back(elem); }
+        void push_back(T &&elem) { emplace_back(std::move(elem)); }
+        template <typename ... Args> void emplace_back(Args&& ...);
+        void pop_back();
+        void clear();
+
+        // undefined on an empty sequence
+        T& front() { return head->data()[0]; }
+        const T& front() const { return head->data()[0]; }
+        T& back() { return tail->data()[tail_size - 1]; }
+        const T& back() const { return tail->data()[tail_size - 1]; }
+
+        // walks the segments from the closer end, O(n / SegmentSize)
+        T& operator[](size_t);
+        const T& operator[](size_t) const;
+
+        size_t size() const { return sz; }
+        bool empty() const { return sz == 0; }
+
+        // iterator interface
+        iterator begin() { return iterator(head, 0); }
+        iterator end() { return iterator(tail, tail_size); }
+        const_iterator cbegin() const { return const_iterator(head, 0); }
+        const_iterator cend() const { return const_iterator(tail, tail_size); }
+
+    private:
+
+        class iterator
+        {
+            public:
+                iterator(segment *seg, size_t index) : seg(seg), index(index) {}
+
+                T& operator*() const
+                {
+                    return seg->data()[index];
+                }
+
+                iterator& operator++()
+                {
+                    // the position past a full segment is the end only for the last one
+                    if(++index == SegmentSize && seg->next)
+                    {
+                        seg = seg->next;
+                        index = 0;
+                    }
+                    return *this;
+                }
+
+                bool operator!=(const iterator &rhs) const
+                {
+                    return seg != rhs.seg || index != rhs.index;
+                }
+
+            private:
+                segment *seg;
+                size_t index;
+        };
+
+        class const_iterator
+        {
+            public:
+                const_iterator(segment *seg, size_t index) : seg(seg), index(index) {}
+
+                const T& operator*() const
+                {
+                    return seg->data()[index];
+                }
+
+                const_iterator& operator++()
+                {
+                    if(++index == SegmentSize && seg->next)
+                    {
+                        seg = seg->next;
+                        index = 0;
+                    }
+                    return *this;
+                }
+
+                bool operator!=(const const_iterator &rhs) const
+                {
+                    return seg != rhs.seg || index != rhs.index;
+                }
+
+            private:
+                segment *seg;
+                size_t index;
+        };
+
+        segment* acquire_segment();
+        void release_segment(segment*) noexcept;
+        void destroy_all() noexcept; // destroy the elements and free every segment
+        void steal(segmented_vector&) noexcept;
+        T* element_at(size_t) const;
+
+        segment_allocator alloc;
+        segment *head;
+        segment *tail;
+        segment *spare;
+        size_t tail_size; // elements in the tail segment
+        size_t sz;
+};
+
+template <typename T, typename Allocator, size_t SegmentSize>
+std::ostream& operator<<(std::ostream &os, const segmented_vector<T, Allocator, SegmentSize> &rhs)
+{
+    return format_range(os, rhs.cbegin(), rhs.cend());
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+typename segmented_vector<T, Allocator, SegmentSize>::segment* segmented_vector<T, Allocator, SegmentSize>::acquire_segment()
+{
+    segment *seg = spare;
+    if(seg)
+    {
+        spare = nullptr;
+    }
+    else
+    {
+        seg = segment_traits::allocate(alloc, 1);
+        ADSTL_COUNT(segmented_vector, allocations, 1);
+        ADSTL_COUNT(segmented_vector, bytes_allocated, sizeof(segment));
+    }
+
+    seg->prev = seg->next = nullptr;
+    return seg;
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+void segmented_vector<T, Allocator, SegmentSize>::release_segment(segment *seg) noexcept
+{
+    if(spare)
+    {
+        segment_traits::deallocate(alloc, spare, 1);
+    }
+    spare = seg;
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+void segmented_vector<T, Allocator, SegmentSize>::destroy_all() noexcept
+{
+    segment *seg = head;
+    while(seg)
+    {
+        segment *next = seg->next;
+        size_t count = next ? SegmentSize : tail_size;
+
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            for(size_t i = 0; i != count; ++i)
+            {
+                seg->data()[i].~T();
+            }
+        }
+
+        segment_traits::deallocate(alloc, seg, 1);
+        seg = next;
+    }
+
+    if(spare)
+    {
+        segment_traits::deallocate(alloc, spare, 1);
+    }
+
+    head = tail = spare = nullptr;
+    tail_size = sz = 0;
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+void segmented_vector<T, Allocator, SegmentSize>::steal(segmented_vector &rhs) noexcept
+{
+    head = rhs.head;
+    tail = rhs.tail;
+    spare = rhs.spare;
+    tail_size = rhs.tail_size;
+    sz = rhs.sz;
+
+    rhs.head = rhs.tail = rhs.spare = nullptr;
+    rhs.tail_size = rhs.sz = 0;
+}
+
+// cpy ctor
+template <typename T, typename Allocator, size_t SegmentSize>
+segmented_vector<T, Allocator, SegmentSize>::segmented_vector(const segmented_vector &rhs)
+    : segmented_vector(Allocator(segment_traits::select_on_container_copy_construction(rhs.alloc)))
+{
+    for(const_iterator b = rhs.cbegin(); b != rhs.cend(); ++b)
+    {
+        push_back(*b);
+    }
+}
+
+// move ctor
+template <typename T, typename Allocator, size_t SegmentSize>
+segmented_vector<T, Allocator, SegmentSize>::segmented_vector(segmented_vector &&rhs) noexcept : alloc(std::move(rhs.alloc))
+{
+    steal(rhs);
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+segmented_vector<T, Allocator, SegmentSize>::~segmented_vector()
+{
+    destroy_all();
+}
+
+// cpy=
+template <typename T, typename Allocator, size_t SegmentSize>
+segmented_vector<T, Allocator, SegmentSize>& segmented_vector<T, Allocator, SegmentSize>::operator=(const segmented_vector &rhs)
+{
+    if(this != &rhs)
+    {
+        destroy_all();
+
+        if constexpr (segment_traits::propagate_on_container_copy_assignment::value)
+            alloc = rhs.alloc;
+
+        for(const_iterator b = rhs.cbegin(); b != rhs.cend(); ++b)
+        {
+            push_back(*b);
+        }
+    }
+
+    return *this;
+}
+
+// move=
+template <typename T, typename Allocator, size_t SegmentSize>
+segmented_vector<T, Allocator, SegmentSize>& segmented_vector<T, Allocator, SegmentSize>::operator=(segmented_vector &&rhs)
+    noexcept(segment_traits::propagate_on_container_move_assignment::value || segment_traits::is_always_equal::value)
+{
+    if(this != &rhs)
+    {
+        destroy_all();
+
+        if constexpr (!segment_traits::propagate_on_container_move_assignment::value && !segment_traits::is_always_equal::value)
+        {
+            // rhs segments belong to a different allocator, we can only move the elements one by one
+            if(alloc != rhs.alloc)
+            {
+                for(iterator b = rhs.begin(); b != rhs.end(); ++b)
+                {
+                    push_back(std::move(*b));
+                }
+                return *this;
+            }
+        }
+
+        if constexpr (segment_traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+
+        steal(rhs);
+    }
+
+    return *this;
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+void segmented_vector<T, Allocator, SegmentSize>::swap(segmented_vector &rhs) noexcept
+{
+    if constexpr (segment_traits::propagate_on_container_swap::value)
+    {
+        using std::swap;
+        swap(alloc, rhs.alloc);
+    }
+
+    std::swap(head, rhs.head);
+    std::swap(tail, rhs.tail);
+    std::swap(spare, rhs.spare);
+    std::swap(tail_size, rhs.tail_size);
+    std::swap(sz, rhs.sz);
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+template <typename ... Args>
+void segmented_vector<T, Allocator, SegmentSize>::emplace_back(Args&& ... args)
+{
+    if(tail && tail_size != SegmentSize)
+    {
+        ::new (static_cast<void*>(tail->data() + tail_size)) T(std::forward<Args>(args) ...);
+        ++tail_size;
+        ++sz;
+        return;
+    }
+
+    // link a new segment once the element is in it, nothing that is already stored moves
+    segment *seg = acquire_segment();
+    ADSTL_TRY
+    {
+        ::new (static_cast<void*>(seg->data())) T(std::forward<Args>(args) ...);
+    }
+    ADSTL_CATCH_ALL
+    {
+        release_segment(seg);
+        ADSTL_RETHROW;
+    }
+
+    if(tail)
+    {
+        seg->prev = tail;
+        tail->next = seg;
+    }
+    else
+    {
+        head = seg;
+    }
+
+    tail = seg;
+    tail_size = 1;
+    ++sz;
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+void segmented_vector<T, Allocator, SegmentSize>::pop_back()
+{
+    if(sz == 0)
+    {
+        return;
+    }
+
+    tail->data()[--tail_size].~T();
+    --sz;
+
+    if(tail_size == 0 && tail->prev)
+    {
+        segment *emptied = tail;
+        tail = tail->prev;
+        tail->next = nullptr;
+        tail_size = SegmentSize;
+
+        release_segment(emptied);
+    }
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+void segmented_vector<T, Allocator, SegmentSize>::clear()
+{
+    destroy_all();
+}
+
+template <typename T, typename Allocator, size_t SegmentSize>
+T* segmented_vector<T, Allocator, SegmentSize>::element_at(size_t index) const
+{
+    // segments are full except for the tail, walk from whichever end is closer
+    if(index < sz / 2)
+    {
+        segment *seg = head;
+        for(; index >= SegmentSize; index -= SegmentSize)
+        {
+            seg = seg->next;
+        }
+        return seg->data() + index;
+    }
+
+    size_t from_back = sz - 1 - index;
+    if(from_back < tail_size)
+    {
+        return tail->data() + (tail_size - 1 - from_back);
+    }
+
+    from_back -= tail_size;
+    segment *seg = tail->prev;
+    for(; from_back >= SegmentSize; from_back -= SegmentSize)
+    {
+        seg = seg->prev;
+    }
+    return seg->data() + (SegmentSize - 1 - from_back);
+}
+
+// op []
+template <typename T, typename Allocator, size_t SegmentSize>
+T& segmented_vector<T, Allocator, SegmentSize>::operator[](size_t index)
+{
+    return *element_at(index);
+}
+
+// op []
+template <typename T, typename Allocator, size_t SegmentSize>
+const T& segmented_vector<T, Allocator, SegmentSize>::operator[](size_t index) const
+{
+    return *element_at(index);
+}
+
+}
+
+#endif
@@ -0,0 +1,480 @@
+/*
+    BINARY SERIALIZATION
+*/
+
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "config.hpp"
+#include "vector.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ADSTL_HAS_MMAP 1
+#endif
+
+namespace adstl
+{
+
+// Binary format for sequences of trivially copyable T, version 1:
+//
+//     64 byte header | count * sizeof(T) bytes of elements, native byte order
+//
+// The header records the element size and alignment and the byte order of the writer, a
+// reader on another layout refuses the file instead of misreading it. Elements start 64
+// bytes into the file, so a mapping of the file is suitably aligned for any T.
+// count is unknown_count while a streaming write is in progress (or when the stream could
+// not seek back to patch it), readers then take everything up to the end of the file.
+
+inline constexpr std::uint32_t binary_format_version = 1;
+inline constexpr std::uint64_t unknown_count = std::numeric_limits<std::uint64_t>::max();
+
+struct binary_header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t element_size;
+    std::uint64_t element_align;
+    std::uint64_t count;
+    char reserved[24];
+};
+
+static_assert(sizeof(binary_header) == 64, "binary_header: the header has to stay 64 bytes");
+
+namespace detail
+{
+
+inline constexpr char binary_magic[8] = {'A', 'D', 'S', 'T', 'L', 'B', 'I', 'N'};
+inline constexpr std::uint32_t native_byte_order = 0x01020304;
+
+template <typename T>
+binary_header make_header(std::uint64_t count)
+{
+    binary_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, binary_magic, sizeof(h.magic));
+    h.version = binary_format_version;
+    h.byte_order = native_byte_order;
+    h.element_size = sizeof(T);
+    h.element_align = alignof(T);
+    h.count = count;
+    return h;
+}
+
+// nullptr when a file with this header can be read as T
+template <typename T>
+const char* header_error(const binary_header &h)
+{
+    if(std::memcmp(h.magic, binary_magic, sizeof(h.magic)) != 0)
+    {
+        return "load_binary: not an adstl binary file.";
+    }
+    if(h.version != binary_format_version)
+    {
+        return "load_binary: unsupported format version.";
+    }
+    if(h.byte_order != native_byte_order || h.element_size != sizeof(T) || h.element_align != alignof(T))
+    {
+        return "load_binary: file was written for another element type or byte order.";
+    }
+
+    return nullptr;
+}
+
+inline bool stream_failed(const char *error)
+{
+    #ifdef ADSTL_THROWABLE
+    throw std::runtime_error(error);
+    #endif
+
+    (void)error;
+    return false;
+}
+
+// bytes from the read position to the end of the stream, unknown_count when it can not seek
+inline std::uint64_t bytes_left(std::istream &is)
+{
+    const std::istream::pos_type pos = is.tellg();
+    if(pos == std::istream::pos_type(-1))
+    {
+        return unknown_count;
+    }
+
+    is.seekg(0, std::ios::end);
+    const std::istream::pos_type end = is.tellg();
+    is.clear(is.rdstate() & ~std::ios::failbit);
+    is.seekg(pos);
+
+    if(end == std::istream::pos_type(-1) || end < pos)
+    {
+        return unknown_count;
+    }
+    return static_cast<std::uint64_t>(end - pos);
+}
+
+// elements per staging buffer when the source is not contiguous
+template <typename T>
+inline constexpr size_t binary_chunk = sizeof(T) >= 64 * 1024 ? 1 : 64 * 1024 / sizeof(T);
+
+}
+
+// Streams elements to os as they are produced. The count in the header is patched when
+// finish() runs (the destructor calls it), streams that can not seek keep unknown_count.
+template <typename T>
+class binary_writer final
+{
+    static_assert(std::is_trivially_copyable_v<T>, "binary_writer: T has to be trivially copyable");
+
+    public:
+
+        explicit binary_writer(std::ostream &os) : os(os), start(os.tellp()), written(0), finished(false)
+        {
+            binary_header h = detail::make_header<T>(unknown_count);
+            os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        }
+
+        binary_writer(const binary_writer&) = delete;
+        binary_writer& operator=(const binary_writer&) = delete;
+        ~binary_writer() { if(!finished) finish_quietly(); }
+
+        void write(const T &elem) { write(&elem, 1); }
+
+        void write(const T *elems, size_t n)
+        {
+            os.write(reinterpret_cast<const char*>(elems), static_cast<std::streamsize>(n * sizeof(T)));
+            written += n;
+        }
+
+        size_t count() const { return written; }
+
+        // patches the header, false when the stream went bad
+        bool finish()
+        {
+            finish_quietly();
+            return os.good() || detail::stream_failed("binary_writer: write failed.");
+        }
+
+    private:
+
+        void finish_quietly()
+        {
+            finished = true;
+            if(!os.good() || start == std::streampos(-1))
+            {
+                return;
+            }
+
+            std::streampos end = os.tellp();
+            binary_header h = detail::make_header<T>(written);
+            if(os.seekp(start))
+            {
+                os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+                os.seekp(end);
+            }
+            else
+            {
+                os.clear(); // not seekable, the header keeps unknown_count
+            }
+        }
+
+        std::ostream &os;
+        std::streampos start;
+        size_t written;
+        bool finished;
+};
+
+// writes any sequence with size(), cbegin() and cend(), staged through a buffer
+template <typename Container>
+bool save_binary(std::ostream &os, const Container &c)
+{
+    using T = std::decay_t<decltype(*c.cbegin())>;
+    static_assert(std::is_trivially_copyable_v<T>, "save_binary: T has to be trivially copyable");
+
+    binary_header h = detail::make_header<T>(c.size());
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    T buffer[detail::binary_chunk<T>];
+    size_t n = 0;
+    for(auto it = c.cbegin(); it != c.cend(); ++it)
+    {
+        buffer[n++] = *it;
+        if(n == detail::binary_chunk<T>)
+        {
+            os.write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(n * sizeof(T)));
+            n = 0;
+        }
+    }
+    os.write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(n * sizeof(T)));
+
+    return os.good() || detail::stream_failed("save_binary: write failed.");
+}
+
+// the elements are contiguous, one write
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+bool save_binary(std::ostream &os, const vector<T, Allocator, GrowthPolicy, InlineCapacity> &v)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "save_binary: T has to be trivially copyable");
+
+    binary_header h = detail::make_header<T>(v.size());
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    os.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+
+    return os.good() || detail::stream_failed("save_binary: write failed.");
+}
+
+// replaces the contents of any sequence with clear() and push_back()
+template <typename Container>
+bool load_binary(std::istream &is, Container &c)
+{
+    using T = std::decay_t<decltype(*c.cbegin())>;
+    static_assert(std::is_trivially_copyable_v<T>, "load_binary: T has to be trivially copyable");
+
+    binary_header h;
+    if(!is.read(reinterpret_cast<char*>(&h), sizeof(h)))
+    {
+        return detail::stream_failed("load_binary: missing header.");
+    }
+    if(const char *error = detail::header_error<T>(h))
+    {
+        return detail::stream_failed(error);
+    }
+
+    c.clear();
+
+    T buffer[detail::binary_chunk<T>];
+    std::uint64_t left = h.count;
+    while(left)
+    {
+        size_t want = left < detail::binary_chunk<T> ? size_t(left) : detail::binary_chunk<T>;
+        is.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(want * sizeof(T)));
+        size_t got = static_cast<size_t>(is.gcount()) / sizeof(T);
+
+        for(size_t i = 0; i != got; ++i)
+        {
+            c.push_back(buffer[i]);
+        }
+
+        if(got != want)
+        {
+            if(h.count == unknown_count && is.eof())
+            {
+                is.clear(is.rdstate() & ~(std::ios::eofbit | std::ios::failbit));
+                return true;
+            }
+            return detail::stream_failed("load_binary: file is truncated.");
+        }
+        left -= (h.count == unknown_count ? 0 : got);
+    }
+
+    return true;
+}
+
+// reads straight into the vector storage
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+bool load_binary(std::istream &is, vector<T, Allocator, GrowthPolicy, InlineCapacity> &v)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "load_binary: T has to be trivially copyable");
+
+    binary_header h;
+    if(!is.read(reinterpret_cast<char*>(&h), sizeof(h)))
+    {
+        return detail::stream_failed("load_binary: missing header.");
+    }
+    if(const char *error = detail::header_error<T>(h))
+    {
+        return detail::stream_failed(error);
+    }
+
+    v.clear();
+
+    if(h.count == unknown_count)
+    {
+        // grow chunk by chunk until the end of the file
+        for(;;)
+        {
+            size_t old_size = v.size();
+            v.resize(old_size + detail::binary_chunk<T>);
+            is.read(reinterpret_cast<char*>(v.data() + old_size), static_cast<std::streamsize>(detail::binary_chunk<T> * sizeof(T)));
+            size_t got = static_cast<size_t>(is.gcount()) / sizeof(T);
+            if(got != detail::binary_chunk<T>)
+            {
+                v.resize(old_size + got);
+                is.clear(is.rdstate() & ~(std::ios::eofbit | std::ios::failbit));
+                return true;
+            }
+        }
+    }
+
+    if(h.count > v.max_size())
+    {
+        return detail::stream_failed("load_binary: element count exceeds max_size().");
+    }
+
+    // the count comes from the file, check it against the stream length before allocating,
+    // a stream that can not seek is read chunk by chunk so memory follows the data that is there
+    const std::uint64_t available = detail::bytes_left(is);
+    if(available != unknown_count && available / sizeof(T) < h.count)
+    {
+        return detail::stream_failed("load_binary: file is truncated.");
+    }
+
+    const size_t count = static_cast<size_t>(h.count);
+    const size_t step = available != unknown_count ? count : detail::binary_chunk<T>;
+    while(v.size() != count)
+    {
+        size_t old_size = v.size();
+        size_t want = count - old_size < step ? count - old_size : step;
+        v.resize(old_size + want);
+        is.read(reinterpret_cast<char*>(v.data() + old_size), static_cast<std::streamsize>(want * sizeof(T)));
+        if(static_cast<size_t>(is.gcount()) != want * sizeof(T))
+        {
+            v.clear();
+            return detail::stream_failed("load_binary: file is truncated.");
+        }
+    }
+
+    return true;
+}
+
+#ifdef ADSTL_HAS_MMAP
+
+// Read-only view of a file written by save_binary or binary_writer. The file is mapped,
+// not read, so opening is O(1) whatever the size and pages fault in when first touched.
+template <typename T>
+class mapped_vector final
+{
+    static_assert(std::is_trivially_copyable_v<T>, "mapped_vector: T has to be trivially copyable");
+
+    public:
+
+        using value_type = T;
+        using const_iterator = const T*;
+
+        mapped_vector() : base(nullptr), length(0), elements(nullptr), sz(0) {}
+        explicit mapped_vector(const std::string &path) : mapped_vector() { open(path); }
+        mapped_vector(const mapped_vector&) = delete;
+        mapped_vector& operator=(const mapped_vector&) = delete;
+        mapped_vector(mapped_vector &&rhs) noexcept : mapped_vector() { swap(rhs); }
+        mapped_vector& operator=(mapped_vector &&rhs) noexcept { mapped_vector(std::move(rhs)).swap(*this); return *this; }
+        ~mapped_vector() { close(); }
+
+        bool open(const std::string&);
+        void close();
+        bool is_open() const { return base != nullptr; }
+        void swap(mapped_vector&) noexcept;
+
+        size_t size() const { return sz; }
+        bool empty() const { return sz == 0; }
+        const T* data() const { return elements; }
+        const T& operator[](size_t n) const { return elements[n]; }
+        const T& front() const { return elements[0]; }
+        const T& back() const { return elements[sz - 1]; }
+
+        const_iterator begin() const { return elements; }
+        const_iterator end() const { return elements + sz; }
+        const_iterator cbegin() const { return elements; }
+        const_iterator cend() const { return elements + sz; }
+
+    private:
+        bool fail(const char*);
+
+        void *base;      // start of the mapping, nullptr when closed
+        size_t length;   // length of the mapping
+        const T *elements;
+        size_t sz;
+};
+
+template <typename T>
+bool mapped_vector<T>::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        return fail("mapped_vector: can not open file.");
+    }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(binary_header))
+    {
+        ::close(fd);
+        return fail("mapped_vector: file is too small.");
+    }
+
+    void *p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if(p == MAP_FAILED)
+    {
+        return fail("mapped_vector: mmap failed.");
+    }
+
+    base = p;
+    length = static_cast<size_t>(st.st_size);
+
+    const binary_header &h = *static_cast<const binary_header*>(base);
+    if(const char *error = detail::header_error<T>(h))
+    {
+        return fail(error);
+    }
+
+    size_t available = (length - sizeof(binary_header)) / sizeof(T);
+    if(h.count != unknown_count && h.count > available)
+    {
+        return fail("mapped_vector: file is truncated.");
+    }
+
+    elements = reinterpret_cast<const T*>(static_cast<const char*>(base) + sizeof(binary_header));
+    sz = h.count == unknown_count ? available : static_cast<size_t>(h.count);
+
+    return true;
+}
+
+template <typename T>
+void mapped_vector<T>::close()
+{
+    if(base)
+    {
+        ::munmap(base, length);
+    }
+
+    base = nullptr;
+    length = 0;
+    elements = nullptr;
+    sz = 0;
+}
+
+template <typename T>
+void mapped_vector<T>::swap(mapped_vector &rhs) noexcept
+{
+    std::swap(base, rhs.base);
+    std::swap(length, rhs.length);
+    std::swap(elements, rhs.elements);
+    std::swap(sz, rhs.sz);
+}
+
+template <typename T>
+bool mapped_vector<T>::fail(const char *error)
+{
+    close();
+    return detail::stream_failed(error);
+}
+
+#endif
+
+}
+
+#endif
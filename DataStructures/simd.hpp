@@ -0,0 +1,605 @@
+/*
+    SIMD KERNELS
+*/
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ADSTL_SIMD_X86 1
+#else
+#define ADSTL_SIMD_X86 0
+#endif
+
+namespace adstl
+{
+
+namespace simd
+{
+
+// Vectorized find, count, min_element, max_element, accumulate, equal and fill for
+// contiguous ranges of arithmetic types (adstl::vector iterators, raw pointers).
+//
+//     adstl::vector<float> v = ...;
+//     auto it = adstl::simd::find(v.begin(), v.end(), 1.0f);
+//     float total = adstl::simd::accumulate(v.begin(), v.end(), 0.0f);
+//
+// The widest instruction set the CPU supports (SSE2, AVX2 or AVX-512 F/DQ/BW/VL) is picked once at
+// run time. Element types other than 4 and 8 byte integers, float and double, and values
+// of another type than the elements, take the scalar std:: algorithm.
+//
+// Floating point sums are added in a different order than std::accumulate does, so the
+// last bits of the result can differ. min_element/max_element fall back to the scalar
+// algorithm when the range holds a NaN.
+
+enum class isa
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512
+};
+
+template <typename T>
+inline constexpr bool is_vectorizable_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8) && !std::is_same_v<T, long double>;
+
+inline isa active_isa();
+
+namespace detail
+{
+
+inline isa detect_isa()
+{
+    #if ADSTL_SIMD_X86
+    __builtin_cpu_init();
+    // F alone can not turn a compare mask back into a vector, GCC would scalarize the kernels
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+       __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))
+    {
+        return isa::avx512;
+    }
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return isa::avx2;
+    }
+    #endif
+
+    #if defined(__SSE2__)
+    return isa::sse2;
+    #else
+    return isa::scalar;
+    #endif
+}
+
+inline std::atomic<isa> &max_isa_setting()
+{
+    static std::atomic<isa> setting(isa::avx512);
+    return setting;
+}
+
+template <typename T, size_t Bytes>
+struct vector_of
+{
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+template <typename T, size_t Bytes>
+using vec = typename vector_of<T, Bytes>::type;
+
+// load() returns a wide vector by value, it is always inlined so no call ABI is involved
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+#define ADSTL_SIMD_INLINE __attribute__((always_inline)) inline
+
+template <typename V, typename T>
+ADSTL_SIMD_INLINE V load(const T *p)
+{
+    V v;
+    std::memcpy(&v, p, sizeof(V));
+    return v;
+}
+
+template <typename V, typename T>
+ADSTL_SIMD_INLINE void store(T *p, const V &v)
+{
+    std::memcpy(p, &v, sizeof(V));
+}
+
+// Comparison results are cast to 64 bit words (W below) one compare at a time. Combining
+// wide compare results with | before the kernel is inlined into its AVX-512 wrapper makes
+// GCC scalarize them, the casts keep them vectorized.
+template <typename V>
+using words = vec<std::uint64_t, sizeof(V)>;
+
+// true when any bit of a comparison result is set
+template <typename W>
+ADSTL_SIMD_INLINE bool any(const W &mask)
+{
+    std::uint64_t bits = 0;
+    for(size_t i = 0; i != sizeof(W) / 8; ++i)
+    {
+        bits |= mask[i];
+    }
+    return bits != 0;
+}
+
+// Each kernel has scalar(), the plain std:: algorithm, and run<Bytes>(), the same loop on
+// Bytes wide vectors. run is always inlined into the per instruction set wrappers below,
+// so one body compiles to SSE2, AVX2 and AVX-512 code.
+
+struct find_kernel
+{
+    template <typename T>
+    static const T* scalar(const T *first, const T *last, T value)
+    {
+        return std::find(first, last, value);
+    }
+
+    template <size_t Bytes, typename T>
+    ADSTL_SIMD_INLINE static const T* run(const T *first, const T *last, T value)
+    {
+        using V = vec<T, Bytes>;
+        using W = words<V>;
+        constexpr size_t lanes = Bytes / sizeof(T);
+
+        const V needle = V{} + value;
+        const T *p = first;
+
+        for(; size_t(last - p) >= 4 * lanes; p += 4 * lanes)
+        {
+            auto hit = (W)(load<V>(p) == needle) | (W)(load<V>(p + lanes) == needle) |
+                       (W)(load<V>(p + 2 * lanes) == needle) | (W)(load<V>(p + 3 * lanes) == needle);
+            if(any(hit))
+            {
+                return std::find(p, p + 4 * lanes, value);
+            }
+        }
+
+        for(; size_t(last - p) >= lanes; p += lanes)
+        {
+            if(any((W)(load<V>(p) == needle)))
+            {
+                return std::find(p, p + lanes, value);
+            }
+        }
+
+        return std::find(p, last, value);
+    }
+};
+
+struct count_kernel
+{
+    template <typename T>
+    static size_t scalar(const T *first, const T *last, T value)
+    {
+        return std::count(first, last, value);
+    }
+
+    template <size_t Bytes, typename T>
+    ADSTL_SIMD_INLINE static size_t run(const T *first, const T *last, T value)
+    {
+        using V = vec<T, Bytes>;
+        using M = decltype(V{} == V{});
+        constexpr size_t lanes = Bytes / sizeof(T);
+        constexpr size_t block = size_t(1) << 20; // vectors per block, far below lane overflow
+
+        const V needle = V{} + value;
+        const T *p = first;
+        size_t total = 0;
+
+        while(size_t(last - p) >= lanes)
+        {
+            M hits = M{};
+            size_t vectors = std::min(size_t(last - p) / lanes, block);
+            for(size_t i = 0; i != vectors; ++i, p += lanes)
+            {
+                hits -= (load<V>(p) == needle); // a match is -1
+            }
+
+            for(size_t i = 0; i != lanes; ++i)
+            {
+                total += static_cast<size_t>(hits[i]);
+            }
+        }
+
+        return total + std::count(p, last, value);
+    }
+};
+
+template <bool Max>
+struct extreme_kernel
+{
+    template <typename T>
+    static const T* scalar(const T *first, const T *last)
+    {
+        return Max ? std::max_element(first, last) : std::min_element(first, last);
+    }
+
+    template <size_t Bytes, typename T>
+    ADSTL_SIMD_INLINE static const T* run(const T *first, const T *last)
+    {
+        using V = vec<T, Bytes>;
+        using W = words<V>;
+        constexpr size_t lanes = Bytes / sizeof(T);
+
+        if(size_t(last - first) < lanes)
+        {
+            return scalar(first, last);
+        }
+
+        // pass 1 finds the extreme value, pass 2 its first position like std::min_element
+        V best = load<V>(first);
+        W nan = (W)(best != best);
+        const T *p = first + lanes;
+
+        for(; size_t(last - p) >= lanes; p += lanes)
+        {
+            V x = load<V>(p);
+            best = Max ? (x > best ? x : best) : (x < best ? x : best);
+            nan |= (W)(x != x);
+        }
+
+        if(std::is_floating_point_v<T> && any(nan))
+        {
+            return scalar(first, last);
+        }
+
+        T value = best[0];
+        for(size_t i = 1; i != lanes; ++i)
+        {
+            value = Max ? std::max(value, T(best[i])) : std::min(value, T(best[i]));
+        }
+        for(; p != last; ++p)
+        {
+            if(*p != *p)
+            {
+                return scalar(first, last);
+            }
+            value = Max ? std::max(value, *p) : std::min(value, *p);
+        }
+
+        return find_kernel::run<Bytes>(first, last, value);
+    }
+};
+
+struct accumulate_kernel
+{
+    template <typename T>
+    static T scalar(const T *first, const T *last, T init)
+    {
+        return std::accumulate(first, last, init);
+    }
+
+    // integers add in unsigned lanes, wrap around is the same modulo 2^N as the scalar sum
+    template <size_t Bytes, typename T>
+    ADSTL_SIMD_INLINE static T run(const T *first, const T *last, T init)
+    {
+        using S = std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, std::common_type<T>>;
+        using U = typename S::type;
+        using V = vec<U, Bytes>;
+        constexpr size_t lanes = Bytes / sizeof(T);
+
+        V sum0 = V{}, sum1 = V{};
+        const T *p = first;
+
+        for(; size_t(last - p) >= 2 * lanes; p += 2 * lanes)
+        {
+            sum0 += load<V>(p);
+            sum1 += load<V>(p + lanes);
+        }
+        if(size_t(last - p) >= lanes)
+        {
+            sum0 += load<V>(p);
+            p += lanes;
+        }
+        sum0 += sum1;
+
+        U total = U(init);
+        for(size_t i = 0; i != lanes; ++i)
+        {
+            total += sum0[i];
+        }
+        for(; p != last; ++p)
+        {
+            total += U(*p);
+        }
+
+        return T(total);
+    }
+};
+
+struct equal_kernel
+{
+    template <typename T>
+    static bool scalar(const T *first, const T *last, const T *other)
+    {
+        return std::equal(first, last, other);
+    }
+
+    template <size_t Bytes, typename T>
+    ADSTL_SIMD_INLINE static bool run(const T *first, const T *last, const T *other)
+    {
+        using V = vec<T, Bytes>;
+        using W = words<V>;
+        constexpr size_t lanes = Bytes / sizeof(T);
+
+        const T *p = first;
+        const T *q = other;
+
+        for(; size_t(last - p) >= 2 * lanes; p += 2 * lanes, q += 2 * lanes)
+        {
+            if(any((W)(load<V>(p) != load<V>(q)) | (W)(load<V>(p + lanes) != load<V>(q + lanes))))
+            {
+                return false;
+            }
+        }
+        for(; size_t(last - p) >= lanes; p += lanes, q += lanes)
+        {
+            if(any((W)(load<V>(p) != load<V>(q))))
+            {
+                return false;
+            }
+        }
+
+        return std::equal(p, last, q);
+    }
+};
+
+struct fill_kernel
+{
+    template <typename T>
+    static bool scalar(T *first, T *last, T value)
+    {
+        std::fill(first, last, value);
+        return true;
+    }
+
+    template <size_t Bytes, typename T>
+    ADSTL_SIMD_INLINE static bool run(T *first, T *last, T value)
+    {
+        using V = vec<T, Bytes>;
+        constexpr size_t lanes = Bytes / sizeof(T);
+
+        const V v = V{} + value;
+        T *p = first;
+
+        for(; size_t(last - p) >= lanes; p += lanes)
+        {
+            store(p, v);
+        }
+        std::fill(p, last, value);
+
+        return true;
+    }
+};
+
+#if ADSTL_SIMD_X86
+template <typename Kernel, typename... Args>
+__attribute__((target("avx2"))) auto run_avx2(Args... args)
+{
+    return Kernel::template run<32>(args...);
+}
+
+template <typename Kernel, typename... Args>
+__attribute__((target("avx512f,avx512dq,avx512bw,avx512vl"))) auto run_avx512(Args... args)
+{
+    return Kernel::template run<64>(args...);
+}
+#endif
+
+template <typename Kernel, typename... Args>
+auto dispatch(Args... args)
+{
+    switch(active_isa())
+    {
+        #if ADSTL_SIMD_X86
+        case isa::avx512:
+            return run_avx512<Kernel>(args...);
+        case isa::avx2:
+            return run_avx2<Kernel>(args...);
+        #endif
+        #if defined(__SSE2__)
+        case isa::sse2:
+            return Kernel::template run<16>(args...);
+        #endif
+        default:
+            return Kernel::scalar(args...);
+    }
+}
+
+#undef ADSTL_SIMD_INLINE
+
+#pragma GCC diagnostic pop
+
+template <typename It>
+using value_t = std::decay_t<decltype(*std::declval<It&>())>;
+
+// vectorized when the element type is and the value passed in has exactly that type
+template <typename It, typename U = value_t<It>>
+inline constexpr bool use_simd_v = is_vectorizable_v<value_t<It>> && std::is_same_v<value_t<It>, U>;
+
+}
+
+// instruction set the CPU supports
+inline isa detected_isa()
+{
+    static const isa level = detail::detect_isa();
+    return level;
+}
+
+// instruction set the kernels use, detected_isa() unless capped by set_max_isa()
+inline isa active_isa()
+{
+    return std::min(detected_isa(), detail::max_isa_setting().load(std::memory_order_relaxed));
+}
+
+// caps the instruction set, e.g. to compare the code paths against each other
+inline void set_max_isa(isa level)
+{
+    detail::max_isa_setting().store(level, std::memory_order_relaxed);
+}
+
+template <typename It, typename T>
+It find(It first, It last, const T &value)
+{
+    size_t n = last - first;
+    if(n == 0)
+    {
+        return last;
+    }
+
+    auto p = std::addressof(*first);
+    auto e = p + n;
+    if constexpr (detail::use_simd_v<It, T>)
+    {
+        return first + (detail::dispatch<detail::find_kernel>(p, e, value) - p);
+    }
+    else
+    {
+        return first + (std::find(p, e, value) - p);
+    }
+}
+
+template <typename It, typename T>
+size_t count(It first, It last, const T &value)
+{
+    size_t n = last - first;
+    if(n == 0)
+    {
+        return 0;
+    }
+
+    auto p = std::addressof(*first);
+    auto e = p + n;
+    if constexpr (detail::use_simd_v<It, T>)
+    {
+        return detail::dispatch<detail::count_kernel>(p, e, value);
+    }
+    else
+    {
+        return std::count(p, e, value);
+    }
+}
+
+template <typename It>
+It min_element(It first, It last)
+{
+    size_t n = last - first;
+    if(n == 0)
+    {
+        return last;
+    }
+
+    auto p = std::addressof(*first);
+    auto e = p + n;
+    if constexpr (detail::use_simd_v<It>)
+    {
+        return first + (detail::dispatch<detail::extreme_kernel<false>>(p, e) - p);
+    }
+    else
+    {
+        return first + (std::min_element(p, e) - p);
+    }
+}
+
+template <typename It>
+It max_element(It first, It last)
+{
+    size_t n = last - first;
+    if(n == 0)
+    {
+        return last;
+    }
+
+    auto p = std::addressof(*first);
+    auto e = p + n;
+    if constexpr (detail::use_simd_v<It>)
+    {
+        return first + (detail::dispatch<detail::extreme_kernel<true>>(p, e) - p);
+    }
+    else
+    {
+        return first + (std::max_element(p, e) - p);
+    }
+}
+
+template <typename It, typename T>
+T accumulate(It first, It last, T init)
+{
+    size_t n = last - first;
+    if(n == 0)
+    {
+        return init;
+    }
+
+    auto p = std::addressof(*first);
+    auto e = p + n;
+    if constexpr (detail::use_simd_v<It, T>)
+    {
+        return detail::dispatch<detail::accumulate_kernel>(p, e, init);
+    }
+    else
+    {
+        return std::accumulate(p, e, init);
+    }
+}
+
+// the second range has to be contiguous as well
+template <typename It1, typename It2>
+bool equal(It1 first, It1 last, It2 other)
+{
+    size_t n = last - first;
+    if(n == 0)
+    {
+        return true;
+    }
+
+    auto p = std::addressof(*first);
+    auto e = p + n;
+    auto q = std::addressof(*other);
+    if constexpr (detail::use_simd_v<It1, detail::value_t<It2>>)
+    {
+        return detail::dispatch<detail::equal_kernel>(p, e, q);
+    }
+    else
+    {
+        return std::equal(p, e, q);
+    }
+}
+
+template <typename It, typename T>
+void fill(It first, It last, const T &value)
+{
+    size_t n = last - first;
+    if(n == 0)
+    {
+        return;
+    }
+
+    auto p = std::addressof(*first);
+    auto e = p + n;
+    if constexpr (detail::use_simd_v<It, T>)
+    {
+        detail::dispatch<detail::fill_kernel>(p, e, value);
+    }
+    else
+    {
+        std::fill(p, e, value);
+    }
+}
+
+}
+
+}
+
+#endif
@@ -6,22 +6,30 @@
 #define SLLIST_H
 
 #include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include "config.hpp" // Include the configuration header
+#include "format.hpp"
+#include "expected.hpp"
+#include "instrumentation.hpp"
 
 namespace adstl
 {
 
-template <typename T> class sllist;
-template <typename T> std::ostream& operator<<(std::ostream&, const sllist<T>&); 
+template <typename T, typename Allocator = std::allocator<T>> class sllist;
+template <typename T, typename Allocator> std::ostream& operator<<(std::ostream&, const sllist<T, Allocator>&); 
 
 template <typename T>
 class Node final
 {
-    friend class sllist<T>;
-    friend std::ostream& operator<< <T> (std::ostream&, const sllist<T>&);
+    template <typename, typename> friend class sllist;
+    template <typename U, typename Allocator> friend std::ostream& operator<<(std::ostream&, const sllist<U, Allocator>&);
 
     Node(const T &data) : data(data), next(nullptr) {} // cpy ctor
     Node(T &&data) : data(std::move(data)), next(nullptr) {} // move ctor
+    template <typename ... Args>
+    Node(std::in_place_t, Args&& ... args) : data(std::forward<Args>(args) ...), next(nullptr) {} // construct data in place
     ~Node() {} // dctor
 
     private:
@@ -29,11 +37,14 @@ class Node final
         Node *next;
 };
 
-template <typename T>
+template <typename T, typename Allocator>
 class sllist final
 {
 
-    friend std::ostream& operator<< <T> (std::ostream&, const sllist<T>&);
+    friend std::ostream& operator<< <T, Allocator> (std::ostream&, const sllist<T, Allocator>&);
+
+    using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node<T>>;
+    using node_traits = std::allocator_traits<node_allocator>;
 
     private:
         class iterator;
@@ -42,19 +53,38 @@ class sllist final
     public:
     
         using l_type = T;
+        using allocator_type = Allocator;
         using iterator = iterator;
         using const_iterator = const_iterator;
 
-        sllist() : head(nullptr), sz(0) {} // def ctor
+        sllist() : sllist(Allocator()) {} // def ctor
+        explicit sllist(const Allocator &a) 
+            : alloc(a), head(nullptr), tail(nullptr), sz(0), cursor_node(nullptr), cursor_index(0),
+              slabs(nullptr), rewound(nullptr), slab_cursor(nullptr), slab_end(nullptr), free_list(nullptr), free_tail(nullptr), cap(0) {}
         sllist(const sllist&); // copy ctor
         sllist(sllist&&) noexcept; // move ctor
         ~sllist(); // dctor
 
         sllist& operator=(const sllist&); // cpy=
-        sllist& operator=(sllist&&) noexcept; // move=
+        sllist& operator=(sllist&&) 
+            noexcept(node_traits::propagate_on_container_move_assignment::value || node_traits::is_always_equal::value); // move=
+
+        allocator_type get_allocator() const { return allocator_type(alloc); }
+        void swap(sllist&) noexcept;
 
+        // the non const overload remembers the node it reached, the next call for the same or a
+        // later index walks on from there, so increasing indices cost O(1) each instead of O(n)
         T& operator[](size_t);
         const T& operator[](size_t) const;
+        // no exceptions, errc::out_of_range past the end
+        expected<T&> try_at(size_t);
+        expected<const T&> try_at(size_t) const;
+
+        // undefined on an empty list
+        T& front() { return head->data; }
+        const T& front() const { return head->data; }
+        T& back() { return tail->data; }
+        const T& back() const { return tail->data; }
 
         // iterator interface
         iterator begin() { return iterator(head); }
@@ -64,16 +94,31 @@ class sllist final
         const_iterator cend() const { return const_iterator(nullptr); }
 
         size_t size() const { return sz; }
+        // clear() and pop_back() keep the nodes for reuse, shrink_to_fit() gives back what size() does not need
+        size_t capacity() const { return cap; } // number of nodes the list can hold without allocating
+        void reserve(size_t);
+        void shrink_to_fit();
         template <typename U> void push_back(U&&);
+        template <typename ... Args> void emplace_back(Args&& ...);
+        template <typename U> void push_front(U&&);
+        template <typename ... Args> void emplace_front(Args&& ...);
         void pop_back(); // pop_back is so unefficient in singly linked list, complexity O(n)
         void clear();
         template <typename U> void insert(size_t, U&&);
+        template <typename U> expected<void> try_insert(size_t, U&&); // errc::out_of_range when position > size()
         void reverse();
 
+        // relink all nodes of rhs after pos (end() appends), rhs is left empty
+        // O(1) node work when allocators compare equal, otherwise elements are moved one by one
+        void splice_after(const_iterator, sllist&&);
+        void append(sllist &&rhs) { splice_after(cend(), std::move(rhs)); }
+
     private:
 
         class iterator
         {
+            friend class sllist;
+
             public:
                 iterator(Node<T> *it) : it(it) {}
 
@@ -99,6 +144,8 @@ class sllist final
 
         class const_iterator
         {
+            friend class sllist;
+
             public:
                 const_iterator(Node<T> *it) : it(it) {}
 
@@ -122,29 +169,364 @@ class sllist final
                 Node<T> *it;
         };
 
+        // Nodes are carved out of slabs, every slab keeps its header in the first node slot.
+        // Destroyed nodes go to the free list and are reused before the slab is bumped further.
+        // Emptying the whole list does not touch the nodes, the slabs are rewound and bumped
+        // through again from the newest one.
+        struct slab_header
+        {
+            slab_header *next;
+            size_t count; // node slots in the slab, including the header slot
+        };
+
+        struct free_slot
+        {
+            free_slot *next;
+        };
+
+        static_assert(sizeof(slab_header) <= sizeof(Node<T>) && alignof(slab_header) <= alignof(Node<T>));
+
+        static constexpr size_t min_slab_size = 16;
+        static constexpr size_t max_slab_size = 1 << 16;
+
+        template <typename ... Args> Node<T>* create_node(Args&& ...);
+        void destroy_node(Node<T>*);
+        void free_nodes(); // destroy all nodes, list is left in a dangling state
+        void destroy_chain(Node<T>*); // destroy the given node and all nodes after it
+
+        Node<T>* acquire_slot();
+        void release_slot(Node<T>*) noexcept;
+        void add_slab(size_t);
+        void release_slabs() noexcept;
+        void rewind_slabs() noexcept; // every slot becomes free, only when no node is alive
+        void unwind_slabs() noexcept; // move the slots of the rewound slabs to the free list
+        void steal_storage(sllist&) noexcept;
+        void adopt_storage(sllist&) noexcept;
+        void link_back(Node<T>*) noexcept;
+
+        Node<T>* find_node(size_t) const; // index < sz, starts at the cursor when it is not past index
+        Node<T>* seek(size_t); // find_node that moves the cursor to the node found
+        void reset_cursor() noexcept { cursor_node = nullptr; cursor_index = 0; }
+
+        node_allocator alloc;
         Node<T> *head;
+        Node<T> *tail;
         size_t sz;
 
+        // last node reached by an index, nullptr when unset; kept valid by every operation that
+        // shifts or removes nodes in front of it, reset by the ones that reorder the list
+        Node<T> *cursor_node;
+        size_t cursor_index;
+
+        slab_header *slabs;
+        slab_header *rewound; // older slabs to bump through once the current one is used up
+        Node<T> *slab_cursor; // first untouched slot of the slab being bumped
+        Node<T> *slab_end;
+        free_slot *free_list;
+        free_slot *free_tail;
+        size_t cap;
+
 };
 
-template <typename T>
-std::ostream& operator<<(std::ostream &os, const sllist<T> &list)
+template <typename T, typename Allocator>
+std::ostream& operator<<(std::ostream &os, const sllist<T, Allocator> &list)
+{
+    return format_range(os, list.cbegin(), list.cend());
+}
+
+template <typename T, typename Allocator>
+Node<T>* sllist<T, Allocator>::acquire_slot()
+{
+    if(free_list)
+    {
+        free_slot *slot = free_list;
+        free_list = slot->next;
+        if(free_list == nullptr)
+        {
+            free_tail = nullptr;
+        }
+        return reinterpret_cast<Node<T>*>(slot);
+    }
+
+    if(slab_cursor == slab_end && rewound)
+    {
+        slab_cursor = reinterpret_cast<Node<T>*>(rewound) + 1;
+        slab_end = reinterpret_cast<Node<T>*>(rewound) + rewound->count;
+        rewound = rewound->next;
+    }
+
+    if(slab_cursor == slab_end)
+    {
+        // grow geometrically, so building a list of n elements costs O(log n) slab allocations
+        size_t slab_size = cap < min_slab_size ? min_slab_size : cap;
+        add_slab(slab_size < max_slab_size ? slab_size : max_slab_size);
+    }
+
+    return slab_cursor++;
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::release_slot(Node<T> *node) noexcept
+{
+    free_list = ::new (static_cast<void*>(node)) free_slot{free_list};
+    if(free_tail == nullptr)
+    {
+        free_tail = free_list;
+    }
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::add_slab(size_t nodes)
+{
+    Node<T> *raw = node_traits::allocate(alloc, nodes + 1);
+
+    // keep the leftover of the current slab reachable through the free list
+    while(slab_cursor != slab_end)
+    {
+        release_slot(slab_cursor++);
+    }
+
+    slabs = ::new (static_cast<void*>(raw)) slab_header{slabs, nodes + 1};
+    slab_cursor = raw + 1;
+    slab_end = raw + nodes + 1;
+    cap += nodes;
+    ADSTL_COUNT_ALLOCATION(sllist, cap, (nodes + 1) * sizeof(Node<T>));
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::release_slabs() noexcept
+{
+    while(slabs)
+    {
+        slab_header *next = slabs->next;
+        node_traits::deallocate(alloc, reinterpret_cast<Node<T>*>(slabs), slabs->count);
+        slabs = next;
+    }
+
+    rewound = nullptr;
+    slab_cursor = slab_end = nullptr;
+    free_list = free_tail = nullptr;
+    cap = 0;
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::rewind_slabs() noexcept
+{
+    free_list = free_tail = nullptr;
+
+    if(slabs)
+    {
+        slab_cursor = reinterpret_cast<Node<T>*>(slabs) + 1;
+        slab_end = reinterpret_cast<Node<T>*>(slabs) + slabs->count;
+        rewound = slabs->next;
+    }
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::unwind_slabs() noexcept
+{
+    for(; rewound; rewound = rewound->next)
+    {
+        Node<T> *slot = reinterpret_cast<Node<T>*>(rewound) + 1;
+        Node<T> *end = reinterpret_cast<Node<T>*>(rewound) + rewound->count;
+        while(slot != end)
+        {
+            release_slot(slot++);
+        }
+    }
+}
+
+// take over the nodes and the slabs of rhs, allocators have to compare equal
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::steal_storage(sllist &rhs) noexcept
+{
+    head = rhs.head;
+    tail = rhs.tail;
+    sz = rhs.sz;
+    cursor_node = rhs.cursor_node;
+    cursor_index = rhs.cursor_index;
+    slabs = rhs.slabs;
+    rewound = rhs.rewound;
+    slab_cursor = rhs.slab_cursor;
+    slab_end = rhs.slab_end;
+    free_list = rhs.free_list;
+    free_tail = rhs.free_tail;
+    cap = rhs.cap;
+
+    rhs.head = rhs.tail = nullptr;
+    rhs.sz = 0;
+    rhs.reset_cursor();
+    rhs.slabs = rhs.rewound = nullptr;
+    rhs.slab_cursor = rhs.slab_end = nullptr;
+    rhs.free_list = rhs.free_tail = nullptr;
+    rhs.cap = 0;
+}
+
+// merge the slabs and free slots of rhs into ours, leaving its nodes untouched
+// allocators have to compare equal, rhs is left without storage
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::adopt_storage(sllist &rhs) noexcept
+{
+    if(rhs.slabs == nullptr)
+    {
+        return;
+    }
+
+    // our rewound slabs stay behind the merged chain, rhs ones have to go through the free list
+    rhs.unwind_slabs();
+
+    // rhs slabs go in front of ours, only the rhs chain has to be walked to find its end.
+    // The bump cursor is an address inside its slab, not a position in the chain, so it
+    // stays valid wherever that slab ends up; the chain order only matters again when
+    // rewind_slabs() starts over from the front
+    slab_header *last_slab = rhs.slabs;
+    while(last_slab->next)
+    {
+        last_slab = last_slab->next;
+    }
+    last_slab->next = slabs;
+    slabs = rhs.slabs;
+
+    if(rhs.free_list)
+    {
+        rhs.free_tail->next = free_list;
+        if(free_list == nullptr)
+        {
+            free_tail = rhs.free_tail;
+        }
+        free_list = rhs.free_list;
+    }
+
+    if(slab_cursor == slab_end)
+    {
+        slab_cursor = rhs.slab_cursor;
+        slab_end = rhs.slab_end;
+    }
+    else
+    {
+        while(rhs.slab_cursor != rhs.slab_end)
+        {
+            release_slot(rhs.slab_cursor++);
+        }
+    }
+
+    cap += rhs.cap;
+
+    rhs.slabs = nullptr;
+    rhs.slab_cursor = rhs.slab_end = nullptr;
+    rhs.free_list = rhs.free_tail = nullptr;
+    rhs.cap = 0;
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::link_back(Node<T> *node) noexcept
+{
+    if(tail)
+    {
+        tail->next = node;
+    }
+    else
+    {
+        head = node;
+    }
+    tail = node;
+    ++sz;
+}
+
+template <typename T, typename Allocator>
+template <typename ... Args>
+Node<T>* sllist<T, Allocator>::create_node(Args&& ... args)
+{
+    Node<T> *node = acquire_slot();
+    ADSTL_COUNT(sllist, node_allocations, 1);
+    ADSTL_TRY
+    {
+        ::new (static_cast<void*>(node)) Node<T>(std::in_place, std::forward<Args>(args) ...);
+    }
+    ADSTL_CATCH_ALL
+    {
+        release_slot(node);
+        ADSTL_RETHROW;
+    }
+    return node;
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::destroy_node(Node<T> *node)
+{
+    node->~Node();
+    release_slot(node);
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::reserve(size_t n)
+{
+    if(n > cap)
+    {
+        add_slab(n - cap);
+    }
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::free_nodes()
+{
+    reset_cursor();
+
+    if constexpr (std::is_trivially_destructible_v<T>)
+    {
+        // nothing to run per node, every slot is free again at once
+        rewind_slabs();
+    }
+    else
+    {
+        destroy_chain(head);
+    }
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::destroy_chain(Node<T> *current_node)
+{
+    while(current_node != nullptr)
+    {
+        Node<T> *next_node = current_node->next;
+        destroy_node(current_node);
+        current_node = next_node;
+    }
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::shrink_to_fit()
 {
-    Node<T> *tmp_node = list.head;
-    while(tmp_node)
+    if(sz == cap)
+    {
+        return;
+    }
+
+    if(sz == 0)
+    {
+        release_slabs();
+        return;
+    }
+
+    // move the elements into a single slab that fits them exactly
+    sllist compact(get_allocator());
+    compact.reserve(sz);
+    for(Node<T> *current_node = head; current_node; current_node = current_node->next)
     {
-        os << tmp_node->data << " ";
-        tmp_node = tmp_node->next;
+        compact.push_back(std::move_if_noexcept(current_node->data));
     }
-    return os;
+    swap(compact);
 }
 
 // cpy ctor
-template <typename T>
-sllist<T>::sllist(const sllist &rhs) : head(nullptr), sz(0)
+template <typename T, typename Allocator>
+sllist<T, Allocator>::sllist(const sllist &rhs) 
+    : sllist(Allocator(node_traits::select_on_container_copy_construction(rhs.alloc)))
 {
     if(rhs.head != nullptr)
     {
+        reserve(rhs.sz);
+
         Node<T> *tmp_node = rhs.head;
         while(tmp_node)
         {
@@ -155,35 +537,68 @@ sllist<T>::sllist(const sllist &rhs) : head(nullptr), sz(0)
 }
 
 // move ctor
-template <typename T>
-sllist<T>::sllist(sllist &&rhs) noexcept : head(rhs.head), sz(rhs.sz)
+template <typename T, typename Allocator>
+sllist<T, Allocator>::sllist(sllist &&rhs) noexcept : alloc(std::move(rhs.alloc))
 {
-    rhs.head = nullptr;
-    rhs.sz = 0;
+    steal_storage(rhs);
 }
 
 // cpy=
-template <typename T>
-sllist<T>& sllist<T>::operator=(const sllist &rhs)
+template <typename T, typename Allocator>
+sllist<T, Allocator>& sllist<T, Allocator>::operator=(const sllist &rhs)
 {
     if(this != &rhs)
     {
+        reset_cursor();
+
+        if constexpr (node_traits::propagate_on_container_copy_assignment::value)
+        {
+            // slabs owned by our allocator have to be released through it before it is replaced
+            if(!node_traits::is_always_equal::value && alloc != rhs.alloc)
+            {
+                free_nodes();
+                head = tail = nullptr;
+                sz = 0;
+                release_slabs();
+            }
+            alloc = rhs.alloc;
+        }
+
+        // copy assign over the nodes we already have, allocate only for the rest
         Node<T> *current_node = head;
-        while(current_node != nullptr)
+        Node<T> *last_node = nullptr;
+        Node<T> *rhs_node = rhs.head;
+        size_t assigned = 0;
+
+        if constexpr (std::is_copy_assignable_v<T>)
         {
-            Node<T> *next_node = current_node->next;
-            delete current_node;
-            current_node = next_node;
+            for(; current_node && rhs_node; ++assigned)
+            {
+                current_node->data = rhs_node->data;
+                last_node = current_node;
+                current_node = current_node->next;
+                rhs_node = rhs_node->next;
+            }
         }
 
-        head = nullptr;
-        sz = 0;
+        // our nodes past the length of rhs
+        if(last_node)
+        {
+            last_node->next = nullptr;
+        }
+        else
+        {
+            head = nullptr;
+        }
+        tail = last_node;
+        sz = assigned;
+        destroy_chain(current_node);
+
+        reserve(rhs.sz);
 
-        current_node = rhs.head;
-        while(current_node)
+        for(; rhs_node; rhs_node = rhs_node->next)
         {
-            push_back(current_node->data);
-            current_node = current_node->next;
+            push_back(rhs_node->data);
         }
     }
 
@@ -191,109 +606,262 @@ sllist<T>& sllist<T>::operator=(const sllist &rhs)
 }
 
 // move=
-template <typename T>
-sllist<T>& sllist<T>::operator=(sllist &&rhs) noexcept
+template <typename T, typename Allocator>
+sllist<T, Allocator>& sllist<T, Allocator>::operator=(sllist &&rhs)
+    noexcept(node_traits::propagate_on_container_move_assignment::value || node_traits::is_always_equal::value)
 {
     if(this != &rhs)
     {
-        Node<T> *current_node = head;
-        while(current_node != nullptr)
+        free_nodes();
+
+        head = tail = nullptr;
+        sz = 0;
+
+        if constexpr (!node_traits::propagate_on_container_move_assignment::value && !node_traits::is_always_equal::value)
         {
-            Node<T> *next_node = current_node->next;
-            delete current_node;
-            current_node = next_node;
+            // rhs nodes belong to a different allocator, we can only move the elements one by one
+            if(alloc != rhs.alloc)
+            {
+                for(Node<T> *current_node = rhs.head; current_node; current_node = current_node->next)
+                {
+                    push_back(std::move(current_node->data));
+                }
+                return *this;
+            }
         }
 
-        head = rhs.head;
-        sz = rhs.sz;
+        release_slabs();
+
+        if constexpr (node_traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
 
-        rhs.head = nullptr;
-        rhs.sz = 0;
+        steal_storage(rhs);
     }
 
     return *this;
 }
 
-// op []
-template <typename T>
-T& sllist<T>::operator[](size_t index)
+template <typename T, typename Allocator>
+Node<T>* sllist<T, Allocator>::find_node(size_t index) const
 {
+    if(index == sz - 1)
+    {
+        return tail;
+    }
+
     Node<T> *current_node = head;
-    size_t current_index = index;
-    while(current_node != nullptr)
+    size_t current_index = 0;
+    if(cursor_node && cursor_index <= index)
+    {
+        current_node = cursor_node;
+        current_index = cursor_index;
+    }
+
+    for(; current_index != index; ++current_index)
     {
-        if(current_index == 0)
-        {
-            return current_node->data;
-        }
         current_node = current_node->next;
-        --current_index;
     }
-    #ifdef ADSTL_THROWABLE
-    throw std::out_of_range("Index:" + std::to_string(index) + " is out of range");
-    #endif
+    return current_node;
+}
+
+template <typename T, typename Allocator>
+Node<T>* sllist<T, Allocator>::seek(size_t index)
+{
+    cursor_node = find_node(index);
+    cursor_index = index;
+    return cursor_node;
 }
 
 // op []
-template <typename T>
-const T& sllist<T>::operator[](size_t index) const
+template <typename T, typename Allocator>
+T& sllist<T, Allocator>::operator[](size_t index)
 {
-    Node<T> *current_node = head;
-    size_t current_index = index;
-    while(current_node != nullptr)
+    if(index >= sz) ADSTL_UNLIKELY
+    {
+        ADSTL_FAIL(std::out_of_range("Index:" + std::to_string(index) + " is out of range"));
+    }
+    return seek(index)->data;
+}
+
+// op []
+template <typename T, typename Allocator>
+const T& sllist<T, Allocator>::operator[](size_t index) const
+{
+    if(index >= sz) ADSTL_UNLIKELY
+    {
+        ADSTL_FAIL(std::out_of_range("Index:" + std::to_string(index) + " is out of range"));
+    }
+    return find_node(index)->data;
+}
+
+template <typename T, typename Allocator>
+expected<T&> sllist<T, Allocator>::try_at(size_t index)
+{
+    if(index < sz) ADSTL_LIKELY
+    {
+        return seek(index)->data;
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator>
+expected<const T&> sllist<T, Allocator>::try_at(size_t index) const
+{
+    if(index < sz) ADSTL_LIKELY
     {
-        if(current_index == 0)
+        return find_node(index)->data;
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator>
+sllist<T, Allocator>::~sllist()
+{
+    // nodes are not recycled, the whole slabs are given back
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+        for(Node<T> *current_node = head; current_node != nullptr;)
         {
-            return current_node->data;
+            Node<T> *next_node = current_node->next;
+            current_node->~Node();
+            current_node = next_node;
         }
-        current_node = current_node->next;
-        --current_index;
     }
-    #ifdef ADSTL_THROWABLE
-    throw std::out_of_range("Index:" + std::to_string(index) + " is out of range");
-    #endif
+    head = tail = nullptr;
+
+    release_slabs();
 }
 
-template <typename T>
-sllist<T>::~sllist()
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::swap(sllist &rhs) noexcept
 {
-    Node<T> *current_node = head;
-    while(current_node != nullptr)
+    if constexpr (node_traits::propagate_on_container_swap::value)
     {
-        Node<T> *next_node = current_node->next;
-        delete current_node;
-        current_node = next_node;
+        using std::swap;
+        swap(alloc, rhs.alloc);
     }
-    head = nullptr;
+
+    std::swap(head, rhs.head);
+    std::swap(tail, rhs.tail);
+    std::swap(sz, rhs.sz);
+    std::swap(cursor_node, rhs.cursor_node);
+    std::swap(cursor_index, rhs.cursor_index);
+    std::swap(slabs, rhs.slabs);
+    std::swap(rewound, rhs.rewound);
+    std::swap(slab_cursor, rhs.slab_cursor);
+    std::swap(slab_end, rhs.slab_end);
+    std::swap(free_list, rhs.free_list);
+    std::swap(free_tail, rhs.free_tail);
+    std::swap(cap, rhs.cap);
 }
 
-template <typename T>
+template <typename T, typename Allocator>
 template <typename U>
-void sllist<T>::push_back(U &&data)
+void sllist<T, Allocator>::push_back(U &&data)
 {
-    Node<T> *new_node = new Node<T>(std::forward<U>(data));
+    link_back(create_node(std::forward<U>(data)));
+}
 
-    if(head == nullptr)
+template <typename T, typename Allocator>
+template <typename ... Args>
+void sllist<T, Allocator>::emplace_back(Args&& ... args)
+{
+    link_back(create_node(std::forward<Args>(args) ...));
+}
+
+template <typename T, typename Allocator>
+template <typename U>
+void sllist<T, Allocator>::push_front(U &&data)
+{
+    emplace_front(std::forward<U>(data));
+}
+
+template <typename T, typename Allocator>
+template <typename ... Args>
+void sllist<T, Allocator>::emplace_front(Args&& ... args)
+{
+    Node<T> *new_node = create_node(std::forward<Args>(args) ...);
+    new_node->next = head;
+    head = new_node;
+    if(tail == nullptr)
+    {
+        tail = new_node;
+    }
+    ++sz;
+
+    if(cursor_node)
+    {
+        ++cursor_index;
+    }
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::splice_after(const_iterator pos, sllist &&rhs)
+{
+    if(this == &rhs || rhs.head == nullptr)
     {
-        head = new_node;
-        ++sz;
         return;
     }
 
-    Node<T> *tmp_node = head;
-    while(tmp_node->next)
+    Node<T> *prev_node = pos.it ? pos.it : tail;
+    reset_cursor();
+
+    if constexpr (!node_traits::is_always_equal::value)
+    {
+        // rhs nodes belong to a different allocator, we can only move the elements one by one
+        if(alloc != rhs.alloc)
+        {
+            for(Node<T> *current_node = rhs.head; current_node; current_node = current_node->next)
+            {
+                Node<T> *new_node = create_node(std::move(current_node->data));
+                if(prev_node)
+                {
+                    new_node->next = prev_node->next;
+                    prev_node->next = new_node;
+                }
+                else
+                {
+                    head = new_node;
+                }
+                if(prev_node == tail)
+                {
+                    tail = new_node;
+                }
+                prev_node = new_node;
+                ++sz;
+            }
+            rhs.clear();
+            return;
+        }
+    }
+
+    adopt_storage(rhs);
+
+    if(prev_node)
+    {
+        rhs.tail->next = prev_node->next;
+        prev_node->next = rhs.head;
+    }
+    else
+    {
+        head = rhs.head;
+    }
+
+    if(prev_node == tail)
     {
-        tmp_node = tmp_node->next;
+        tail = rhs.tail;
     }
 
-    tmp_node->next = new_node;
+    sz += rhs.sz;
 
-    ++sz;
+    rhs.head = rhs.tail = nullptr;
+    rhs.sz = 0;
+    rhs.reset_cursor();
 }
 
-template <typename T>
+template <typename T, typename Allocator>
 template <typename U>
-void sllist<T>::insert(size_t position, U &&data)
+void sllist<T, Allocator>::insert(size_t position, U &&data)
 {
     if(position > sz)
     {
@@ -305,27 +873,38 @@ void sllist<T>::insert(size_t position, U &&data)
 
     if(position == 0)
     {
-        Node<T>* new_node = new Node<T>(std::forward<U>(data));
-        new_node->next = head;
-        head = new_node;
-        ++sz;
+        emplace_front(std::forward<U>(data));
         return;
     }
-
-    Node<T>* current_node = head;
-    for(size_t i = 1; i < position; ++i)
+    else if(position == sz)
     {
-        current_node = current_node->next;
+        push_back(std::forward<U>(data));
+        return;
     }
 
-    Node<T>* new_node = new Node<T>(std::forward<U>(data));
+    // nodes up to position - 1 keep their index, the cursor can stay on the predecessor
+    Node<T>* current_node = seek(position - 1);
+
+    Node<T>* new_node = create_node(std::forward<U>(data));
     new_node->next = current_node->next;
     current_node->next = new_node;
     ++sz;
 }
 
-template <typename T>
-void sllist<T>::pop_back()
+template <typename T, typename Allocator>
+template <typename U>
+expected<void> sllist<T, Allocator>::try_insert(size_t position, U &&data)
+{
+    if(position <= sz) ADSTL_LIKELY
+    {
+        insert(position, std::forward<U>(data));
+        return {};
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::pop_back()
 {
     if(head == nullptr)
     {    
@@ -333,49 +912,49 @@ void sllist<T>::pop_back()
     }
     else if(head->next == nullptr)
     {
-        delete head;
-        head = nullptr;
+        destroy_node(head);
+        head = tail = nullptr;
         --sz;
+        reset_cursor();
         return;
     }
     else
     {
-        Node<T> *current_node = head;
-        while(current_node->next->next)
+        if(cursor_node == tail)
         {
-            current_node = current_node->next;
+            reset_cursor();
         }
 
-        delete current_node->next;
+        Node<T> *current_node = find_node(sz - 2);
+
+        destroy_node(current_node->next);
         current_node->next = nullptr;
+        tail = current_node;
         --sz;
     }
 }
 
-template <typename T>
-void sllist<T>::clear()
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::clear()
 {
     if(head == nullptr)
         return;
 
-    Node<T> *current_node = head;
-    while(current_node != nullptr)
-    {   
-        Node<T> *next_node = current_node->next;
-        delete current_node;
-        current_node = next_node;
-    }
-    head = nullptr;
+    free_nodes();
+    head = tail = nullptr;
     sz = 0;
 }
 
-template <typename T>
-void sllist<T>::reverse()
+template <typename T, typename Allocator>
+void sllist<T, Allocator>::reverse()
 {
     Node<T> *prev_node = nullptr;
     Node<T> *current_node = head;
     Node<T> *next_node = nullptr;
 
+    tail = head;
+    reset_cursor();
+
     while(current_node != nullptr)
     {
         next_node = current_node->next;
@@ -0,0 +1,22 @@
+/* 
+    SMALL VECTOR
+*/
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include "vector.hpp"
+
+namespace adstl
+{
+
+// Vector that keeps its first N elements inside the object and touches the allocator only
+// when it grows past N. It is an adstl::vector with an inline buffer, so it has the same
+// iterators, emplace, insert and bulk operations. Moving or swapping a small_vector whose
+// elements are still inline relocates them instead of stealing a pointer.
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = geometric_growth<2, 1>>
+using small_vector = vector<T, Allocator, GrowthPolicy, N>;
+
+}
+
+#endif
@@ -7,25 +7,43 @@
 
 #include <iostream>
 #include "vector.hpp"
+#include "small_vector.hpp"
+#include "segmented_vector.hpp"
+#include "serialize.hpp"
+#include "expected.hpp"
 #include "config.hpp" // Include the configuration header
 
 namespace adstl
 {
 
-template <typename T> class stack;
-template <typename T> std::ostream& operator<<(std::ostream&, const stack<T>&);
+template <typename T, typename Allocator = std::allocator<T>, typename Container = vector<T, Allocator>> class stack;
+template <typename T, typename Allocator, typename Container> std::ostream& operator<<(std::ostream&, const stack<T, Allocator, Container>&);
 
-template <typename T>
+// stack with no allocation until it grows past N elements
+template <typename T, size_t N, typename Allocator = std::allocator<T>>
+using small_stack = stack<T, Allocator, small_vector<T, N, Allocator>>;
+
+// stack that never relocates its elements, push/pop are O(1) in the worst case
+// and references to elements stay valid while they are on the stack
+template <typename T, typename Allocator = std::allocator<T>>
+using segmented_stack = stack<T, Allocator, segmented_vector<T, Allocator>>;
+
+// Container needs push_back, pop_back, back, size, get_allocator and a constructor taking
+// the allocator, adstl::vector, adstl::small_vector and adstl::segmented_vector all fit.
+template <typename T, typename Allocator, typename Container>
 class stack final
 {
 
-    friend std::ostream& operator<< <T> (std::ostream&, const stack<T>&);
+    friend std::ostream& operator<< <T, Allocator, Container> (std::ostream&, const stack<T, Allocator, Container>&);
 
     public:
 
         using s_type = T;
+        using allocator_type = Allocator;
+        using container_type = Container;
 
         stack() : data() {} // def ctor
+        explicit stack(const Allocator &a) : data(a) {}
         stack(const stack&); // cpy ctor
         stack(stack&&); // move ctor
 
@@ -37,54 +55,63 @@ class stack final
         T& top();
         const T& top() const;
         bool empty() const;
+
+        // no exceptions, errc::empty on an empty stack, try_pop moves the top out
+        expected<T&> try_top();
+        expected<const T&> try_top() const;
+        expected<T> try_pop();
         size_t size() const;
+        allocator_type get_allocator() const { return data.get_allocator(); }
 
+        // binary checkpoint of a stack of trivially copyable T, see serialize.hpp
+        bool dump(std::ostream &os) const { return save_binary(os, data); }
+        bool restore(std::istream &is) { return load_binary(is, data); }
         
 
     private:
-        vector<T> data;
+        Container data;
 };
 
-template <typename T>
-std::ostream& operator<<(std::ostream &os, const stack<T> &stack)
+template <typename T, typename Allocator, typename Container>
+std::ostream& operator<<(std::ostream &os, const stack<T, Allocator, Container> &stack)
 {
     os << stack.data;
     return os;
 }
 
 // cpy ctor
-template <typename T>
-stack<T>::stack(const stack &rhs) : data(rhs.data) {}
+template <typename T, typename Allocator, typename Container>
+stack<T, Allocator, Container>::stack(const stack &rhs) : data(rhs.data) {}
 
 // move ctor
-template <typename T>
-stack<T>::stack(stack &&rhs) : data(std::move(rhs.data)) {}
+template <typename T, typename Allocator, typename Container>
+stack<T, Allocator, Container>::stack(stack &&rhs) : data(std::move(rhs.data)) {}
 
 // cpy=
-template <typename T>
-stack<T>& stack<T>::operator=(const stack& rhs)
+template <typename T, typename Allocator, typename Container>
+stack<T, Allocator, Container>& stack<T, Allocator, Container>::operator=(const stack& rhs)
 {
     data = rhs.data;
     return *this;
 }
 
 // move=
-template <typename T>
-stack<T>& stack<T>::operator=(stack &&rhs)
+template <typename T, typename Allocator, typename Container>
+stack<T, Allocator, Container>& stack<T, Allocator, Container>::operator=(stack &&rhs)
 {
     data = std::move(rhs.data);
     return *this;
 }
 
-template <typename T>
+template <typename T, typename Allocator, typename Container>
 template <typename U>
-void stack<T>::push(U &&element)
+void stack<T, Allocator, Container>::push(U &&element)
 {
     data.push_back(std::forward<U>(element));
 }
 
-template <typename T>
-void stack<T>::pop()
+template <typename T, typename Allocator, typename Container>
+void stack<T, Allocator, Container>::pop()
 {
     if(data.size())
     {
@@ -98,38 +125,66 @@ void stack<T>::pop()
     #endif
 }
 
-template <typename T>
-T& stack<T>::top()
+template <typename T, typename Allocator, typename Container>
+T& stack<T, Allocator, Container>::top()
 {
-    if(data.size())
+    if(data.size()) ADSTL_LIKELY
     {
-        return data[data.size() - 1];
+        return data.back();
     }
-    #ifdef ADSTL_THROWABLE
-    throw std::out_of_range("stack::top: stack is empty.");
-    #endif
+    ADSTL_FAIL(std::out_of_range("stack::top: stack is empty."));
 }
 
-template <typename T>
-const T& stack<T>::top() const
+template <typename T, typename Allocator, typename Container>
+const T& stack<T, Allocator, Container>::top() const
 {
-    if(data.size())
+    if(data.size()) ADSTL_LIKELY
     {
-        return data[data.size() - 1];
+        return data.back();
     }
-    #ifdef ADSTL_THROWABLE
-    throw std::out_of_range("stack::top: stack is empty.");
-    #endif
+    ADSTL_FAIL(std::out_of_range("stack::top: stack is empty."));
+}
+
+template <typename T, typename Allocator, typename Container>
+expected<T&> stack<T, Allocator, Container>::try_top()
+{
+    if(data.size()) ADSTL_LIKELY
+    {
+        return data.back();
+    }
+    return unexpected(errc::empty);
+}
+
+template <typename T, typename Allocator, typename Container>
+expected<const T&> stack<T, Allocator, Container>::try_top() const
+{
+    if(data.size()) ADSTL_LIKELY
+    {
+        return data.back();
+    }
+    return unexpected(errc::empty);
+}
+
+template <typename T, typename Allocator, typename Container>
+expected<T> stack<T, Allocator, Container>::try_pop()
+{
+    if(data.size()) ADSTL_LIKELY
+    {
+        expected<T> top(std::move(data.back()));
+        data.pop_back();
+        return top;
+    }
+    return unexpected(errc::empty);
 }
 
-template <typename T>
-bool stack<T>::empty() const
+template <typename T, typename Allocator, typename Container>
+bool stack<T, Allocator, Container>::empty() const
 {
     return data.size() == 0;
 }
 
-template <typename T>
-size_t stack<T>::size() const
+template <typename T, typename Allocator, typename Container>
+size_t stack<T, Allocator, Container>::size() const
 {
     return data.size();
 }
@@ -0,0 +1,298 @@
+/*
+    THREAD POOL
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "expected.hpp"
+
+namespace adstl
+{
+
+// Work-stealing thread pool.
+//
+// Every worker owns a deque. A worker pushes and pops its own tasks at the back (newest
+// first, so nested fork-join work stays cache hot) and steals from the front of the other
+// deques when it runs dry. Tasks submitted from outside the pool are spread round robin.
+//
+// Threads waiting on a task_group run queued tasks instead of blocking, so tasks can fork
+// and join recursively without running out of workers.
+class thread_pool final
+{
+    public:
+
+        explicit thread_pool(size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency()));
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+        ~thread_pool();
+
+        size_t size() const { return workers.size(); }
+
+        // runs f on some worker, fire and forget
+        template <typename F> void submit(F&&);
+
+        // runs one queued task on the calling thread, false when there was nothing to run
+        bool run_pending_task();
+
+        // shared pool used by the parallel algorithms, sized to the hardware
+        static thread_pool& default_pool()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+
+        // fork-join scope: run() forks tasks, wait() joins them and rethrows the first exception
+        class task_group final
+        {
+            public:
+
+                explicit task_group(thread_pool &pool = default_pool()) : pool(pool), pending(0), error(), error_mutex() {}
+                task_group(const task_group&) = delete;
+                task_group& operator=(const task_group&) = delete;
+                ~task_group() { join(); }
+
+                template <typename F> void run(F&&);
+                void wait();
+
+            private:
+                void join();
+
+                thread_pool &pool;
+                std::atomic<size_t> pending;
+                std::exception_ptr error;
+                std::mutex error_mutex;
+        };
+
+    private:
+
+        using task = std::function<void()>;
+
+        struct alignas(64) worker_queue
+        {
+            std::mutex mutex;
+            std::deque<task> tasks;
+        };
+
+        void worker_loop(size_t);
+        void push(task&&);
+        bool pop(size_t, task&);
+
+        // index of the calling thread in this pool, size() for threads outside of it
+        size_t current_index() const;
+
+        static thread_local const thread_pool *current_pool;
+        static thread_local size_t current_worker;
+
+        std::vector<std::unique_ptr<worker_queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::atomic<size_t> queued;
+        std::atomic<size_t> next_queue;
+        std::atomic<bool> stopping;
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_cv;
+};
+
+inline thread_local const thread_pool *thread_pool::current_pool = nullptr;
+inline thread_local size_t thread_pool::current_worker = 0;
+
+inline thread_pool::thread_pool(size_t threads) : queues(), workers(), queued(0), next_queue(0), stopping(false), sleep_mutex(), sleep_cv()
+{
+    if(threads == 0)
+    {
+        threads = 1;
+    }
+
+    queues.reserve(threads);
+    for(size_t i = 0; i != threads; ++i)
+    {
+        queues.push_back(std::make_unique<worker_queue>());
+    }
+
+    workers.reserve(threads);
+    for(size_t i = 0; i != threads; ++i)
+    {
+        workers.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+inline thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping.store(true, std::memory_order_relaxed);
+    }
+    sleep_cv.notify_all();
+
+    for(std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+template <typename F>
+void thread_pool::submit(F &&f)
+{
+    push(task(std::forward<F>(f)));
+}
+
+inline void thread_pool::push(task &&t)
+{
+    size_t index = current_index();
+    if(index == size())
+    {
+        index = next_queue.fetch_add(1, std::memory_order_relaxed) % size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(t));
+    }
+    queued.fetch_add(1, std::memory_order_release);
+
+    // taking the lock orders this against a worker that is about to fall asleep
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    sleep_cv.notify_one();
+}
+
+// own queue from the back, the others from the front
+inline bool thread_pool::pop(size_t index, task &out)
+{
+    if(queued.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    const size_t n = size();
+    for(size_t k = 0; k != n; ++k)
+    {
+        size_t victim = (index + k) % n;
+        worker_queue &q = *queues[victim];
+
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(q.tasks.empty())
+        {
+            continue;
+        }
+
+        if(victim == index)
+        {
+            out = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+        else
+        {
+            out = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+inline bool thread_pool::run_pending_task()
+{
+    size_t index = current_index();
+    task t;
+    if(!pop(index == size() ? 0 : index, t))
+    {
+        return false;
+    }
+
+    t();
+    return true;
+}
+
+inline size_t thread_pool::current_index() const
+{
+    return current_pool == this ? current_worker : size();
+}
+
+inline void thread_pool::worker_loop(size_t index)
+{
+    current_pool = this;
+    current_worker = index;
+
+    task t;
+    for(;;)
+    {
+        if(pop(index, t))
+        {
+            t();
+            t = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleep_cv.wait(lock, [this] { return stopping.load(std::memory_order_relaxed) || queued.load(std::memory_order_acquire) != 0; });
+        if(stopping.load(std::memory_order_relaxed) && queued.load(std::memory_order_acquire) == 0)
+        {
+            return;
+        }
+    }
+}
+
+template <typename F>
+void thread_pool::task_group::run(F &&f)
+{
+    pending.fetch_add(1, std::memory_order_relaxed);
+    pool.push([this, f = std::forward<F>(f)]() mutable {
+        ADSTL_TRY
+        {
+            f();
+        }
+        ADSTL_CATCH_ALL
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if(!error)
+            {
+                error = std::current_exception();
+            }
+        }
+        pending.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+inline void thread_pool::task_group::join()
+{
+    while(pending.load(std::memory_order_acquire) != 0)
+    {
+        if(!pool.run_pending_task())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline void thread_pool::task_group::wait()
+{
+    join();
+
+    if(error)
+    {
+        std::exception_ptr e = std::move(error);
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+/* 
+    TYPE TRAITS
+*/
+
+#ifndef TYPE_TRAITS_H
+#define TYPE_TRAITS_H
+
+#include <iterator>
+#include <type_traits>
+
+namespace adstl
+{
+
+// A type is trivially relocatable when moving an object to a new address and
+// forgetting the old one is the same as copying its bytes. Every trivially copyable
+// type is, and user types that only own resources through pointers can opt in:
+//
+//     template <> struct adstl::is_trivially_relocatable<Foo> : std::true_type {};
+//
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Iterator category of It, iterators without std::iterator_traits (like the sllist and
+// segmented_vector iterators) are treated as multi-pass forward iterators.
+template <typename It, typename = void>
+struct iterator_category_of
+{
+    using type = std::forward_iterator_tag;
+};
+
+template <typename It>
+struct iterator_category_of<It, std::void_t<typename std::iterator_traits<It>::iterator_category>>
+{
+    using type = typename std::iterator_traits<It>::iterator_category;
+};
+
+template <typename It>
+inline constexpr bool is_input_only_iterator_v = 
+    std::is_same_v<typename iterator_category_of<It>::type, std::input_iterator_tag>;
+
+template <typename It>
+inline constexpr bool is_random_access_iterator_v = 
+    std::is_base_of_v<std::random_access_iterator_tag, typename iterator_category_of<It>::type>;
+
+}
+
+#endif
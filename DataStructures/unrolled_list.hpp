@@ -0,0 +1,695 @@
+/*
+    UNROLLED LINKED LIST
+*/
+
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "config.hpp" // Include the configuration header
+#include "format.hpp"
+#include "expected.hpp"
+#include "instrumentation.hpp"
+#include "type_traits.hpp"
+
+namespace adstl
+{
+
+// elements per block: a block with its links fills four cache lines, but big elements get at
+// least 8 per block, fewer leave little to skip and no longer pay for the splits
+template <typename T>
+inline constexpr size_t default_unrolled_block_size =
+    sizeof(T) * 8 + 3 * sizeof(void*) < 256 ? (256 - 3 * sizeof(void*)) / sizeof(T) : 8;
+
+template <typename T, typename Allocator = std::allocator<T>, size_t BlockSize = default_unrolled_block_size<T>> class unrolled_list;
+template <typename T, typename Allocator, size_t BlockSize> std::ostream& operator<<(std::ostream&, const unrolled_list<T, Allocator, BlockSize>&);
+
+// List with the interface of sllist that stores up to BlockSize elements per node.
+// Iteration reads every block front to back, operator[] and insert skip whole blocks,
+// so a walk touches n / BlockSize nodes instead of n. Inserting into a full block splits
+// it in two halves.
+//
+// Elements are moved around inside their block, references and iterators to elements that
+// stay in the list are invalidated by:
+//   - insert, try_insert: the elements behind the position in its block shift up by one,
+//     splitting a full block moves its upper half into a new block
+//   - push_front, emplace_front: while the first block has room all of its elements shift up
+//   - reverse: every element trades places with its mirror image
+// push_back, emplace_back and pop_back leave the other elements in place (end() changes),
+// clear and assignment invalidate everything, swap and the move constructor nothing.
+template <typename T, typename Allocator, size_t BlockSize>
+class unrolled_list final
+{
+
+    static_assert(BlockSize > 1, "unrolled_list: blocks have to hold at least two elements");
+
+    friend std::ostream& operator<< <T, Allocator, BlockSize> (std::ostream&, const unrolled_list<T, Allocator, BlockSize>&);
+
+    struct block
+    {
+        T* data() { return reinterpret_cast<T*>(storage); }
+
+        block *prev;
+        block *next;
+        size_t count;
+        alignas(T) unsigned char storage[BlockSize * sizeof(T)];
+    };
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using block_allocator = typename alloc_traits::template rebind_alloc<block>;
+    using block_traits = std::allocator_traits<block_allocator>;
+
+    private:
+        class iterator;
+        class const_iterator;
+
+    public:
+
+        using l_type = T;
+        using allocator_type = Allocator;
+        using iterator = iterator;
+        using const_iterator = const_iterator;
+
+        static constexpr size_t block_size = BlockSize;
+
+        unrolled_list() : unrolled_list(Allocator()) {} // def ctor
+        explicit unrolled_list(const Allocator &a) : alloc(a), head(nullptr), tail(nullptr), sz(0) {}
+        unrolled_list(const unrolled_list&); // cpy ctor
+        unrolled_list(unrolled_list&&) noexcept; // move ctor
+        ~unrolled_list(); // dctor
+
+        unrolled_list& operator=(const unrolled_list&); // cpy=
+        unrolled_list& operator=(unrolled_list&&)
+            noexcept(block_traits::propagate_on_container_move_assignment::value || block_traits::is_always_equal::value); // move=
+
+        allocator_type get_allocator() const { return allocator_type(alloc); }
+        void swap(unrolled_list&) noexcept;
+
+        // walks the blocks from the closer end, O(n / BlockSize)
+        T& operator[](size_t);
+        const T& operator[](size_t) const;
+        // no exceptions, errc::out_of_range past the end
+        expected<T&> try_at(size_t);
+        expected<const T&> try_at(size_t) const;
+
+        // undefined on an empty list
+        T& front() { return head->data()[0]; }
+        const T& front() const { return head->data()[0]; }
+        T& back() { return tail->data()[tail->count - 1]; }
+        const T& back() const { return tail->data()[tail->count - 1]; }
+
+        // iterator interface
+        iterator begin() { return iterator(head, 0); }
+        iterator end() { return iterator(tail, tail ? tail->count : 0); }
+        const_iterator cbegin() const { return const_iterator(head, 0); }
+        const_iterator cend() const { return const_iterator(tail, tail ? tail->count : 0); }
+
+        size_t size() const { return sz; }
+        bool empty() const { return sz == 0; }
+
+        template <typename U> void push_back(U&&);
+        template <typename ... Args> void emplace_back(Args&& ...);
+        template <typename U> void push_front(U&&);
+        template <typename ... Args> void emplace_front(Args&& ...);
+        void pop_back();
+        void clear();
+
+        // inserts before position, position == size() appends
+        template <typename U> void insert(size_t, U&&);
+        template <typename U> expected<void> try_insert(size_t, U&&); // errc::out_of_range when position > size()
+        void reverse();
+
+    private:
+
+        class iterator
+        {
+            public:
+                iterator(block *blk, size_t index) : blk(blk), index(index) {}
+
+                T& operator*() const
+                {
+                    return blk->data()[index];
+                }
+
+                iterator& operator++()
+                {
+                    // the position past the last element of a block is the end only for the tail
+                    if(++index == blk->count && blk->next)
+                    {
+                        blk = blk->next;
+                        index = 0;
+                    }
+                    return *this;
+                }
+
+                bool operator!=(const iterator &rhs) const
+                {
+                    return blk != rhs.blk || index != rhs.index;
+                }
+
+            private:
+                block *blk;
+                size_t index;
+        };
+
+        class const_iterator
+        {
+            public:
+                const_iterator(block *blk, size_t index) : blk(blk), index(index) {}
+
+                const T& operator*() const
+                {
+                    return blk->data()[index];
+                }
+
+                const_iterator& operator++()
+                {
+                    if(++index == blk->count && blk->next)
+                    {
+                        blk = blk->next;
+                        index = 0;
+                    }
+                    return *this;
+                }
+
+                bool operator!=(const const_iterator &rhs) const
+                {
+                    return blk != rhs.blk || index != rhs.index;
+                }
+
+            private:
+                block *blk;
+                size_t index;
+        };
+
+        block* new_block();
+        void link_after(block*, block*) noexcept; // links the second block after the first, nullptr makes it the head
+        void unlink(block*) noexcept;
+        void split(block*); // moves the upper half of a full block into a new block after it
+        template <typename ... Args> void construct_in(block*, size_t, Args&& ...);
+        template <typename ... Args> void emplace_at(size_t, Args&& ...);
+        block* locate(size_t&) const; // block holding index, index becomes the offset in it
+        void destroy_all() noexcept;
+        void steal(unrolled_list&) noexcept;
+
+        block_allocator alloc;
+        block *head;
+        block *tail;
+        size_t sz;
+};
+
+template <typename T, typename Allocator, size_t BlockSize>
+std::ostream& operator<<(std::ostream &os, const unrolled_list<T, Allocator, BlockSize> &rhs)
+{
+    return format_range(os, rhs.cbegin(), rhs.cend());
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+typename unrolled_list<T, Allocator, BlockSize>::block* unrolled_list<T, Allocator, BlockSize>::new_block()
+{
+    block *blk = block_traits::allocate(alloc, 1);
+    ADSTL_COUNT(unrolled_list, allocations, 1);
+    ADSTL_COUNT(unrolled_list, bytes_allocated, sizeof(block));
+    blk->prev = blk->next = nullptr;
+    blk->count = 0;
+    return blk;
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::link_after(block *pos, block *blk) noexcept
+{
+    blk->prev = pos;
+    blk->next = pos ? pos->next : head;
+
+    if(blk->next)
+    {
+        blk->next->prev = blk;
+    }
+    else
+    {
+        tail = blk;
+    }
+
+    if(pos)
+    {
+        pos->next = blk;
+    }
+    else
+    {
+        head = blk;
+    }
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::unlink(block *blk) noexcept
+{
+    (blk->prev ? blk->prev->next : head) = blk->next;
+    (blk->next ? blk->next->prev : tail) = blk->prev;
+    block_traits::deallocate(alloc, blk, 1);
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::split(block *blk)
+{
+    block *upper = new_block();
+
+    constexpr size_t keep = BlockSize / 2;
+    T *src = blk->data() + keep;
+    T *dest = upper->data();
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), (BlockSize - keep) * sizeof(T));
+    }
+    else
+    {
+        // the source stays intact until every element is in the new block
+        size_t i = 0;
+        ADSTL_TRY
+        {
+            for(; i != BlockSize - keep; ++i)
+            {
+                ::new (static_cast<void*>(dest + i)) T(std::move_if_noexcept(src[i]));
+            }
+        }
+        ADSTL_CATCH_ALL
+        {
+            while(i)
+            {
+                dest[--i].~T();
+            }
+            block_traits::deallocate(alloc, upper, 1);
+            ADSTL_RETHROW;
+        }
+
+        for(i = 0; i != BlockSize - keep; ++i)
+        {
+            src[i].~T();
+        }
+    }
+
+    ADSTL_COUNT(unrolled_list, elements_moved, BlockSize - keep);
+    upper->count = BlockSize - keep;
+    blk->count = keep;
+    link_after(blk, upper);
+}
+
+// constructs the element at offset index of a block that is not full
+template <typename T, typename Allocator, size_t BlockSize>
+template <typename ... Args>
+void unrolled_list<T, Allocator, BlockSize>::construct_in(block *blk, size_t index, Args&& ... args)
+{
+    T *p = blk->data();
+    size_t count = blk->count;
+
+    if(index == count)
+    {
+        ::new (static_cast<void*>(p + index)) T(std::forward<Args>(args) ...);
+    }
+    else if constexpr (is_trivially_relocatable_v<T>)
+    {
+        // args may refer to an element of this block, build the value before opening the gap
+        // with one memmove, then relocate it in
+        alignas(T) unsigned char value[sizeof(T)];
+        ::new (static_cast<void*>(value)) T(std::forward<Args>(args) ...);
+        std::memmove(static_cast<void*>(p + index + 1), static_cast<const void*>(p + index), (count - index) * sizeof(T));
+        std::memcpy(static_cast<void*>(p + index), static_cast<const void*>(value), sizeof(T));
+    }
+    else
+    {
+        T value(std::forward<Args>(args) ...);
+        ::new (static_cast<void*>(p + count)) T(std::move(p[count - 1]));
+        std::move_backward(p + index, p + count - 1, p + count);
+        p[index] = std::move(value);
+    }
+
+    ++blk->count;
+    ++sz;
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+typename unrolled_list<T, Allocator, BlockSize>::block* unrolled_list<T, Allocator, BlockSize>::locate(size_t &index) const
+{
+    if(index < sz / 2)
+    {
+        block *blk = head;
+        while(index >= blk->count)
+        {
+            index -= blk->count;
+            blk = blk->next;
+        }
+        return blk;
+    }
+
+    size_t from_back = sz - index;
+    block *blk = tail;
+    while(from_back > blk->count)
+    {
+        from_back -= blk->count;
+        blk = blk->prev;
+    }
+    index = blk->count - from_back;
+    return blk;
+}
+
+// inserts before the element at position < sz
+template <typename T, typename Allocator, size_t BlockSize>
+template <typename ... Args>
+void unrolled_list<T, Allocator, BlockSize>::emplace_at(size_t position, Args&& ... args)
+{
+    size_t index = position;
+    block *blk = locate(index);
+
+    if(blk->count == BlockSize)
+    {
+        if(index == 0 && blk->prev && blk->prev->count != BlockSize)
+        {
+            // the previous block has room at its end, nothing has to move
+            blk = blk->prev;
+            index = blk->count;
+        }
+        else
+        {
+            // args may refer to an element the split moves
+            T value(std::forward<Args>(args) ...);
+            split(blk);
+            if(index > blk->count)
+            {
+                index -= blk->count;
+                blk = blk->next;
+            }
+            construct_in(blk, index, std::move(value));
+            return;
+        }
+    }
+
+    construct_in(blk, index, std::forward<Args>(args) ...);
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::destroy_all() noexcept
+{
+    block *blk = head;
+    while(blk)
+    {
+        block *next = blk->next;
+
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            for(size_t i = 0; i != blk->count; ++i)
+            {
+                blk->data()[i].~T();
+            }
+        }
+
+        block_traits::deallocate(alloc, blk, 1);
+        blk = next;
+    }
+
+    head = tail = nullptr;
+    sz = 0;
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::steal(unrolled_list &rhs) noexcept
+{
+    head = rhs.head;
+    tail = rhs.tail;
+    sz = rhs.sz;
+
+    rhs.head = rhs.tail = nullptr;
+    rhs.sz = 0;
+}
+
+// cpy ctor
+template <typename T, typename Allocator, size_t BlockSize>
+unrolled_list<T, Allocator, BlockSize>::unrolled_list(const unrolled_list &rhs)
+    : unrolled_list(Allocator(block_traits::select_on_container_copy_construction(rhs.alloc)))
+{
+    for(const_iterator b = rhs.cbegin(); b != rhs.cend(); ++b)
+    {
+        push_back(*b);
+    }
+}
+
+// move ctor
+template <typename T, typename Allocator, size_t BlockSize>
+unrolled_list<T, Allocator, BlockSize>::unrolled_list(unrolled_list &&rhs) noexcept : alloc(std::move(rhs.alloc))
+{
+    steal(rhs);
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+unrolled_list<T, Allocator, BlockSize>::~unrolled_list()
+{
+    destroy_all();
+}
+
+// cpy=
+template <typename T, typename Allocator, size_t BlockSize>
+unrolled_list<T, Allocator, BlockSize>& unrolled_list<T, Allocator, BlockSize>::operator=(const unrolled_list &rhs)
+{
+    if(this != &rhs)
+    {
+        destroy_all();
+
+        if constexpr (block_traits::propagate_on_container_copy_assignment::value)
+            alloc = rhs.alloc;
+
+        for(const_iterator b = rhs.cbegin(); b != rhs.cend(); ++b)
+        {
+            push_back(*b);
+        }
+    }
+
+    return *this;
+}
+
+// move=
+template <typename T, typename Allocator, size_t BlockSize>
+unrolled_list<T, Allocator, BlockSize>& unrolled_list<T, Allocator, BlockSize>::operator=(unrolled_list &&rhs)
+    noexcept(block_traits::propagate_on_container_move_assignment::value || block_traits::is_always_equal::value)
+{
+    if(this != &rhs)
+    {
+        destroy_all();
+
+        if constexpr (!block_traits::propagate_on_container_move_assignment::value && !block_traits::is_always_equal::value)
+        {
+            // rhs blocks belong to a different allocator, we can only move the elements one by one
+            if(alloc != rhs.alloc)
+            {
+                for(iterator b = rhs.begin(); b != rhs.end(); ++b)
+                {
+                    push_back(std::move(*b));
+                }
+                return *this;
+            }
+        }
+
+        if constexpr (block_traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+
+        steal(rhs);
+    }
+
+    return *this;
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::swap(unrolled_list &rhs) noexcept
+{
+    if constexpr (block_traits::propagate_on_container_swap::value)
+    {
+        using std::swap;
+        swap(alloc, rhs.alloc);
+    }
+
+    std::swap(head, rhs.head);
+    std::swap(tail, rhs.tail);
+    std::swap(sz, rhs.sz);
+}
+
+// op []
+template <typename T, typename Allocator, size_t BlockSize>
+T& unrolled_list<T, Allocator, BlockSize>::operator[](size_t index)
+{
+    if(index >= sz) ADSTL_UNLIKELY
+    {
+        ADSTL_FAIL(std::out_of_range("Index:" + std::to_string(index) + " is out of range"));
+    }
+    block *blk = locate(index);
+    return blk->data()[index];
+}
+
+// op []
+template <typename T, typename Allocator, size_t BlockSize>
+const T& unrolled_list<T, Allocator, BlockSize>::operator[](size_t index) const
+{
+    if(index >= sz) ADSTL_UNLIKELY
+    {
+        ADSTL_FAIL(std::out_of_range("Index:" + std::to_string(index) + " is out of range"));
+    }
+    block *blk = locate(index);
+    return blk->data()[index];
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+template <typename U>
+void unrolled_list<T, Allocator, BlockSize>::push_back(U &&elem)
+{
+    emplace_back(std::forward<U>(elem));
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+template <typename ... Args>
+void unrolled_list<T, Allocator, BlockSize>::emplace_back(Args&& ... args)
+{
+    if(tail && tail->count != BlockSize)
+    {
+        construct_in(tail, tail->count, std::forward<Args>(args) ...);
+        return;
+    }
+
+    // link a new block once the element is in it
+    block *blk = new_block();
+    ADSTL_TRY
+    {
+        construct_in(blk, 0, std::forward<Args>(args) ...);
+    }
+    ADSTL_CATCH_ALL
+    {
+        block_traits::deallocate(alloc, blk, 1);
+        ADSTL_RETHROW;
+    }
+    link_after(tail, blk);
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+template <typename U>
+void unrolled_list<T, Allocator, BlockSize>::push_front(U &&elem)
+{
+    emplace_front(std::forward<U>(elem));
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+template <typename ... Args>
+void unrolled_list<T, Allocator, BlockSize>::emplace_front(Args&& ... args)
+{
+    if(head && head->count != BlockSize)
+    {
+        construct_in(head, 0, std::forward<Args>(args) ...);
+        return;
+    }
+
+    // a full head gets a new block in front instead of being split
+    block *blk = new_block();
+    ADSTL_TRY
+    {
+        construct_in(blk, 0, std::forward<Args>(args) ...);
+    }
+    ADSTL_CATCH_ALL
+    {
+        block_traits::deallocate(alloc, blk, 1);
+        ADSTL_RETHROW;
+    }
+    link_after(nullptr, blk);
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::pop_back()
+{
+    if(sz == 0)
+    {
+        return;
+    }
+
+    tail->data()[--tail->count].~T();
+    --sz;
+
+    if(tail->count == 0)
+    {
+        unlink(tail);
+    }
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::clear()
+{
+    destroy_all();
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+template <typename U>
+void unrolled_list<T, Allocator, BlockSize>::insert(size_t position, U &&elem)
+{
+    if(position > sz)
+    {
+        #ifdef ADSTL_THROWABLE
+        throw std::out_of_range("Inserting on positon:" + std::to_string(position) + " while list have:" + std::to_string(sz) + " elements.");
+        #endif
+        return;
+    }
+
+    if(position == sz)
+    {
+        emplace_back(std::forward<U>(elem));
+        return;
+    }
+
+    emplace_at(position, std::forward<U>(elem));
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+expected<T&> unrolled_list<T, Allocator, BlockSize>::try_at(size_t index)
+{
+    if(index < sz) ADSTL_LIKELY
+    {
+        return (*this)[index];
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+expected<const T&> unrolled_list<T, Allocator, BlockSize>::try_at(size_t index) const
+{
+    if(index < sz) ADSTL_LIKELY
+    {
+        return (*this)[index];
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+template <typename U>
+expected<void> unrolled_list<T, Allocator, BlockSize>::try_insert(size_t position, U &&elem)
+{
+    if(position <= sz) ADSTL_LIKELY
+    {
+        insert(position, std::forward<U>(elem));
+        return {};
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator, size_t BlockSize>
+void unrolled_list<T, Allocator, BlockSize>::reverse()
+{
+    // reverse the elements of every block and the order of the blocks
+    for(block *blk = head; blk; blk = blk->prev)
+    {
+        std::reverse(blk->data(), blk->data() + blk->count);
+        std::swap(blk->prev, blk->next);
+    }
+    std::swap(head, tail);
+}
+
+}
+
+#endif
@@ -3,19 +3,51 @@
 
 #include <iostream>
 #include <memory>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include "config.hpp" // Include the configuration header
+#include "type_traits.hpp"
+#include "growth.hpp"
+#include "format.hpp"
+#include "expected.hpp"
+#include "instrumentation.hpp"
 
 namespace adstl
 {
 
-template <typename T> class vector;
-template <typename T> std::ostream& operator<<(std::ostream&, const vector<T>&); 
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = geometric_growth<2, 1>, size_t InlineCapacity = 0> class vector;
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity> std::ostream& operator<<(std::ostream&, const vector<T, Allocator, GrowthPolicy, InlineCapacity>&); 
+
+// raw storage for the elements a vector keeps inside the object itself, see small_vector.hpp
+template <typename T, size_t N>
+struct inline_buffer
+{
+    T* inline_data() { return reinterpret_cast<T*>(bytes); }
+    const T* inline_data() const { return reinterpret_cast<const T*>(bytes); }
+
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+};
 
 template <typename T>
-class vector final
+struct inline_buffer<T, 0>
+{
+    T* inline_data() { return nullptr; }
+    const T* inline_data() const { return nullptr; }
+};
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+class vector final : private inline_buffer<T, InlineCapacity>
 {
 
-    friend std::ostream& operator<< <T>(std::ostream&, const vector<T>&);
+    friend std::ostream& operator<< <T, Allocator, GrowthPolicy>(std::ostream&, const vector<T, Allocator, GrowthPolicy, InlineCapacity>&);
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    // elements in the inline buffer can not be stolen, moving them has to be nothrow as well
+    static constexpr bool nothrow_relocate = 
+        InlineCapacity == 0 || is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>;
 
     private:
         class iterator;
@@ -24,27 +56,43 @@ class vector final
     public:
     
         using v_type = T;
+        using allocator_type = Allocator;
+        using growth_policy = GrowthPolicy;
         using iterator = iterator;
         using const_iterator = const_iterator;
-        
-        static void change_realloc_size(const size_t sz)
-        {
-            reallocate_size = sz;
-        }
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-        vector() : elements(nullptr), first_free(nullptr), cap(nullptr) {} // default constructor
+        // standard container names, so std::back_inserter and friends accept the vector
+        using value_type = T;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+
+        static constexpr size_t inline_capacity = InlineCapacity;
+
+        vector() : vector(Allocator()) {} // default constructor
+        explicit vector(const Allocator &a) 
+            : alloc(a), elements(this->inline_data()), first_free(elements), cap(elements + InlineCapacity) {}
 
         vector(const vector&);            // copy constructor
         vector& operator=(const vector&); // copy assignment   
 
-        vector(vector &&) noexcept; // move constructor 
-        vector& operator=(vector &&) noexcept; // move assigment    
+        vector(vector &&) noexcept(nothrow_relocate); // move constructor 
+        vector& operator=(vector &&) 
+            noexcept((alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) && nothrow_relocate); // move assigment    
                 
         // additional constructor
-        vector(const T*, const T*);
+        vector(const T*, const T*, const Allocator& = Allocator());
 
         ~vector(); 
 
+        allocator_type get_allocator() const { return alloc; }
+        void swap(vector&) noexcept(nothrow_relocate);
+
         void push_back(const T&);  // copy the element
         void push_back(T&&); // move the element
         template <typename ... Args>
@@ -52,16 +100,53 @@ class vector final
         void pop_back(); // destroy back element
         iterator insert(const_iterator, const T&);
         iterator insert(const_iterator, T&&); 
+        // no exceptions, errc::out_of_range where insert would throw
+        expected<iterator> try_insert(const_iterator, const T&);
+        expected<iterator> try_insert(const_iterator, T&&);
+
+        // bulk operations, each one reallocates at most once and shifts the tail at most once
+        iterator insert(const_iterator, size_t, const T&);
+        template <typename It> iterator insert(const_iterator, It, It);
+        template <typename It> void assign(It, It);
+        template <typename It> void append(It, It);
+        iterator erase(const_iterator);
+        iterator erase(const_iterator, const_iterator);
+        void clear();
 
         // add elements
         size_t size() const { return first_free - elements; }
         size_t capacity() const { return cap - elements; }
+        size_t max_size() const;
+        bool empty() const { return first_free == elements; }
+
+        void reserve(size_t);
+        void shrink_to_fit();
+        void resize(size_t);
+        void resize(size_t, const T&);
 
         // iterator interface
         iterator begin() { return iterator(elements); }
         iterator end() { return iterator(first_free); }
+        const_iterator begin() const { return const_iterator(elements); }
+        const_iterator end() const { return const_iterator(first_free); }
         const_iterator cbegin() const { return const_iterator(elements); }
         const_iterator cend() const { return const_iterator(first_free); }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crbegin() const { return rbegin(); }
+        const_reverse_iterator crend() const { return rend(); }
+
+        // the elements are contiguous, data() can be handed to memcpy or any T* interface
+        T* data() { return elements; }
+        const T* data() const { return elements; }
+
+        // undefined on an empty vector
+        T& front() { return *elements; }
+        const T& front() const { return *elements; }
+        T& back() { return *(first_free - 1); }
+        const T& back() const { return *(first_free - 1); }
 
         T& operator[](std::size_t n) 
             { return elements[n]; }
@@ -69,236 +154,394 @@ class vector final
         const T& operator[](std::size_t n) const 
             { return elements[n]; }
 
+        // bounds checked access
+        T& at(size_t);
+        const T& at(size_t) const;
+        // no exceptions, errc::out_of_range past the end
+        expected<T&> try_at(size_t);
+        expected<const T&> try_at(size_t) const;
+
     private:
         
         class iterator
         {
             
-            friend class vector<T>;
+            friend class vector;
+            friend class const_iterator;
 
             public:
+
+                using iterator_category = std::random_access_iterator_tag;
+                #if __cplusplus > 201703L
+                using iterator_concept = std::contiguous_iterator_tag;
+                #endif
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = T*;
+                using reference = T&;
+
+                iterator() : it(nullptr) {}
                 iterator(T *it) : it(it) {}
 
-                T& operator*() const 
+                reference operator*() const 
                 {
                     return *it;
                 }
 
+                pointer operator->() const { return it; }
+                reference operator[](difference_type n) const { return it[n]; }
+
                 iterator& operator++()
                 {
                     ++it;
                     return *this;
                 }
 
-                bool operator!=(const iterator &rhs) const
+                iterator operator++(int) { return iterator(it++); }
+                iterator& operator--() { --it; return *this; }
+                iterator operator--(int) { return iterator(it--); }
+
+                iterator& operator+=(difference_type n) { it += n; return *this; }
+                iterator& operator-=(difference_type n) { it -= n; return *this; }
+
+                iterator operator+(difference_type n) const
                 {
-                    return it != rhs.it;
+                    return iterator(it + n);
                 }
 
-                iterator operator+(const size_t sz)
+                iterator operator-(difference_type n) const
                 {
-                    return iterator(it + sz);
+                    return iterator(it - n);
                 }
 
-                iterator operator-(const size_t sz)
+                friend iterator operator+(difference_type n, const iterator &rhs) { return rhs + n; }
+
+                difference_type operator-(const iterator &rhs) const
                 {
-                    return iterator(it - sz);
+                    return it - rhs.it;
                 }
 
+                friend bool operator==(const iterator &lhs, const iterator &rhs) { return lhs.it == rhs.it; }
+                friend bool operator!=(const iterator &lhs, const iterator &rhs) { return lhs.it != rhs.it; }
+                friend bool operator<(const iterator &lhs, const iterator &rhs) { return lhs.it < rhs.it; }
+                friend bool operator>(const iterator &lhs, const iterator &rhs) { return lhs.it > rhs.it; }
+                friend bool operator<=(const iterator &lhs, const iterator &rhs) { return lhs.it <= rhs.it; }
+                friend bool operator>=(const iterator &lhs, const iterator &rhs) { return lhs.it >= rhs.it; }
+
             private:
                 T *it;
         };
 
         class const_iterator
         {
-
-            friend class vector<T>;
+            
+            friend class vector;
 
             public:
+
+                using iterator_category = std::random_access_iterator_tag;
+                #if __cplusplus > 201703L
+                using iterator_concept = std::contiguous_iterator_tag;
+                #endif
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const T*;
+                using reference = const T&;
+
+                const_iterator() : it(nullptr) {}
                 const_iterator(T *it) : it(it) {}
+                const_iterator(const iterator &rhs) : it(rhs.it) {}
 
-                const T& operator*() const 
+                reference operator*() const 
                 {
                     return *it;
                 }
 
+                pointer operator->() const { return it; }
+                reference operator[](difference_type n) const { return it[n]; }
+
                 const_iterator& operator++()
                 {
                     ++it;
                     return *this;
                 }
 
-                bool operator!=(const const_iterator &rhs) const
+                const_iterator operator++(int) { return const_iterator(it++); }
+                const_iterator& operator--() { --it; return *this; }
+                const_iterator operator--(int) { return const_iterator(it--); }
+
+                const_iterator& operator+=(difference_type n) { it += n; return *this; }
+                const_iterator& operator-=(difference_type n) { it -= n; return *this; }
+
+                const_iterator operator+(difference_type n) const
                 {
-                    return it != rhs.it;
+                    return const_iterator(it + n);
                 }
 
-                const_iterator operator+(const size_t sz)
+                const_iterator operator-(difference_type n) const
                 {
-                    return const_iterator(it + sz);
+                    return const_iterator(it - n);
                 }
 
-                const_iterator operator-(const size_t sz)
+                friend const_iterator operator+(difference_type n, const const_iterator &rhs) { return rhs + n; }
+
+                difference_type operator-(const const_iterator &rhs) const
                 {
-                    return const_iterator(it - sz);
+                    return it - rhs.it;
                 }
 
+                // hidden friends, so a const_iterator compares with an iterator as well
+                friend bool operator==(const const_iterator &lhs, const const_iterator &rhs) { return lhs.it == rhs.it; }
+                friend bool operator!=(const const_iterator &lhs, const const_iterator &rhs) { return lhs.it != rhs.it; }
+                friend bool operator<(const const_iterator &lhs, const const_iterator &rhs) { return lhs.it < rhs.it; }
+                friend bool operator>(const const_iterator &lhs, const const_iterator &rhs) { return lhs.it > rhs.it; }
+                friend bool operator<=(const const_iterator &lhs, const const_iterator &rhs) { return lhs.it <= rhs.it; }
+                friend bool operator>=(const const_iterator &lhs, const const_iterator &rhs) { return lhs.it >= rhs.it; }
 
             private:
                 T *it;
         };
 
 
-        static std::allocator<T> alloc;
-        static size_t reallocate_size;
-
         void chk_n_alloc() 
         {
-            if (size() == capacity())
+            if (first_free == cap)
                 reallocate(); 
         }
 
-        // used by the copy constructor, assignment operator, and destructor
-        std::pair<T*, T*> alloc_n_copy(const T*, const T*);
+        bool is_inline() const { return elements == this->inline_data(); }
+        void reset_to_inline(); // point to the empty inline buffer, old storage must already be freed
+        void steal(vector&) noexcept(nothrow_relocate); // take rhs elements, our storage must already be freed
 
         void free();             // destroy the elements and free the space
         void reallocate();       // get more space and copy the existing elements
+        void reallocate(size_t); // move the elements to a buffer of exactly the given capacity
+        size_t grow_capacity(size_t) const; // capacity to grow to when at least the given one is needed
+
+        // move [first, last) to raw memory at dest, the source is left as raw memory
+        T* relocate(T*, T*, T*);
+        // construct copies (moves when they can not throw) of [first, last) at raw memory dest,
+        // on an exception the ones already built are destroyed, the source is not touched
+        T* transfer(T*, T*, T*);
+
+        // construct one element at offset, shared by the single element inserts
+        template <typename ... Args> iterator insert_one(size_t, Args&& ...);
+        template <typename U> iterator shift_in(T*, U&&); // the tail moves one slot right, U lands at pos
+
+        // construct n elements at raw memory dest from a forward range
+        template <typename It> T* construct_n(It, size_t, T*);
+        template <typename It> iterator insert_n(size_t, It, size_t);
 
+        // repeats a single value, lets insert(pos, n, value) share the range insert path
+        class repeat_iterator
+        {
+            public:
+                explicit repeat_iterator(const T *value) : value(value) {}
+                const T& operator*() const { return *value; }
+                repeat_iterator& operator++() { return *this; }
+
+            private:
+                const T *value;
+        };
+
+        // raw pointers behind our own iterators, so ranges of them can be block copied
+        static T* unwrap(iterator it) { return it.it; }
+        static const T* unwrap(const_iterator it) { return it.it; }
+        template <typename It> static It unwrap(It it) { return it; }
+
+        template <typename It> static size_t range_size(It, It);
+        template <typename It> static It advance(It, size_t);
+
+        Allocator alloc;
         T *elements;   // pointer to the first element in the array
         T *first_free; // pointer to the first free element in the array
         T *cap;        // pointer to one past the end of the array
 };
 
-template <typename T>
-std::allocator<T> vector<T>::alloc;
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+std::ostream& operator<<(std::ostream &os, const vector<T, Allocator, GrowthPolicy, InlineCapacity> &rhs)
+{
+    return format_range(os, rhs.cbegin(), rhs.cend());
+}
 
-template <typename T>
-size_t vector<T>::reallocate_size = 2;
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::reset_to_inline()
+{
+    elements = first_free = this->inline_data();
+    cap = elements + InlineCapacity;
+}
 
-template <typename T>
-std::ostream& operator<<(std::ostream &os, const vector<T> &rhs)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::steal(vector &rhs) noexcept(nothrow_relocate)
 {
-    for(typename vector<T>::const_iterator b = rhs.cbegin(); b != rhs.cend(); ++b)
+    if constexpr (InlineCapacity > 0)
     {
-        os << *b << " ";
+        if (rhs.is_inline())
+        {
+            // inline elements stay with their object, relocate them into our own buffer
+            reset_to_inline();
+            first_free = relocate(rhs.elements, rhs.first_free, elements);
+            rhs.first_free = rhs.elements;
+            return;
+        }
     }
-    return os;
-}
 
-template <typename T>
-std::pair<T*, T*> vector<T>::alloc_n_copy(const T *begin, const T *end)
-{
-    T *data = alloc.allocate(end - begin);
-    return std::make_pair(data, std::uninitialized_copy(begin, end, data));
+    elements = rhs.elements;
+    first_free = rhs.first_free;
+    cap = rhs.cap;
+
+    rhs.reset_to_inline();
 }
 
 // Constructors
 
-template <typename It>
-inline vector<It>::vector(const It *begin, const It *end)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline vector<T, Allocator, GrowthPolicy, InlineCapacity>::vector(const T *begin, const T *end, const Allocator &a) : vector(a)
 {
-    std::pair<It*, It*> new_data = alloc_n_copy(begin, end);
-    elements = new_data.first;
-    first_free = cap = new_data.second;
+    reserve(end - begin);
+    first_free = construct_n(begin, end - begin, elements);
 }
 
 // cpy constructor
-template <typename T>
-inline vector<T>::vector(const vector<T> &rhs)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline vector<T, Allocator, GrowthPolicy, InlineCapacity>::vector(const vector &rhs) 
+    : vector(alloc_traits::select_on_container_copy_construction(rhs.alloc))
 {
-    std::pair<T*, T*> new_data = alloc_n_copy(rhs.begin(), rhs.end());
-    elements = new_data.first;
-    first_free = cap = new_data.second;
+    reserve(rhs.size());
+    first_free = construct_n(rhs.elements, rhs.size(), elements);
 }
 
 // move constructor
-template <typename T>
-inline vector<T>::vector(vector<T> &&rhs) noexcept
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline vector<T, Allocator, GrowthPolicy, InlineCapacity>::vector(vector &&rhs) noexcept(nothrow_relocate) : alloc(std::move(rhs.alloc))
 {
-    elements = rhs.elements;
-    first_free = rhs.first_free;
-    cap = rhs.cap;
-
-    rhs.elements = rhs.first_free = rhs.cap = nullptr;
+    steal(rhs);
 }
 
 // = ops
 
 // cpy=
-template <typename T>
-inline vector<T>& vector<T>::operator=(const vector<T> &rhs)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline vector<T, Allocator, GrowthPolicy, InlineCapacity>& vector<T, Allocator, GrowthPolicy, InlineCapacity>::operator=(const vector &rhs)
 {
-	// call alloc_n_copy to allocate exactly as many elements as in rhs
-	std::pair<T*, T*> data = 
-							alloc_n_copy(rhs.begin(), rhs.end());
+    if (this == &rhs)
+        return *this;
 
-	free();
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+    {
+        // memory owned by our allocator has to be released through it before it is replaced
+        if (!alloc_traits::is_always_equal::value && alloc != rhs.alloc)
+        {
+            free();
+            reset_to_inline();
+        }
+        alloc = rhs.alloc;
+    }
 
-	elements = data.first;
-	first_free = cap = data.second;
+    // reuses our buffer when it is big enough, allocates exactly rhs.size() otherwise
+    assign(rhs.elements, rhs.first_free);
 
 	return *this;
 }
 
 // move=
-template <typename T>
-inline vector<T>& vector<T>::operator=(vector<T> &&rhs) noexcept
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline vector<T, Allocator, GrowthPolicy, InlineCapacity>& vector<T, Allocator, GrowthPolicy, InlineCapacity>::operator=(vector &&rhs)
+    noexcept((alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) && nothrow_relocate)
 {
-	elements = rhs.elements;
-    first_free = rhs.first_free;
-    cap = rhs.cap;
+    if (this == &rhs)
+        return *this;
+
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value && !alloc_traits::is_always_equal::value)
+    {
+        // rhs buffer belongs to a different allocator, we can only move the elements one by one
+        if (alloc != rhs.alloc)
+        {
+            assign(std::make_move_iterator(rhs.elements), std::make_move_iterator(rhs.first_free));
+            return *this;
+        }
+    }
+
+    free();
+
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+        alloc = std::move(rhs.alloc);
 
-    rhs.elements = rhs.first_free = rhs.cap = nullptr;
+    steal(rhs);
 
     return *this;
 }
 
-template <typename T>
-inline vector<T>::~vector()
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline vector<T, Allocator, GrowthPolicy, InlineCapacity>::~vector()
 {
     free();
 }
 
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::swap(vector &rhs) noexcept(nothrow_relocate)
+{
+    if constexpr (alloc_traits::propagate_on_container_swap::value)
+    {
+        using std::swap;
+        swap(alloc, rhs.alloc);
+    }
+
+    if (is_inline() || rhs.is_inline())
+    {
+        // at least one side keeps its elements inline, go through a third object
+        vector tmp(alloc);
+        tmp.steal(rhs);
+        rhs.steal(*this);
+        steal(tmp);
+        return;
+    }
+
+    std::swap(elements, rhs.elements);
+    std::swap(first_free, rhs.first_free);
+    std::swap(cap, rhs.cap);
+}
+
 // cpy push back
-template <typename T>
-inline void vector<T>::push_back(const T &elem)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::push_back(const T &elem)
 {
     chk_n_alloc(); // ensure that there is room for another element
 
     // construct a copy of s in the element to which first_free points
-    alloc.construct(first_free++, elem);  
+    alloc_traits::construct(alloc, first_free++, elem);  
 }
 
 // move push back
-template <typename T>
-inline void vector<T>::push_back(T &&elem)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::push_back(T &&elem)
 {
     chk_n_alloc(); // ensure that there is room for another element
 
     // construct a copy of s in the element to which first_free points
-    alloc.construct(first_free++, std::move(elem));  
+    alloc_traits::construct(alloc, first_free++, std::move(elem));  
 }
 
-template <typename T>
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
 template <typename ... Args>
-void vector<T>::emplace_back(Args&& ... args)
+void vector<T, Allocator, GrowthPolicy, InlineCapacity>::emplace_back(Args&& ... args)
 {
     chk_n_alloc();
-    alloc.construct(first_free++, std::forward<Args>(args) ...);
+    alloc_traits::construct(alloc, first_free++, std::forward<Args>(args) ...);
 }
 
-template <typename T>
-inline void vector<T>::pop_back()
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::pop_back()
 {
     if (size() > 0) {
         // Destroy the last element in the vector
-        alloc.destroy(--first_free);
+        alloc_traits::destroy(alloc, --first_free);
     }
 }
 
 
-template <typename T>
-typename vector<T>::iterator vector<T>::insert(const_iterator pos, const T &val)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::insert(const_iterator pos, const T &val)
 {
 
     if(size() == 0 || pos.it == nullptr)
@@ -319,41 +562,519 @@ typename vector<T>::iterator vector<T>::insert(const_iterator pos, const T &val)
     }
     
 
-    // save offset before reallocation, because reallocation can invalidate iterators
-    size_t insert_offset = pos.it - elements;
+    return insert_one(pos.it - elements, val);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::insert(const_iterator pos, T&& val)
+{
 
-    chk_n_alloc();
+    if(size() == 0 || pos.it == nullptr)
+    {
+        #ifdef ADSTL_THROWABLE
+        throw std::out_of_range("Inserting on empty vector, or on nullptr position.");
+        #endif
+
+        return end();
+    }
+    else if (pos.it < elements || pos.it > first_free)
+    {
+        #ifdef ADSTL_THROWABLE
+        throw std::out_of_range("Iterator out of range.");
+        #endif
 
-    T *insert_pos = elements + insert_offset;
+        return end();
+    }
     
-    if(insert_pos != first_free)
+
+    return insert_one(pos.it - elements, std::move(val));
+}
+
+// same positions as insert accepts, a non empty vector and begin() <= pos <= end()
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+expected<typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator> vector<T, Allocator, GrowthPolicy, InlineCapacity>::try_insert(const_iterator pos, const T &val)
+{
+    if(size() != 0 && pos.it >= elements && pos.it <= first_free) ADSTL_LIKELY
+    {
+        return insert(pos, val);
+    }
+    return unexpected(errc::out_of_range);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+expected<typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator> vector<T, Allocator, GrowthPolicy, InlineCapacity>::try_insert(const_iterator pos, T &&val)
+{
+    if(size() != 0 && pos.it >= elements && pos.it <= first_free) ADSTL_LIKELY
+    {
+        return insert(pos, std::move(val));
+    }
+    return unexpected(errc::out_of_range);
+}
+
+
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::reallocate()
+{
+    // the growth policy decides how much more space we get
+    reallocate(grow_capacity(size() + 1));
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::reallocate(size_t new_capacity)
+{
+	// allocate new memory
+	T *new_data = new_capacity ? alloc_traits::allocate(alloc, new_capacity) : nullptr;
+	ADSTL_COUNT(vector, reallocations, 1);
+	if (new_capacity)
+		ADSTL_COUNT_ALLOCATION(vector, new_capacity, new_capacity * sizeof(T));
+
+	// move the data from the old memory to the new, a throwing copy leaves the old buffer as it was
+	T *dest;
+    ADSTL_TRY
+    {
+        dest = relocate(elements, first_free, new_data);
+    }
+    ADSTL_CATCH_ALL
+    {
+        if (new_capacity)
+            alloc_traits::deallocate(alloc, new_data, new_capacity);
+        ADSTL_RETHROW;
+    }
+
+    if (!is_inline())
+        alloc_traits::deallocate(alloc, elements, cap - elements);
+
+    // update our data structure to point to the new elements
+    elements = new_data;
+    first_free = dest;
+    cap = elements + new_capacity;
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline size_t vector<T, Allocator, GrowthPolicy, InlineCapacity>::grow_capacity(size_t min_capacity) const
+{
+    const size_t max = max_size();
+
+    if (min_capacity > max)
+    {
+        #ifdef ADSTL_THROWABLE
+        throw std::length_error("vector: requested capacity exceeds max_size().");
+        #endif
+
+        min_capacity = max;
+    }
+
+    size_t grown = GrowthPolicy::grow(capacity(), sizeof(T), max);
+    if (grown < min_capacity)
+        grown = min_capacity;
+
+    return round_capacity(grown, sizeof(T), max);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline size_t vector<T, Allocator, GrowthPolicy, InlineCapacity>::max_size() const
+{
+    const size_t alloc_max = alloc_traits::max_size(alloc);
+    const size_t diff_max = static_cast<size_t>(std::numeric_limits<std::ptrdiff_t>::max()) / sizeof(T);
+    return alloc_max < diff_max ? alloc_max : diff_max;
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline T* vector<T, Allocator, GrowthPolicy, InlineCapacity>::relocate(T *first, T *last, T *dest)
+{
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        // relocate the whole block at once, the old objects are not destroyed
+        ADSTL_COUNT(vector, elements_moved, last - first);
+        if (first != last)
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(T));
+        return dest + (last - first);
+    }
+    else
+    {
+        if constexpr (std::is_nothrow_move_constructible_v<T>)
+            ADSTL_COUNT(vector, elements_moved, last - first);
+        else
+            ADSTL_COUNT(vector, elements_copied, last - first);
+
+        dest = transfer(first, last, dest);
+
+        // destroy the old elements once all of them have been moved
+        for (T *elem = first; elem != last; ++elem)
+            alloc_traits::destroy(alloc, elem);
+
+        return dest;
+    }
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline T* vector<T, Allocator, GrowthPolicy, InlineCapacity>::transfer(T *first, T *last, T *dest)
+{
+    T *start = dest;
+    ADSTL_TRY
+    {
+        for (T *elem = first; elem != last; ++elem, ++dest)
+        {
+            // check if move construcotr of T obj is nothrowable
+            if constexpr (std::is_nothrow_move_constructible_v<T>)
+            {
+                alloc_traits::construct(alloc, dest, std::move(*elem));
+            }
+            else
+            {
+                alloc_traits::construct(alloc, dest, *elem);
+            }
+        }
+    }
+    ADSTL_CATCH_ALL
+    {
+        while (dest != start)
+            alloc_traits::destroy(alloc, --dest);
+        ADSTL_RETHROW;
+    }
+    return dest;
+}
+
+// Single element insert. With spare capacity only the new end slot is constructed, the rest of
+// the tail is shifted by move assignment, or by one memmove for trivially relocatable T.
+// Without it the element is built in the new buffer and the old ones are relocated around it,
+// nothing is shifted twice. Everything that can throw happens before the vector is changed,
+// except for the tail shift of a T whose move can throw.
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename ... Args>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::insert_one(size_t offset, Args&& ... args)
+{
+    if (first_free == cap)
+    {
+        size_t new_capacity = grow_capacity(size() + 1);
+        T *new_data = alloc_traits::allocate(alloc, new_capacity);
+        ADSTL_COUNT(vector, reallocations, 1);
+        ADSTL_COUNT_ALLOCATION(vector, new_capacity, new_capacity * sizeof(T));
+
+        // built first, args may refer to an element of this vector
+        T *slot = new_data + offset;
+        ADSTL_TRY
+        {
+            alloc_traits::construct(alloc, slot, std::forward<Args>(args) ...);
+        }
+        ADSTL_CATCH_ALL
+        {
+            alloc_traits::deallocate(alloc, new_data, new_capacity);
+            ADSTL_RETHROW;
+        }
+
+        T *dest;
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            relocate(elements, elements + offset, new_data);
+            dest = relocate(elements + offset, first_free, slot + 1);
+        }
+        else
+        {
+            if constexpr (std::is_nothrow_move_constructible_v<T>)
+                ADSTL_COUNT(vector, elements_moved, size());
+            else
+                ADSTL_COUNT(vector, elements_copied, size());
+
+            // the old buffer stays intact until both halves are in the new one
+            ADSTL_TRY
+            {
+                T *head_end = transfer(elements, elements + offset, new_data);
+                ADSTL_TRY
+                {
+                    dest = transfer(elements + offset, first_free, slot + 1);
+                }
+                ADSTL_CATCH_ALL
+                {
+                    for (T *p = new_data; p != head_end; ++p)
+                        alloc_traits::destroy(alloc, p);
+                    ADSTL_RETHROW;
+                }
+            }
+            ADSTL_CATCH_ALL
+            {
+                alloc_traits::destroy(alloc, slot);
+                alloc_traits::deallocate(alloc, new_data, new_capacity);
+                ADSTL_RETHROW;
+            }
+
+            for (T *p = elements; p != first_free; ++p)
+                alloc_traits::destroy(alloc, p);
+        }
+
+        if (!is_inline())
+            alloc_traits::deallocate(alloc, elements, cap - elements);
+
+        elements = new_data;
+        first_free = dest;
+        cap = elements + new_capacity;
+
+        return iterator(slot);
+    }
+
+    T *pos = elements + offset;
+
+    if (pos == first_free)
+    {
+        alloc_traits::construct(alloc, first_free, std::forward<Args>(args) ...);
+        ++first_free;
+        return iterator(pos);
+    }
+
+    if constexpr (is_trivially_relocatable_v<T>)
     {
-        for(T *p = first_free; p != insert_pos; --p)
+        // built aside first, then the tail moves with one memmove and the new element is
+        // relocated into the gap, nothing can throw once the tail has moved
+        alignas(T) unsigned char raw[sizeof(T)];
+        T *value = reinterpret_cast<T*>(raw);
+        alloc_traits::construct(alloc, value, std::forward<Args>(args) ...);
+
+        ADSTL_COUNT(vector, elements_moved, first_free - pos);
+        std::memmove(static_cast<void*>(pos + 1), static_cast<const void*>(pos), (first_free - pos) * sizeof(T));
+        std::memcpy(static_cast<void*>(pos), static_cast<const void*>(value), sizeof(T));
+        ++first_free;
+        return iterator(pos);
+    }
+    else
+    {
+        // a T that is assigned without throwing goes straight in, unless it lives in the tail
+        if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, T> && ...) &&
+                      std::is_nothrow_assignable_v<T&, Args&&...>)
         {
-            alloc.construct(p, std::move(*(p - 1)));
-            alloc.destroy(p - 1);
+            if (((static_cast<const T*>(std::addressof(args)) < pos || static_cast<const T*>(std::addressof(args)) >= first_free) && ...))
+                return shift_in(pos, std::forward<Args>(args) ...);
         }
+
+        T value(std::forward<Args>(args) ...);
+        return shift_in(pos, std::move(value));
     }
+}
 
-    alloc.construct(insert_pos, val);
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename U>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::shift_in(T *pos, U &&value)
+{
+    // only the new end slot is constructed, the rest of the tail is move assigned
+    T *old_end = first_free;
+    ADSTL_COUNT(vector, elements_moved, old_end - pos);
+    alloc_traits::construct(alloc, old_end, std::move(*(old_end - 1)));
     ++first_free;
+    std::move_backward(pos, old_end - 1, old_end);
+    *pos = std::forward<U>(value);
+    return iterator(pos);
+}
 
-    return iterator(insert_pos);
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename It>
+inline T* vector<T, Allocator, GrowthPolicy, InlineCapacity>::construct_n(It first, size_t n, T *dest)
+{
+    auto src = unwrap(first);
+
+    if constexpr (std::is_trivially_copyable_v<T> && 
+                  (std::is_same_v<decltype(src), T*> || std::is_same_v<decltype(src), const T*>))
+    {
+        // contiguous source of the same trivially copyable type, copy it as one block
+        if (n)
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(T));
+        return dest + n;
+    }
+    else
+    {
+        // on a throw the elements built so far are destroyed, the caller owns the memory
+        T *start = dest;
+        ADSTL_TRY
+        {
+            for (; n; --n, ++first, ++dest)
+                alloc_traits::construct(alloc, dest, *first);
+        }
+        ADSTL_CATCH_ALL
+        {
+            while (dest != start)
+                alloc_traits::destroy(alloc, --dest);
+            ADSTL_RETHROW;
+        }
+        return dest;
+    }
 }
 
-template <typename T>
-typename vector<T>::iterator vector<T>::insert(const_iterator pos, T&& val)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename It>
+inline size_t vector<T, Allocator, GrowthPolicy, InlineCapacity>::range_size(It first, It last)
 {
+    auto src_first = unwrap(first);
+    auto src_last = unwrap(last);
 
-    if(size() == 0 || pos.it == nullptr)
+    if constexpr (std::is_pointer_v<decltype(src_first)> || is_random_access_iterator_v<It>)
+    {
+        return src_last - src_first;
+    }
+    else
+    {
+        size_t n = 0;
+        for (; first != last; ++first)
+            ++n;
+        return n;
+    }
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename It>
+inline It vector<T, Allocator, GrowthPolicy, InlineCapacity>::advance(It it, size_t n)
+{
+    if constexpr (is_random_access_iterator_v<It>)
+    {
+        return it + n;
+    }
+    else
+    {
+        for (; n; --n)
+            ++it;
+        return it;
+    }
+}
+
+// insert n elements from a forward range at offset, with at most one reallocation and one tail shift
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename It>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::insert_n(size_t offset, It first, size_t n)
+{
+    if (n == 0)
+        return iterator(elements + offset);
+
+    if (n > static_cast<size_t>(cap - first_free))
+    {
+        size_t new_capacity = grow_capacity(size() + n);
+        T *new_data = alloc_traits::allocate(alloc, new_capacity);
+        ADSTL_COUNT(vector, reallocations, 1);
+        ADSTL_COUNT_ALLOCATION(vector, new_capacity, new_capacity * sizeof(T));
+
+        // the new elements go straight to their final place, the old ones are relocated around them
+        T *slot = new_data + offset;
+        ADSTL_TRY
+        {
+            construct_n(first, n, slot);
+        }
+        ADSTL_CATCH_ALL
+        {
+            alloc_traits::deallocate(alloc, new_data, new_capacity);
+            ADSTL_RETHROW;
+        }
+
+        T *dest;
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            relocate(elements, elements + offset, new_data);
+            dest = relocate(elements + offset, first_free, slot + n);
+        }
+        else
+        {
+            if constexpr (std::is_nothrow_move_constructible_v<T>)
+                ADSTL_COUNT(vector, elements_moved, size());
+            else
+                ADSTL_COUNT(vector, elements_copied, size());
+
+            // the old buffer stays intact until both halves are in the new one
+            ADSTL_TRY
+            {
+                T *head_end = transfer(elements, elements + offset, new_data);
+                ADSTL_TRY
+                {
+                    dest = transfer(elements + offset, first_free, slot + n);
+                }
+                ADSTL_CATCH_ALL
+                {
+                    for (T *p = new_data; p != head_end; ++p)
+                        alloc_traits::destroy(alloc, p);
+                    ADSTL_RETHROW;
+                }
+            }
+            ADSTL_CATCH_ALL
+            {
+                for (T *p = slot; p != slot + n; ++p)
+                    alloc_traits::destroy(alloc, p);
+                alloc_traits::deallocate(alloc, new_data, new_capacity);
+                ADSTL_RETHROW;
+            }
+
+            for (T *p = elements; p != first_free; ++p)
+                alloc_traits::destroy(alloc, p);
+        }
+
+        if (!is_inline())
+            alloc_traits::deallocate(alloc, elements, cap - elements);
+
+        elements = new_data;
+        first_free = dest;
+        cap = elements + new_capacity;
+
+        return iterator(elements + offset);
+    }
+
+    T *pos = elements + offset;
+    size_t tail = first_free - pos;
+    ADSTL_COUNT(vector, elements_moved, tail);
+
+    if constexpr (is_trivially_relocatable_v<T> && std::is_nothrow_constructible_v<T, decltype(*first)>)
+    {
+        // open a raw gap with a single memmove and construct the new elements in it
+        if (tail)
+            std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos), tail * sizeof(T));
+        construct_n(first, n, pos);
+        first_free += n;
+    }
+    else if (tail > n)
+    {
+        // the last n elements move to raw memory, the rest of the tail is shifted by assignment
+        T *old_end = first_free;
+        for (T *p = old_end - n; p != old_end; ++p)
+            alloc_traits::construct(alloc, first_free++, std::move(*p));
+        std::move_backward(pos, old_end - n, old_end);
+        for (T *p = pos; p != pos + n; ++p, ++first)
+            *p = *first;
+    }
+    else
+    {
+        // the part of the range past the old end and the whole tail land on raw memory
+        It mid = advance(first, tail);
+        T *old_end = first_free;
+        first_free = construct_n(mid, n - tail, first_free);
+        for (T *p = pos; p != old_end; ++p)
+            alloc_traits::construct(alloc, first_free++, std::move(*p));
+        for (T *p = pos; p != old_end; ++p, ++first)
+            *p = *first;
+    }
+
+    return iterator(pos);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::insert(const_iterator pos, size_t n, const T &val)
+{
+    if (pos.it < elements || pos.it > first_free)
     {
         #ifdef ADSTL_THROWABLE
-        throw std::out_of_range("Inserting on empty vector, or on nullptr position.");
+        throw std::out_of_range("Iterator out of range.");
         #endif
 
         return end();
     }
-    else if (pos.it < elements || pos.it > first_free)
+
+    // val may live inside this vector, keep a copy that survives the shift
+    if (&val >= elements && &val < first_free)
+    {
+        T copy(val);
+        return insert_n(pos.it - elements, repeat_iterator(&copy), n);
+    }
+
+    return insert_n(pos.it - elements, repeat_iterator(&val), n);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename It>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::insert(const_iterator pos, It first, It last)
+{
+    if (pos.it < elements || pos.it > first_free)
     {
         #ifdef ADSTL_THROWABLE
         throw std::out_of_range("Iterator out of range.");
@@ -361,77 +1082,262 @@ typename vector<T>::iterator vector<T>::insert(const_iterator pos, T&& val)
 
         return end();
     }
-    
 
-    // save offset before reallocation, because reallocation can invalidate iterators
-    size_t insert_offset = pos.it - elements;
+    if constexpr (is_input_only_iterator_v<It>)
+    {
+        // single pass range, collect it first so the tail is shifted only once
+        vector tmp(alloc);
+        for (; first != last; ++first)
+            tmp.emplace_back(*first);
+        return insert_n(pos.it - elements, std::make_move_iterator(tmp.elements), tmp.size());
+    }
+    else
+    {
+        return insert_n(pos.it - elements, first, range_size(first, last));
+    }
+}
 
-    chk_n_alloc();
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename It>
+void vector<T, Allocator, GrowthPolicy, InlineCapacity>::append(It first, It last)
+{
+    if constexpr (is_input_only_iterator_v<It>)
+    {
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+    else
+    {
+        insert_n(size(), first, range_size(first, last));
+    }
+}
 
-    T *insert_pos = elements + insert_offset;
-    
-    if(insert_pos != first_free)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+template <typename It>
+void vector<T, Allocator, GrowthPolicy, InlineCapacity>::assign(It first, It last)
+{
+    if constexpr (is_input_only_iterator_v<It>)
     {
-        for(T *p = first_free; p != insert_pos; --p)
+        clear();
+        append(first, last);
+    }
+    else
+    {
+        size_t n = range_size(first, last);
+
+        if (n > capacity())
+        {
+            T *new_data = alloc_traits::allocate(alloc, n);
+            ADSTL_COUNT(vector, reallocations, 1);
+            ADSTL_COUNT_ALLOCATION(vector, n, n * sizeof(T));
+            ADSTL_TRY
+            {
+                construct_n(first, n, new_data);
+            }
+            ADSTL_CATCH_ALL
+            {
+                alloc_traits::deallocate(alloc, new_data, n);
+                ADSTL_RETHROW;
+            }
+
+            free();
+
+            elements = new_data;
+            first_free = cap = new_data + n;
+        }
+        else if (n <= size())
+        {
+            T *dest = elements;
+            for (; dest != elements + n; ++dest, ++first)
+                *dest = *first;
+            while (first_free != dest)
+                alloc_traits::destroy(alloc, --first_free);
+        }
+        else
         {
-            alloc.construct(p, std::move(*(p - 1)));
-            alloc.destroy(p - 1);
+            It mid = advance(first, size());
+            for (T *dest = elements; dest != first_free; ++dest, ++first)
+                *dest = *first;
+            first_free = construct_n(mid, n - size(), first_free);
         }
     }
+}
 
-    alloc.construct(insert_pos, std::move(val));
-    ++first_free;
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::erase(const_iterator pos)
+{
+    return erase(pos, pos + 1);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+typename vector<T, Allocator, GrowthPolicy, InlineCapacity>::iterator vector<T, Allocator, GrowthPolicy, InlineCapacity>::erase(const_iterator first, const_iterator last)
+{
+    if (first.it < elements || last.it > first_free || first.it > last.it)
+    {
+        #ifdef ADSTL_THROWABLE
+        throw std::out_of_range("Iterator out of range.");
+        #endif
+
+        return end();
+    }
+
+    T *from = first.it;
+    T *to = last.it;
+
+    if (from == to)
+        return iterator(from);
+
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        // destroy the erased elements and close the gap with a single memmove
+        for (T *p = from; p != to; ++p)
+            alloc_traits::destroy(alloc, p);
+        std::memmove(static_cast<void*>(from), static_cast<const void*>(to), (first_free - to) * sizeof(T));
+        first_free -= to - from;
+    }
+    else
+    {
+        T *new_end = std::move(to, first_free, from);
+        while (first_free != new_end)
+            alloc_traits::destroy(alloc, --first_free);
+    }
+
+    return iterator(from);
+}
 
-    return iterator(insert_pos);
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::clear()
+{
+    while (first_free != elements)
+        alloc_traits::destroy(alloc, --first_free);
 }
 
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline T& vector<T, Allocator, GrowthPolicy, InlineCapacity>::at(size_t n)
+{
+    #ifdef ADSTL_THROWABLE
+    if(n >= size())
+    {
+        throw std::out_of_range("vector::at: index out of range.");
+    }
+    #endif
 
+    return elements[n];
+}
 
-template <typename T>
-inline void vector<T>::reallocate()
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline const T& vector<T, Allocator, GrowthPolicy, InlineCapacity>::at(size_t n) const
 {
-    // we'll allocate space for twice as many elements as the current size
-    size_t new_capacity = size() ? reallocate_size * size() : 1;
+    #ifdef ADSTL_THROWABLE
+    if(n >= size())
+    {
+        throw std::out_of_range("vector::at: index out of range.");
+    }
+    #endif
 
-	// allocate new memory
-	T *new_data = alloc.allocate(new_capacity);
+    return elements[n];
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline expected<T&> vector<T, Allocator, GrowthPolicy, InlineCapacity>::try_at(size_t n)
+{
+    if(n < size()) ADSTL_LIKELY
+    {
+        return elements[n];
+    }
+    return unexpected(errc::out_of_range);
+}
 
-	// copy the data from the old memory to the new
-	T *dest = new_data;  // points to the next free position in the new array
-    T *elem = elements; // points to the next element in the old array
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline expected<const T&> vector<T, Allocator, GrowthPolicy, InlineCapacity>::try_at(size_t n) const
+{
+    if(n < size()) ADSTL_LIKELY
+    {
+        return elements[n];
+    }
+    return unexpected(errc::out_of_range);
+}
 
-	for (size_t i = 0; i != size(); ++i)
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::reserve(size_t n)
+{
+    if (n > capacity())
     {
-        // check if move construcotr of T obj is nothrowable
-        if constexpr (std::is_nothrow_move_constructible_v<T>)
+        if (n > max_size())
         {
-            alloc.construct(dest++, std::move(*elem++));
+            #ifdef ADSTL_THROWABLE
+            throw std::length_error("vector::reserve: requested capacity exceeds max_size().");
+            #endif
+
+            return;
         }
-        else
+
+        reallocate(n);
+    }
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::shrink_to_fit()
+{
+    if (is_inline() || first_free == cap)
+        return;
+
+    if constexpr (InlineCapacity > 0)
+    {
+        if (size() <= InlineCapacity)
         {
-		    alloc.construct(dest++, *elem++);
+            // the elements fit in the inline buffer again
+            T *old_elements = elements;
+            size_t old_capacity = capacity();
+            T *dest = relocate(elements, first_free, this->inline_data());
+
+            alloc_traits::deallocate(alloc, old_elements, old_capacity);
+
+            reset_to_inline();
+            first_free = dest;
+            return;
         }
     }
 
-	free();  // free the old space once we've moved the elements
+    reallocate(size());
+}
 
-    // update our data structure to point to the new elements
-    elements = new_data;
-    first_free = dest;
-    cap = elements + new_capacity;
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::resize(size_t n)
+{
+    if (n > size())
+    {
+        if (n > capacity())
+            reallocate(grow_capacity(n));
+        while (first_free != elements + n)
+            alloc_traits::construct(alloc, first_free++);
+    }
+    else
+    {
+        while (first_free != elements + n)
+            alloc_traits::destroy(alloc, --first_free);
+    }
 }
 
-template <typename T>
-inline void vector<T>::free()
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::resize(size_t n, const T &val)
 {
-    // may not pass deallocate a 0 pointer; if elements is 0, there's no work to do
-	if (elements) {
-    	// destroy the old elements in reverse order
-		for (T *p = first_free; p != elements;)
-			alloc.destroy(--p);  
-        
-		alloc.deallocate(elements, cap - elements);
-	}
+    if (n > size())
+        insert_n(size(), repeat_iterator(&val), n - size());
+    else
+        resize(n);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, size_t InlineCapacity>
+inline void vector<T, Allocator, GrowthPolicy, InlineCapacity>::free()
+{
+    // destroy the old elements in reverse order
+    for (T *p = first_free; p != elements;)
+        alloc_traits::destroy(alloc, --p);  
+
+    // may not pass deallocate a 0 pointer, and the inline buffer is not ours to deallocate
+    if (!is_inline())
+        alloc_traits::deallocate(alloc, elements, cap - elements);
 }
 
 }
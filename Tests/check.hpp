@@ -0,0 +1,33 @@
+/*
+    TEST SUPPORT
+*/
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+// CHECK(cond) reports the condition with its file and line and aborts, unlike assert it
+// stays on whatever NDEBUG says
+#define CHECK(cond) ((cond) ? (void)0 : adstl_check::fail(#cond, __FILE__, __LINE__))
+
+namespace adstl_check
+{
+
+[[noreturn]] inline void fail(const char *expr, const char *file, int line)
+{
+    std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expr);
+    std::abort();
+}
+
+void run_btree_tests();
+void run_concurrent_stack_tests();
+void run_flat_hash_map_tests();
+void run_mpmc_ring_tests();
+void run_parallel_tests();
+void run_priority_queue_tests();
+
+}
+
+#endif
@@ -0,0 +1,358 @@
+#include "check.hpp"
+#include "btree_map.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace adstl_check
+{
+
+namespace
+{
+
+template <size_t NodeBytes>
+using int_map = adstl::btree_map<int, int, std::less<int>, std::allocator<std::pair<int, int>>, NodeBytes>;
+
+template <size_t NodeBytes>
+using string_map = adstl::btree_map<std::string, std::string, std::less<>, std::allocator<std::pair<std::string, std::string>>, NodeBytes>;
+
+template <size_t NodeBytes>
+using string_set = adstl::btree_set<std::string, std::less<>, std::allocator<std::string>, NodeBytes>;
+
+// btree_map holds std::pair<Key, T>, std::map std::pair<const Key, T>
+template <typename A, typename B>
+bool same(const A &a, const B &b)
+{
+    return a == b;
+}
+
+template <typename K1, typename K2, typename T>
+bool same(const std::pair<K1, T> &a, const std::pair<K2, T> &b)
+{
+    return a.first == b.first && a.second == b.second;
+}
+
+struct same_element
+{
+    template <typename A, typename B>
+    bool operator()(const A &a, const B &b) const { return same(a, b); }
+};
+
+// both directions, the backward walk follows the prev links of the leaves
+template <typename Tree, typename Reference>
+void check_same(const Tree &tree, const Reference &ref)
+{
+    CHECK(tree.size() == ref.size());
+    CHECK(tree.empty() == ref.empty());
+    CHECK(static_cast<size_t>(std::distance(tree.begin(), tree.end())) == ref.size());
+    CHECK(std::equal(tree.begin(), tree.end(), ref.begin(), ref.end(), same_element()));
+    CHECK(std::equal(tree.rbegin(), tree.rend(), ref.rbegin(), ref.rend(), same_element()));
+}
+
+inline std::string make_key(unsigned k)
+{
+    // long enough to live on the heap, padded so the order is numeric
+    std::string key = std::to_string(k);
+    return std::string(24 - key.size(), '0') + key;
+}
+
+template <typename Tree, typename Reference, typename Key>
+void check_bounds(const Tree &tree, const Reference &ref, const Key &key)
+{
+    auto lower = tree.lower_bound(key);
+    auto ref_lower = ref.lower_bound(key);
+    CHECK((lower == tree.end()) == (ref_lower == ref.end()));
+    CHECK(lower == tree.end() || same(*lower, *ref_lower));
+
+    auto upper = tree.upper_bound(key);
+    auto ref_upper = ref.upper_bound(key);
+    CHECK((upper == tree.end()) == (ref_upper == ref.end()));
+    CHECK(upper == tree.end() || same(*upper, *ref_upper));
+
+    CHECK(tree.contains(key) == (ref.count(key) == 1));
+}
+
+// random inserts, lookups and erases of every kind, then erase down to empty in random
+// order so each level of the tree is collapsed into the root again
+template <typename Map>
+void random_map(unsigned seed, unsigned range, int ops)
+{
+    std::mt19937 rng(seed);
+    Map map;
+    std::map<std::string, std::string> ref;
+
+    for(int op = 0; op < ops; ++op)
+    {
+        std::string key = make_key(rng() % range);
+        switch(rng() % 10)
+        {
+            case 0: case 1:
+            {
+                auto r = map.insert({key, std::to_string(op)});
+                auto ref_r = ref.insert({key, std::to_string(op)});
+                CHECK(r.second == ref_r.second && r.first->first == key);
+                break;
+            }
+            case 2:
+            {
+                auto r = map.try_emplace(key, 4, 'x');
+                CHECK(r.second == ref.try_emplace(key, 4, 'x').second && r.first->first == key);
+                break;
+            }
+            case 3:
+            {
+                map[key] += 'y';
+                ref[key] += 'y';
+                break;
+            }
+            case 4: case 5:
+            {
+                CHECK(map.erase(key) == ref.erase(key));
+                break;
+            }
+            case 6:
+            {
+                auto it = map.find(key);
+                auto ref_it = ref.find(key);
+                CHECK((it == map.end()) == (ref_it == ref.end()));
+                if(ref_it != ref.end())
+                {
+                    auto next = map.erase(it);
+                    auto ref_next = ref.erase(ref_it);
+                    CHECK((next == map.end()) == (ref_next == ref.end()));
+                    CHECK(next == map.end() || same(*next, *ref_next));
+                }
+                break;
+            }
+            case 7:
+            {
+                // a short range, now and then a long one that empties whole leaves
+                std::string last = make_key(rng() % range);
+                if(last < key)
+                {
+                    std::swap(key, last);
+                }
+                if(rng() % 8)
+                {
+                    last = make_key(std::stoul(key) + rng() % 16);
+                }
+                auto next = map.erase(map.lower_bound(key), map.lower_bound(last));
+                ref.erase(ref.lower_bound(key), ref.lower_bound(last));
+                CHECK(next == map.lower_bound(last));
+                break;
+            }
+            default:
+            {
+                check_bounds(map, ref, key);
+                break;
+            }
+        }
+
+        if(op % 1009 == 0)
+        {
+            check_same(map, ref);
+        }
+    }
+    check_same(map, ref);
+
+    Map copy(map);
+    check_same(copy, ref);
+
+    std::vector<std::string> keys;
+    for(const auto &kv : ref)
+    {
+        keys.push_back(kv.first);
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for(size_t i = 0; i != keys.size(); ++i)
+    {
+        CHECK(map.erase(keys[i]) == 1);
+        ref.erase(keys[i]);
+        if(i % 257 == 0)
+        {
+            check_same(map, ref);
+        }
+    }
+    CHECK(map.empty() && map.begin() == map.end());
+
+    // the emptied tree is as good as a new one, the copy still holds everything
+    map.emplace(make_key(1), "1");
+    CHECK(map.size() == 1 && map.begin()->second == "1");
+    CHECK(copy.size() == keys.size());
+}
+
+template <typename Set>
+void random_set(unsigned seed, unsigned range, int ops)
+{
+    std::mt19937 rng(seed);
+    Set set;
+    std::set<std::string> ref;
+
+    for(int op = 0; op < ops; ++op)
+    {
+        std::string key = make_key(rng() % range);
+        switch(rng() % 4)
+        {
+            case 0: CHECK(set.insert(key).second == ref.insert(key).second); break;
+            case 1: CHECK(set.emplace(key).second == ref.emplace(key).second); break;
+            case 2: CHECK(set.erase(key) == ref.erase(key)); break;
+            default: check_bounds(set, ref, key); break;
+        }
+    }
+    check_same(set, ref);
+
+    auto next = set.erase(set.begin(), set.end());
+    CHECK(next == set.end() && set.empty());
+}
+
+// keys in order land in the last leaf, which splits unevenly so the tree stays packed,
+// erasing them in order merges leaves from the left until the root is a leaf again
+template <size_t NodeBytes>
+void ordered_runs(int n)
+{
+    int_map<NodeBytes> ascending;
+    int_map<NodeBytes> descending;
+    std::map<int, int> ref;
+
+    for(int i = 0; i < n; ++i)
+    {
+        ascending.emplace(i, i);
+        descending.emplace(n - 1 - i, n - 1 - i);
+        ref.emplace(i, i);
+    }
+    check_same(ascending, ref);
+    check_same(descending, ref);
+
+    for(int i = 0; i < n; i += 2)
+    {
+        ascending.erase(i);
+        descending.erase(i);
+        ref.erase(i);
+    }
+    check_same(ascending, ref);
+    check_same(descending, ref);
+
+    for(int i = 0; i < n; ++i)
+    {
+        ascending.erase(i);
+    }
+    CHECK(ascending.empty());
+
+    while(!descending.empty())
+    {
+        descending.erase(std::prev(descending.end()));
+    }
+    CHECK(descending.begin() == descending.end());
+}
+
+// bulk loads of every size around the node boundaries, then edits on the loaded tree
+template <size_t NodeBytes>
+void bulk_load(int n)
+{
+    adstl::vector<std::pair<int, int>> sorted;
+    for(int i = 0; i < n; ++i)
+    {
+        sorted.push_back({2 * i, i});
+    }
+    std::map<int, int> ref(sorted.begin(), sorted.end());
+
+    int_map<NodeBytes> from_range(adstl::sorted_unique, sorted.begin(), sorted.end());
+    check_same(from_range, ref);
+    int_map<NodeBytes> from_insert(sorted.begin(), sorted.end());
+    check_same(from_insert, ref);
+    int_map<NodeBytes> map(adstl::sorted_unique, std::move(sorted));
+    CHECK(sorted.empty());
+    check_same(map, ref);
+
+    for(int i = 0; i < n; i += 3)
+    {
+        map.erase(2 * i);
+        ref.erase(2 * i);
+        map.emplace(2 * i + 1, -i);
+        ref.emplace(2 * i + 1, -i);
+    }
+    check_same(map, ref);
+
+    int_map<NodeBytes> moved(std::move(map));
+    check_same(moved, ref);
+    map = moved;
+    check_same(map, ref);
+}
+
+// the new value is copied from an element of the same tree, mostly of the same leaf, which
+// the insert shifts or splits
+template <size_t NodeBytes>
+void self_reference()
+{
+    string_map<NodeBytes> map;
+    std::map<std::string, std::string> ref;
+    map.try_emplace(make_key(0), std::string(40, 'a'));
+    ref.try_emplace(make_key(0), std::string(40, 'a'));
+
+    std::mt19937 rng(7);
+    for(unsigned i = 1; i < 3000; ++i)
+    {
+        // the source is the next key above, so it sits right behind the insert position
+        const std::string key = make_key(rng() % 100000);
+        auto above = ref.upper_bound(key);
+        const std::string source = above != ref.end() ? above->first : ref.begin()->first;
+        if(i % 2)
+        {
+            map.try_emplace(key, map.at(source));
+        }
+        else
+        {
+            map.emplace(key, map.at(source));
+        }
+        ref.try_emplace(key, ref.at(source));
+        CHECK(map.at(key) == ref.at(key));
+    }
+    check_same(map, ref);
+}
+
+template <size_t NodeBytes>
+void run_node_size()
+{
+    for(unsigned seed = 0; seed < 3; ++seed)
+    {
+        random_map<string_map<NodeBytes>>(seed, 300, 20000);
+        random_map<string_map<NodeBytes>>(seed, 20000, 40000);
+        random_set<string_set<NodeBytes>>(seed, 5000, 30000);
+    }
+
+    ordered_runs<NodeBytes>(30000);
+    self_reference<NodeBytes>();
+
+    const size_t leaf = int_map<NodeBytes>::leaf_slots;
+    const size_t inner = int_map<NodeBytes>::inner_slots;
+    for(size_t n : {size_t(0), size_t(1), size_t(2), leaf - 1, leaf, leaf + 1, 2 * leaf, leaf * (inner + 1),
+                    leaf * (inner + 1) + 1, size_t(1000), size_t(12345), size_t(100000)})
+    {
+        bulk_load<NodeBytes>(static_cast<int>(n));
+    }
+}
+
+}
+
+void run_btree_tests()
+{
+    run_node_size<64>();
+    run_node_size<256>();
+    run_node_size<1024>();
+
+    // unsorted input with duplicates takes the element by element path, the first one wins
+    std::vector<std::pair<int, int>> unsorted{{5, 1}, {3, 2}, {9, 3}, {3, 4}};
+    adstl::btree_map<int, int> map(unsorted.begin(), unsorted.end());
+    CHECK(map.size() == 3 && map.at(3) == 2 && !map.try_at(4));
+
+    adstl::btree_set<int> set{5, 1, 3, 1};
+    CHECK(set.size() == 3 && *set.begin() == 1 && *set.rbegin() == 5);
+}
+
+}
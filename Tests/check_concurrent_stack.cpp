@@ -0,0 +1,166 @@
+#include "check.hpp"
+#include "concurrent_stack.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace adstl_check
+{
+
+namespace
+{
+
+inline void make_element(std::uint64_t v, std::uint64_t &out)
+{
+    out = v;
+}
+
+inline void make_element(std::uint64_t v, std::string &out)
+{
+    // past the small string buffer, a node freed under a reader shows up as a heap error
+    out = "element-" + std::to_string(v) + std::string(24, '.');
+}
+
+inline std::uint64_t element_value(std::uint64_t v)
+{
+    return v;
+}
+
+inline std::uint64_t element_value(const std::string &s)
+{
+    return std::stoull(s.substr(8));
+}
+
+// Producers push their own values, consumers pop until all of them arrived, and mixed
+// threads do both so pushes and pops meet in the elimination array. Every value has to
+// arrive exactly once. A lost element would leave the consumers waiting forever, the
+// deadline turns that into a failed check.
+template <typename T>
+void stress(size_t producers, size_t consumers, size_t mixed, std::uint64_t per_thread)
+{
+    using stack_type = adstl::concurrent_stack<T>;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(2);
+    stack_type stack;
+    const size_t pushers = producers + mixed;
+    const std::uint64_t total = pushers * per_thread;
+    std::atomic<std::uint64_t> popped{0};
+    std::vector<std::vector<std::uint64_t>> received(consumers + mixed);
+    std::vector<std::thread> threads;
+
+    auto pop_one = [&stack, &popped](std::vector<std::uint64_t> &mine)
+    {
+        T element;
+        if(!stack.try_pop(element))
+        {
+            return false;
+        }
+        mine.push_back(element_value(element));
+        popped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    };
+
+    for(size_t p = 0; p != producers; ++p)
+    {
+        threads.emplace_back([&stack, p, per_thread]
+        {
+            for(std::uint64_t i = 0; i != per_thread; ++i)
+            {
+                T element;
+                make_element(p * per_thread + i, element);
+                if(i % 2)
+                {
+                    stack.push(std::move(element));
+                }
+                else
+                {
+                    stack.emplace(std::move(element));
+                }
+            }
+        });
+    }
+
+    for(size_t c = 0; c != consumers; ++c)
+    {
+        threads.emplace_back([&popped, &received, &pop_one, c, total, deadline]
+        {
+            while(popped.load(std::memory_order_relaxed) != total)
+            {
+                if(!pop_one(received[c]))
+                {
+                    CHECK(std::chrono::steady_clock::now() < deadline);
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // push one, pop one, the stack stays short and top is contended all the time
+    for(size_t m = 0; m != mixed; ++m)
+    {
+        threads.emplace_back([&stack, &received, &pop_one, m, consumers, producers, per_thread]
+        {
+            const std::uint64_t first = (producers + m) * per_thread;
+            for(std::uint64_t i = 0; i != per_thread; ++i)
+            {
+                T element;
+                make_element(first + i, element);
+                stack.push(std::move(element));
+                pop_one(received[consumers + m]);
+            }
+        });
+    }
+
+    for(auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    // the mixed threads may leave elements behind when nobody else consumes
+    std::vector<std::uint64_t> rest;
+    while(pop_one(rest)) {}
+    received.push_back(std::move(rest));
+
+    CHECK(stack.empty());
+    CHECK(popped.load() == total);
+
+    std::vector<unsigned char> seen(total, 0);
+    std::uint64_t sum = 0;
+    for(const auto &mine : received)
+    {
+        for(std::uint64_t v : mine)
+        {
+            CHECK(v < total);
+            CHECK(!seen[v]);
+            seen[v] = 1;
+            sum += v;
+        }
+    }
+    CHECK(sum == total * (total - 1) / 2);
+}
+
+}
+
+void run_concurrent_stack_tests()
+{
+    const size_t cores = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 2;
+    const size_t side = cores < 8 ? 4 : cores / 2;
+
+    stress<std::uint64_t>(side, side, 0, 100000);
+    stress<std::uint64_t>(0, 0, side, 100000);
+    stress<std::uint64_t>(side, 1, side, 50000);
+    stress<std::string>(side, side, side, 20000);
+
+    // elements left in the stack are freed by its destructor
+    adstl::concurrent_stack<std::string> stack;
+    for(int i = 0; i < 1000; ++i)
+    {
+        stack.emplace(40, 'x');
+    }
+}
+
+}
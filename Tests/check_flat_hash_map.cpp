@@ -0,0 +1,263 @@
+#include "check.hpp"
+#include "flat_hash_map.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace adstl_check
+{
+
+namespace
+{
+
+// few distinct hashes, long probe sequences and many groups without an empty slot
+struct clustered_hash
+{
+    size_t operator()(int k) const noexcept { return static_cast<size_t>(k % 61); }
+};
+
+inline std::string make_key(unsigned k)
+{
+    // long enough to live on the heap
+    return "key-" + std::to_string(k) + std::string(24, '.');
+}
+
+// every element of the table is in the reference with the same value, the sizes match
+template <typename Map, typename Reference>
+void check_same_map(const Map &map, const Reference &ref)
+{
+    CHECK(map.size() == ref.size());
+    size_t n = 0;
+    for(const auto &kv : map)
+    {
+        auto it = ref.find(kv.first);
+        CHECK(it != ref.end() && it->second == kv.second);
+        ++n;
+    }
+    CHECK(n == ref.size());
+}
+
+template <typename Set, typename Reference>
+void check_same_set(const Set &set, const Reference &ref)
+{
+    CHECK(set.size() == ref.size());
+    size_t n = 0;
+    for(const auto &key : set)
+    {
+        CHECK(ref.count(key) == 1);
+        ++n;
+    }
+    CHECK(n == ref.size());
+}
+
+template <typename Map>
+void random_map(unsigned seed, unsigned range, int ops)
+{
+    std::mt19937 rng(seed);
+    Map map;
+    std::unordered_map<std::string, std::string> ref;
+
+    for(int op = 0; op < ops; ++op)
+    {
+        std::string key = make_key(rng() % range);
+        switch(rng() % 9)
+        {
+            case 0: case 1:
+            {
+                auto r = map.insert({key, std::to_string(op)});
+                CHECK(r.second == ref.insert({key, std::to_string(op)}).second && r.first->first == key);
+                break;
+            }
+            case 2:
+            {
+                auto r = map.emplace(key, std::to_string(op));
+                CHECK(r.second == ref.emplace(key, std::to_string(op)).second && r.first->first == key);
+                break;
+            }
+            case 3:
+            {
+                auto r = map.try_emplace(key, 4, 'x');
+                CHECK(r.second == ref.try_emplace(key, 4, 'x').second);
+                break;
+            }
+            case 4:
+            {
+                map[key] += 'y';
+                ref[key] += 'y';
+                break;
+            }
+            case 5: case 6:
+            {
+                CHECK(map.erase(std::string_view(key)) == ref.erase(key));
+                break;
+            }
+            case 7:
+            {
+                auto it = map.find(key);
+                CHECK((it == map.end()) == (ref.count(key) == 0));
+                if(it != map.end())
+                {
+                    map.erase(it);
+                    ref.erase(key);
+                }
+                break;
+            }
+            default:
+            {
+                auto found = map.try_at(key);
+                auto it = ref.find(key);
+                CHECK(static_cast<bool>(found) == (it != ref.end()));
+                CHECK(!found || *found == it->second);
+                CHECK(map.contains(std::string_view(key)) == (it != ref.end()));
+                break;
+            }
+        }
+
+        if(op % 1009 == 0)
+        {
+            check_same_map(map, ref);
+        }
+    }
+    check_same_map(map, ref);
+
+    Map copy(map);
+    check_same_map(copy, ref);
+    Map moved(std::move(copy));
+    check_same_map(moved, ref);
+    copy = moved;
+    check_same_map(copy, ref);
+
+    // erase everything through iterators, then the emptied table is as good as a new one
+    for(auto it = map.begin(); it != map.end();)
+    {
+        it = map.erase(it);
+    }
+    CHECK(map.empty() && map.begin() == map.end());
+    map.rehash(0);
+    map.emplace(make_key(1), "1");
+    CHECK(map.size() == 1 && map.at(make_key(1)) == "1");
+}
+
+void random_set(unsigned seed, unsigned range, int ops)
+{
+    std::mt19937 rng(seed);
+    adstl::flat_hash_set<std::string> set;
+    std::unordered_set<std::string> ref;
+
+    for(int op = 0; op < ops; ++op)
+    {
+        std::string key = make_key(rng() % range);
+        switch(rng() % 4)
+        {
+            case 0: CHECK(set.insert(key).second == ref.insert(key).second); break;
+            case 1: CHECK(set.emplace(key).second == ref.emplace(key).second); break;
+            case 2: CHECK(set.erase(key) == ref.erase(key)); break;
+            default: CHECK(set.contains(key) == (ref.count(key) == 1)); break;
+        }
+    }
+    check_same_set(set, ref);
+
+    set.clear();
+    CHECK(set.empty() && !set.contains(make_key(0)));
+}
+
+// churn on a table that never grows turns slots into tombstones, the rebuilds at the same
+// capacity have to keep every key reachable
+void tombstones()
+{
+    adstl::flat_hash_map<int, int, clustered_hash> map;
+    std::unordered_map<int, int> ref;
+    std::mt19937 rng(11);
+
+    for(int op = 0; op < 200000; ++op)
+    {
+        int key = static_cast<int>(rng() % 400);
+        if(rng() % 2)
+        {
+            CHECK(map.emplace(key, op).second == ref.emplace(key, op).second);
+        }
+        else
+        {
+            CHECK(map.erase(key) == ref.erase(key));
+        }
+    }
+    check_same_map(map, ref);
+    for(int key = 0; key < 400; ++key)
+    {
+        CHECK(map.contains(key) == (ref.count(key) == 1));
+    }
+}
+
+// the new value is copied from an element of the same map while the insert grows the
+// table, so the source lives in the slots the growth frees
+void self_reference()
+{
+    adstl::flat_hash_map<std::string, std::string> map;
+    std::unordered_map<std::string, std::string> ref;
+    map.try_emplace(make_key(0), std::string(40, 'a'));
+    ref.try_emplace(make_key(0), std::string(40, 'a'));
+
+    std::mt19937 rng(5);
+    for(unsigned i = 1; i < 5000; ++i)
+    {
+        const std::string source = make_key(rng() % i);
+        const std::string key = make_key(i);
+        if(i % 2)
+        {
+            map.try_emplace(key, map.at(source));
+        }
+        else
+        {
+            map.emplace(key, map.at(source));
+        }
+        ref.try_emplace(key, ref.at(source));
+        CHECK(map.at(key) == ref.at(key));
+    }
+    check_same_map(map, ref);
+
+    // the key itself comes from the table
+    adstl::flat_hash_map<std::string, int> counts;
+    for(unsigned i = 0; i < 1000; ++i)
+    {
+        counts.emplace(make_key(i), static_cast<int>(i));
+    }
+    adstl::flat_hash_map<std::string, int> copy(counts);
+    for(const auto &kv : copy)
+    {
+        auto r = counts.try_emplace(kv.first, -1);
+        CHECK(!r.second && r.first->second == kv.second);
+    }
+}
+
+}
+
+void run_flat_hash_map_tests()
+{
+    using string_map = adstl::flat_hash_map<std::string, std::string, adstl::string_hash, std::equal_to<>>;
+    for(unsigned seed = 0; seed < 3; ++seed)
+    {
+        random_map<string_map>(seed, 300, 20000);
+        random_map<string_map>(seed, 20000, 60000);
+        random_set(seed, 5000, 30000);
+    }
+    tombstones();
+    self_reference();
+
+    // reserve makes room without a rehash
+    adstl::flat_hash_map<int, int> map;
+    map.reserve(1000);
+    const size_t capacity = map.capacity();
+    for(int i = 0; i < 1000; ++i)
+    {
+        map.emplace(i, i);
+    }
+    CHECK(map.capacity() == capacity && map.size() == 1000);
+}
+
+}
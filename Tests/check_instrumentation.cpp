@@ -0,0 +1,136 @@
+#include "check.hpp"
+#include "instrumentation.hpp"
+#include "vector.hpp"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef ADSTL_INSTRUMENTATION
+#error "check_instrumentation.cpp has to be built with -DADSTL_INSTRUMENTATION"
+#endif
+
+// Its own executable: ADSTL_INSTRUMENTATION changes the inline code of every container, so
+// this file can not be linked with the other tests without breaking the one definition rule.
+//
+//     make check
+
+namespace adstl_check
+{
+
+namespace
+{
+
+using adstl::instrumentation::container;
+
+adstl::instrumentation::counters vector_counters()
+{
+    return adstl::instrumentation::collect()[container::vector];
+}
+
+// the counters a known sequence of vector operations has to leave behind
+void vector_sequence()
+{
+    adstl::instrumentation::reset();
+    uint64_t bytes = 0;
+    {
+        adstl::vector<int> v;
+        v.reserve(10);
+        bytes += 10 * sizeof(int);
+        for(int i = 0; i != 10; ++i)
+        {
+            v.push_back(i);
+        }
+
+        auto c = vector_counters();
+        CHECK(c.allocations == 1 && c.reallocations == 1 && c.bytes_allocated == bytes);
+        CHECK(c.peak_capacity == 10 && c.elements_moved == 0 && c.elements_copied == 0);
+
+        // full, the 11th element moves the ten others, int goes through memcpy
+        v.push_back(10);
+        bytes += v.capacity() * sizeof(int);
+        c = vector_counters();
+        CHECK(c.allocations == 2 && c.reallocations == 2 && c.bytes_allocated == bytes);
+        CHECK(c.peak_capacity == v.capacity() && c.elements_moved == 10);
+
+        // a bigger range replaces the buffer, its elements are copied in from outside
+        std::vector<int> range(100, 7);
+        v.assign(range.begin(), range.end());
+        bytes += 100 * sizeof(int);
+        c = vector_counters();
+        CHECK(v.capacity() == 100);
+        CHECK(c.allocations == 3 && c.reallocations == 3 && c.bytes_allocated == bytes);
+        CHECK(c.peak_capacity == 100 && c.elements_moved == 10);
+
+        // a smaller one reuses the buffer
+        v.assign(range.begin(), range.begin() + 50);
+        c = vector_counters();
+        CHECK(c.allocations == 3 && c.reallocations == 3 && c.bytes_allocated == bytes);
+
+        v.shrink_to_fit();
+        bytes += 50 * sizeof(int);
+        c = vector_counters();
+        CHECK(v.capacity() == 50);
+        CHECK(c.allocations == 4 && c.reallocations == 4 && c.bytes_allocated == bytes);
+        CHECK(c.peak_capacity == 100 && c.elements_moved == 60 && c.elements_copied == 0);
+    }
+
+    // the move constructor may throw, so growing copies
+    struct copied
+    {
+        copied(int v) : value(v) {}
+        copied(const copied&) = default;
+        copied(copied &&rhs) noexcept(false) : value(rhs.value) {}
+        copied& operator=(const copied&) = default;
+
+        int value;
+    };
+
+    adstl::instrumentation::reset();
+    {
+        adstl::vector<copied> v;
+        v.reserve(4);
+        for(int i = 0; i != 5; ++i)
+        {
+            v.emplace_back(i);
+        }
+
+        auto c = vector_counters();
+        CHECK(c.reallocations == 2 && c.allocations == 2);
+        CHECK(c.elements_copied == 4 && c.elements_moved == 0);
+    }
+}
+
+// the counters of a thread that exited are kept, reset() clears them
+void thread_totals()
+{
+    adstl::instrumentation::reset();
+    std::thread worker([]
+    {
+        adstl::vector<std::string> v;
+        v.reserve(8);
+    });
+    worker.join();
+
+    auto c = vector_counters();
+    CHECK(c.allocations == 1 && c.reallocations == 1 && c.peak_capacity == 8);
+    CHECK(c.bytes_allocated == 8 * sizeof(std::string));
+
+    adstl::instrumentation::reset();
+    c = vector_counters();
+    CHECK(c.allocations == 0 && c.reallocations == 0 && c.bytes_allocated == 0 && c.peak_capacity == 0);
+}
+
+}
+
+}
+
+int main()
+{
+    adstl_check::vector_sequence();
+    adstl_check::thread_totals();
+    std::puts("instrumentation ok");
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+#include "check.hpp"
+
+// Runs the adstl tests, a failed CHECK aborts with its location.
+//
+//     make check
+//     make check CHECK_CXXFLAGS="-std=c++17 -I./DataStructures -g -fsanitize=address,undefined"
+int main()
+{
+    adstl_check::run_btree_tests();
+    std::puts("btree ok");
+    adstl_check::run_concurrent_stack_tests();
+    std::puts("concurrent_stack ok");
+    adstl_check::run_flat_hash_map_tests();
+    std::puts("flat_hash_map ok");
+    adstl_check::run_mpmc_ring_tests();
+    std::puts("mpmc_ring ok");
+    adstl_check::run_parallel_tests();
+    std::puts("parallel ok");
+    adstl_check::run_priority_queue_tests();
+    std::puts("priority_queue ok");
+
+    return 0;
+}
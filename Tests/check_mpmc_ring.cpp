@@ -0,0 +1,249 @@
+#include "check.hpp"
+#include "mpmc_ring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace adstl_check
+{
+
+namespace
+{
+
+inline void make_element(std::uint64_t v, std::uint64_t &out)
+{
+    out = v;
+}
+
+inline void make_element(std::uint64_t v, std::string &out)
+{
+    // past the small string buffer, so a lost or doubled element shows up as a heap error too
+    out = "element-" + std::to_string(v) + std::string(24, '.');
+}
+
+inline std::uint64_t element_value(std::uint64_t v)
+{
+    return v;
+}
+
+inline std::uint64_t element_value(const std::string &s)
+{
+    return std::stoull(s.substr(8));
+}
+
+// Producers push their own values, one at a time or in batches of random length, the
+// consumers pop the same way. Every value has to arrive exactly once, and the values of
+// one producer in the order it pushed them, since tickets are claimed in increasing order
+// and each consumer claims its tickets in increasing order too. A lost element would
+// leave the consumers waiting forever, the deadline turns that into a failed check.
+template <typename Ring>
+void stress(size_t producers, size_t consumers, std::uint64_t per_producer, size_t capacity)
+{
+    using T = typename Ring::value_type;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(2);
+    Ring ring(capacity);
+    const std::uint64_t total = producers * per_producer;
+    std::atomic<std::uint64_t> popped{0};
+    std::vector<std::vector<std::uint64_t>> received(consumers);
+    std::vector<std::thread> threads;
+
+    for(size_t p = 0; p != producers; ++p)
+    {
+        threads.emplace_back([&ring, p, per_producer, deadline]
+        {
+            std::mt19937 rng(static_cast<unsigned>(p));
+            std::vector<T> batch;
+            std::uint64_t next = 0;
+            while(next != per_producer)
+            {
+                if(rng() % 2)
+                {
+                    T element;
+                    make_element(p * per_producer + next, element);
+                    if(ring.try_push(std::move(element)))
+                    {
+                        ++next;
+                    }
+                    else
+                    {
+                        CHECK(std::chrono::steady_clock::now() < deadline);
+                        std::this_thread::yield();
+                    }
+                    continue;
+                }
+
+                size_t n = static_cast<size_t>(std::min<std::uint64_t>(rng() % 17 + 1, per_producer - next));
+                batch.resize(n);
+                for(size_t i = 0; i != n; ++i)
+                {
+                    make_element(p * per_producer + next + i, batch[i]);
+                }
+                // moved from, so std::string takes the one CAS batch claim as well
+                size_t pushed = ring.try_push_n(std::make_move_iterator(batch.begin()), n);
+                next += pushed;
+                if(pushed == 0)
+                {
+                    CHECK(std::chrono::steady_clock::now() < deadline);
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for(size_t c = 0; c != consumers; ++c)
+    {
+        threads.emplace_back([&ring, &popped, &received, c, total, deadline]
+        {
+            std::mt19937 rng(static_cast<unsigned>(1000 + c));
+            std::vector<T> batch(17);
+            std::vector<std::uint64_t> &mine = received[c];
+            while(popped.load(std::memory_order_relaxed) != total)
+            {
+                size_t got;
+                if(rng() % 2)
+                {
+                    got = ring.try_pop(batch[0]) ? 1 : 0;
+                }
+                else
+                {
+                    got = ring.try_pop_n(batch.begin(), rng() % 17 + 1);
+                }
+
+                for(size_t i = 0; i != got; ++i)
+                {
+                    mine.push_back(element_value(batch[i]));
+                }
+                if(got == 0)
+                {
+                    CHECK(std::chrono::steady_clock::now() < deadline);
+                    std::this_thread::yield();
+                }
+                popped.fetch_add(got, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for(auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(ring.empty());
+    T element;
+    CHECK(!ring.try_pop(element));
+
+    std::vector<unsigned char> seen(total, 0);
+    std::uint64_t sum = 0;
+    for(const auto &mine : received)
+    {
+        std::vector<std::uint64_t> last(producers, 0);
+        std::vector<bool> any(producers, false);
+        for(std::uint64_t v : mine)
+        {
+            CHECK(v < total);
+            CHECK(!seen[v]);
+            seen[v] = 1;
+            sum += v;
+
+            size_t p = static_cast<size_t>(v / per_producer);
+            CHECK(!any[p] || last[p] < v);
+            any[p] = true;
+            last[p] = v;
+        }
+    }
+    CHECK(sum == total * (total - 1) / 2);
+}
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+
+// output iterator that throws on the given assignment
+struct throwing_output
+{
+    throwing_output& operator*() { return *this; }
+    throwing_output& operator++() { return *this; }
+
+    throwing_output& operator=(std::uint64_t &&v)
+    {
+        if(--countdown == 0)
+        {
+            throw std::runtime_error("throwing_output");
+        }
+        received->push_back(v);
+        return *this;
+    }
+
+    int countdown;
+    std::vector<std::uint64_t> *received;
+};
+
+// The element being handed out when the output throws is lost, the ones behind it stay in
+// the ring and every slot goes back to the producers. Several laps around a small ring,
+// a slot that is never released would make the pushes fail.
+template <typename Ring>
+void throwing_pop()
+{
+    Ring ring(4);
+    std::uint64_t next = 0;
+    for(int lap = 0; lap < 8; ++lap)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            CHECK(ring.try_push(next + i));
+        }
+        CHECK(!ring.try_push(next + 4));
+
+        std::vector<std::uint64_t> received;
+        bool thrown = false;
+        try
+        {
+            ring.try_pop_n(throwing_output{2, &received}, 4);
+        }
+        catch(const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown && received.size() == 1 && received[0] == next);
+        CHECK(ring.size() == 2);
+
+        std::uint64_t v;
+        CHECK(ring.try_pop(v) && v == next + 2);
+        CHECK(ring.try_pop(v) && v == next + 3);
+        CHECK(!ring.try_pop(v) && ring.empty());
+        next += 4;
+    }
+}
+
+#endif
+
+}
+
+void run_mpmc_ring_tests()
+{
+    const size_t cores = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 2;
+    const size_t side = cores < 8 ? 4 : cores / 2;
+
+    // a small ring wraps around all the time and keeps the threads contending on few slots
+    stress<adstl::mpmc_ring<std::uint64_t>>(side, side, 200000, 64);
+    stress<adstl::mpmc_ring<std::uint64_t>>(side, 1, 100000, 8);
+    stress<adstl::mpmc_ring<std::uint64_t>>(1, side, 200000, 1024);
+    stress<adstl::mpmc_ring<std::string>>(side, side, 50000, 32);
+
+    stress<adstl::spsc_ring<std::uint64_t>>(1, 1, 500000, 64);
+    stress<adstl::spsc_ring<std::string>>(1, 1, 100000, 16);
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+    throwing_pop<adstl::mpmc_ring<std::uint64_t>>();
+    throwing_pop<adstl::spsc_ring<std::uint64_t>>();
+#endif
+}
+
+}
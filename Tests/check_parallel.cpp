@@ -0,0 +1,354 @@
+#include "check.hpp"
+#include "algorithm.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace adstl_check
+{
+
+namespace
+{
+
+// few distinct values, so sort and partition see plenty of equal elements
+std::vector<int> random_ints(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<int> out(n);
+    for(int &v : out)
+    {
+        v = static_cast<int>(rng() % 1000) - 500;
+    }
+    return out;
+}
+
+adstl::vector<int> to_adstl(const std::vector<int> &v)
+{
+    return adstl::vector<int>(v.data(), v.data() + v.size());
+}
+
+bool same(const adstl::vector<int> &a, const std::vector<int> &b)
+{
+    return a.size() == b.size() && std::equal(b.begin(), b.end(), a.begin());
+}
+
+// moves may throw, so partition has to stay on the sequential stable_partition
+struct throwing_move
+{
+    throwing_move(int v) : value(v) {}
+    throwing_move(const throwing_move&) = default;
+    throwing_move(throwing_move &&rhs) noexcept(false) : value(rhs.value) {}
+    throwing_move& operator=(const throwing_move&) = default;
+    throwing_move& operator=(throwing_move &&rhs) noexcept(false) { value = rhs.value; return *this; }
+
+    int value;
+};
+
+// Every algorithm against its std:: counterpart on adstl::vector iterators and on raw
+// pointers. The sizes sit around the points where chunk_count() changes its mind: below
+// one grain, exactly two grains where splitting starts, and far past it.
+void algorithms(size_t n, unsigned seed)
+{
+    const std::vector<int> input = random_ints(n, seed);
+
+    {
+        adstl::vector<int> v = to_adstl(input);
+        std::vector<int> expect = input;
+        adstl::parallel::sort(v.begin(), v.end());
+        std::sort(expect.begin(), expect.end());
+        CHECK(same(v, expect));
+
+        std::vector<int> raw = input;
+        adstl::parallel::sort(raw.data(), raw.data() + n, std::greater<>());
+        std::sort(expect.begin(), expect.end(), std::greater<>());
+        CHECK(raw == expect);
+    }
+
+    {
+        adstl::vector<int> v = to_adstl(input);
+        adstl::vector<int> out = to_adstl(std::vector<int>(n, 0));
+        std::vector<int> expect(n);
+        auto square = [](int x) { return x * x - 3; };
+        CHECK(adstl::parallel::transform(v.begin(), v.end(), out.begin(), square) == out.end());
+        std::transform(input.begin(), input.end(), expect.begin(), square);
+        CHECK(same(out, expect));
+        CHECK(same(v, input));
+
+        adstl::parallel::transform(v.begin(), v.end(), v.begin(), square);
+        CHECK(same(v, expect));
+    }
+
+    {
+        adstl::vector<int> v = to_adstl(input);
+        std::int64_t init = 17;
+        auto widen = [](std::int64_t a, std::int64_t b) { return a + b; };
+        CHECK(adstl::parallel::reduce(v.begin(), v.end(), init, widen) == std::accumulate(input.begin(), input.end(), init, widen));
+        CHECK(adstl::parallel::reduce(input.data(), input.data() + n, 0) == std::accumulate(input.begin(), input.end(), 0));
+
+        // concatenation is associative but not commutative, chunks have to combine in order
+        std::vector<std::string> words(n);
+        for(size_t i = 0; i != n; ++i)
+        {
+            words[i] = std::to_string(input[i]) + ",";
+        }
+        std::string expect = std::accumulate(words.begin(), words.end(), std::string("["));
+        CHECK(adstl::parallel::reduce(words.data(), words.data() + n, std::string("[")) == expect);
+    }
+
+    {
+        adstl::vector<int> v = to_adstl(input);
+        adstl::vector<int> out = to_adstl(std::vector<int>(n, 0));
+        std::vector<int> expect(n);
+        CHECK(adstl::parallel::inclusive_scan(v.begin(), v.end(), out.begin()) == out.end());
+        std::inclusive_scan(input.begin(), input.end(), expect.begin());
+        CHECK(same(out, expect));
+
+        adstl::parallel::inclusive_scan(v.begin(), v.end(), v.begin());
+        CHECK(same(v, expect));
+
+        auto max = [](int a, int b) { return std::max(a, b); };
+        std::vector<int> raw = input;
+        adstl::parallel::inclusive_scan(raw.data(), raw.data() + n, raw.data(), max);
+        std::inclusive_scan(input.begin(), input.end(), expect.begin(), max);
+        CHECK(raw == expect);
+    }
+
+    {
+        adstl::vector<int> v = to_adstl(input);
+        std::atomic<size_t> calls{0};
+        adstl::parallel::for_each(v.begin(), v.end(), [&calls](int &x) { x = 2 * x + 1; calls.fetch_add(1, std::memory_order_relaxed); });
+        CHECK(calls.load() == n);
+        std::vector<int> expect = input;
+        std::for_each(expect.begin(), expect.end(), [](int &x) { x = 2 * x + 1; });
+        CHECK(same(v, expect));
+    }
+
+    {
+        auto negative = [](int x) { return x < 0; };
+        adstl::vector<int> v = to_adstl(input);
+        std::vector<int> expect = input;
+        auto split = adstl::parallel::partition(v.begin(), v.end(), negative);
+        auto expect_split = std::stable_partition(expect.begin(), expect.end(), negative);
+        CHECK(split - v.begin() == expect_split - expect.begin());
+        CHECK(same(v, expect));
+
+        std::vector<std::string> words(n), expect_words;
+        for(size_t i = 0; i != n; ++i)
+        {
+            words[i] = std::to_string(input[i]) + std::string(20, '.');
+        }
+        expect_words = words;
+        auto has_five = [](const std::string &s) { return s.find('5') != std::string::npos; };
+        std::string *end = adstl::parallel::partition(words.data(), words.data() + n, has_five);
+        auto expect_end = std::stable_partition(expect_words.begin(), expect_words.end(), has_five);
+        CHECK(end - words.data() == expect_end - expect_words.begin());
+        CHECK(words == expect_words);
+
+        std::vector<throwing_move> boxed(input.begin(), input.end());
+        throwing_move *boxed_end = adstl::parallel::partition(boxed.data(), boxed.data() + n, [](const throwing_move &x) { return x.value < 0; });
+        CHECK(boxed_end - boxed.data() == expect_split - expect.begin());
+        for(size_t i = 0; i != n; ++i)
+        {
+            CHECK(boxed[i].value == expect[i]);
+        }
+    }
+}
+
+// sum of [lo, hi) by recursive fork-join, every level opens its own task_group and the
+// waiting parent runs queued tasks instead of blocking a worker
+std::uint64_t recursive_sum(adstl::thread_pool &pool, std::uint64_t lo, std::uint64_t hi)
+{
+    if(hi - lo <= 64)
+    {
+        std::uint64_t sum = 0;
+        for(std::uint64_t i = lo; i != hi; ++i)
+        {
+            sum += i;
+        }
+        return sum;
+    }
+
+    std::uint64_t mid = lo + (hi - lo) / 2, left = 0;
+    adstl::thread_pool::task_group group(pool);
+    group.run([&pool, &left, lo, mid] { left = recursive_sum(pool, lo, mid); });
+    std::uint64_t right = recursive_sum(pool, mid, hi);
+    group.wait();
+    return left + right;
+}
+
+void nested_groups()
+{
+    adstl::thread_pool pool(3);
+    CHECK(recursive_sum(pool, 0, 100000) == 100000ull * 99999 / 2);
+
+    // the parallel algorithms called from inside tasks of the default pool
+    const std::vector<int> input = random_ints(20 * adstl::parallel::grain_size() + 5, 7);
+    const long expect = std::accumulate(input.begin(), input.end(), 0L);
+    std::vector<long> sums(8, 0);
+    std::atomic<int> inner{0};
+    adstl::thread_pool::task_group outer;
+    for(size_t t = 0; t != sums.size(); ++t)
+    {
+        outer.run([&, t]
+        {
+            adstl::thread_pool::task_group group;
+            for(int i = 0; i != 8; ++i)
+            {
+                group.run([&inner] { inner.fetch_add(1, std::memory_order_relaxed); });
+            }
+            sums[t] = adstl::parallel::reduce(input.data(), input.data() + input.size(), 0L);
+            group.wait();
+        });
+    }
+    outer.wait();
+    CHECK(inner.load() == 64);
+    for(long sum : sums)
+    {
+        CHECK(sum == expect);
+    }
+}
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+
+// wait() rethrows one of the exceptions only after every task of the group has finished,
+// and the group can be used again afterwards
+void exceptions()
+{
+    adstl::thread_pool pool(2);
+    for(int throwers = 1; throwers <= 3; ++throwers)
+    {
+        adstl::thread_pool::task_group group(pool);
+        std::atomic<int> done{0};
+        for(int i = 0; i != 32; ++i)
+        {
+            group.run([&done, i, throwers]
+            {
+                if(i % 12 == 0 && i / 12 < throwers)
+                {
+                    throw std::runtime_error("task " + std::to_string(i));
+                }
+                done.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+
+        bool thrown = false;
+        try
+        {
+            group.wait();
+        }
+        catch(const std::runtime_error &e)
+        {
+            thrown = std::string(e.what()).compare(0, 5, "task ") == 0;
+        }
+        CHECK(thrown);
+        CHECK(done.load() == 32 - throwers);
+
+        group.run([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        group.wait();
+        CHECK(done.load() == 33 - throwers);
+    }
+
+    // through a nested group into the outer wait()
+    {
+        adstl::thread_pool::task_group outer(pool);
+        outer.run([&pool]
+        {
+            adstl::thread_pool::task_group inner(pool);
+            inner.run([] { throw std::logic_error("inner"); });
+            inner.wait();
+        });
+
+        bool thrown = false;
+        try
+        {
+            outer.wait();
+        }
+        catch(const std::logic_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    // out of the parallel algorithms, from the chunk the caller runs and from the others
+    const size_t n = 16 * adstl::parallel::grain_size();
+    std::vector<int> data(n, 1);
+    for(size_t bad : {size_t(0), n / 2, n - 1})
+    {
+        bool thrown = false;
+        try
+        {
+            adstl::parallel::for_each(data.data(), data.data() + n, [&data, bad](int &x)
+            {
+                if(&x == data.data() + bad)
+                {
+                    throw std::runtime_error("for_each");
+                }
+            });
+        }
+        catch(const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        thrown = false;
+        data[bad] = -1;
+        try
+        {
+            adstl::parallel::reduce(data.data(), data.data() + n, 0, [](int a, int b)
+            {
+                if(a == -1 || b == -1)
+                {
+                    throw std::runtime_error("reduce");
+                }
+                return a + b;
+            });
+        }
+        catch(const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+        data[bad] = 1;
+    }
+}
+
+#endif
+
+}
+
+void run_parallel_tests()
+{
+    const size_t default_grain = adstl::parallel::grain_size();
+
+    // small grains split even short ranges, the default one is checked on its own sizes
+    for(size_t grain : {size_t(1), size_t(7), size_t(64), default_grain})
+    {
+        adstl::parallel::set_grain_size(grain);
+        for(size_t n : {size_t(0), size_t(1), grain - 1, grain, 2 * grain - 1, 2 * grain, 2 * grain + 1, 37 * grain + 5})
+        {
+            algorithms(n, static_cast<unsigned>(grain * 31 + n));
+        }
+    }
+
+    adstl::parallel::set_grain_size(16);
+    nested_groups();
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+    exceptions();
+#endif
+
+    adstl::parallel::set_grain_size(default_grain);
+    CHECK(adstl::parallel::grain_size() == default_grain);
+}
+
+}
@@ -0,0 +1,409 @@
+#include "check.hpp"
+#include "priority_queue.hpp"
+#include "segmented_vector.hpp"
+#include "small_vector.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace adstl_check
+{
+
+namespace
+{
+
+inline void make_element(unsigned v, int &out)
+{
+    out = static_cast<int>(v % 1000);
+}
+
+inline void make_element(unsigned v, std::string &out)
+{
+    // past the small string buffer, so a lost or doubled element shows up as a heap error too
+    out = std::to_string(v % 1000) + std::string(24, '.');
+}
+
+// every element ranks no higher than its parent, parent(i) = (i - 1) / Arity
+template <typename Q>
+bool is_heap(const Q &q)
+{
+    typename Q::value_compare comp;
+    const auto &a = q.container();
+    for(size_t i = 1; i < q.size(); ++i)
+    {
+        if(comp(a[(i - 1) / Q::arity], a[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Random pushes, pops, push_pop, replace_top and push_range next to std::priority_queue,
+// which has to agree on the top after every operation.
+template <typename Q>
+void random_queue(unsigned seed, int ops)
+{
+    using T = typename Q::value_type;
+    using Compare = typename Q::value_compare;
+
+    std::mt19937 rng(seed);
+    Q q;
+    std::priority_queue<T, std::vector<T>, Compare> ref;
+    T element;
+    for(int op = 0; op != ops; ++op)
+    {
+        make_element(rng(), element);
+        switch(rng() % 8)
+        {
+            case 0:
+            case 1:
+                q.push(element);
+                ref.push(element);
+                break;
+            case 2:
+                q.emplace(T(element));
+                ref.push(element);
+                break;
+            case 3:
+                if(ref.empty())
+                {
+                    CHECK(!q.try_pop() && !q.try_top());
+                    break;
+                }
+                CHECK(*q.try_pop() == ref.top());
+                ref.pop();
+                break;
+            case 4:
+                if(!ref.empty())
+                {
+                    q.pop();
+                    ref.pop();
+                }
+                break;
+            case 5:
+            {
+                // hands back the element itself when it outranks the whole queue
+                ref.push(element);
+                T expect = ref.top();
+                ref.pop();
+                CHECK(q.push_pop(element) == expect);
+                break;
+            }
+            case 6:
+                if(!ref.empty())
+                {
+                    T expect = ref.top();
+                    ref.pop();
+                    ref.push(element);
+                    CHECK(q.replace_top(element) == expect);
+                }
+                break;
+            case 7:
+            {
+                // big batches take the heapify path, small ones are pushed one by one
+                std::vector<T> batch(rng() % (std::min<size_t>(q.size(), 64) * 2 + 3));
+                for(T &b : batch)
+                {
+                    make_element(rng(), b);
+                    ref.push(b);
+                }
+                q.push_range(batch.begin(), batch.end());
+                break;
+            }
+        }
+
+        CHECK(q.size() == ref.size());
+        CHECK(q.empty() == ref.empty());
+        if(!ref.empty())
+        {
+            CHECK(q.top() == ref.top());
+        }
+        if(op % 64 == 0)
+        {
+            CHECK(is_heap(q));
+        }
+    }
+
+    CHECK(is_heap(q));
+    while(!ref.empty())
+    {
+        CHECK(*q.try_top() == ref.top());
+        q.pop();
+        ref.pop();
+    }
+    CHECK(q.empty());
+
+    q.push(element);
+    q.clear();
+    CHECK(q.empty() && !q.try_top());
+}
+
+// O(n) construction from a whole container and from a range
+template <typename Q>
+void bulk_queue(size_t n)
+{
+    using T = typename Q::value_type;
+    using Compare = typename Q::value_compare;
+
+    std::mt19937 rng(static_cast<unsigned>(n));
+    std::vector<T> elements(n);
+    typename Q::container_type c;
+    for(T &e : elements)
+    {
+        make_element(rng(), e);
+        c.push_back(e);
+    }
+
+    std::priority_queue<T, std::vector<T>, Compare> ref(Compare(), elements);
+    Q from_container(Compare(), std::move(c));
+    Q from_range(elements.begin(), elements.end());
+    CHECK(is_heap(from_container) && is_heap(from_range));
+
+    Q other;
+    other.swap(from_range);
+    CHECK(from_range.empty() && other.size() == n);
+
+    while(!ref.empty())
+    {
+        CHECK(from_container.top() == ref.top() && other.top() == ref.top());
+        from_container.pop();
+        other.pop();
+        ref.pop();
+    }
+    CHECK(from_container.empty() && other.empty());
+}
+
+// The indexed queue next to a table of the live handles. After every operation the top
+// has to be the best live value found by scanning the whole table, handles are never
+// handed out twice, and freed handles come back before the table grows.
+template <typename Compare, size_t Arity>
+void random_indexed(unsigned seed, int ops)
+{
+    using Q = adstl::indexed_priority_queue<int, Compare, Arity>;
+
+    std::mt19937 rng(seed);
+    Compare comp;
+    Q q;
+    std::vector<int> value;     // by handle
+    std::vector<bool> live;
+    std::vector<size_t> freed;
+    size_t largest = 0;
+
+    auto pick = [&]
+    {
+        size_t h;
+        do
+        {
+            h = rng() % live.size();
+        }
+        while(!live[h]);
+        return h;
+    };
+
+    for(int op = 0; op != ops; ++op)
+    {
+        const int v = static_cast<int>(rng() % 100000);
+        switch(q.empty() ? 0 : rng() % 8)
+        {
+            case 0:
+            case 1:
+            {
+                size_t h = rng() % 2 ? q.push(v) : q.emplace(v);
+                if(freed.empty())
+                {
+                    CHECK(h == live.size());
+                    live.push_back(true);
+                    value.push_back(v);
+                }
+                else
+                {
+                    CHECK(h < live.size() && !live[h]);
+                    CHECK(std::find(freed.begin(), freed.end(), h) != freed.end());
+                    freed.erase(std::find(freed.begin(), freed.end(), h));
+                    live[h] = true;
+                    value[h] = v;
+                }
+                break;
+            }
+            case 2:
+            {
+                size_t h = q.top_handle();
+                CHECK(live[h] && value[h] == q.top());
+                if(rng() % 2)
+                {
+                    q.pop();
+                }
+                else
+                {
+                    CHECK(*q.try_pop() == value[h]);
+                }
+                live[h] = false;
+                freed.push_back(h);
+                CHECK(!q.contains(h));
+                break;
+            }
+            case 3:
+            case 4:
+            {
+                // a higher priority, which for a min queue is a smaller value
+                size_t h = pick();
+                int step = static_cast<int>(rng() % 50);
+                value[h] = comp(0, 1) ? value[h] + step : value[h] - step;
+                q.decrease_key(h, value[h]);
+                break;
+            }
+            case 5:
+            case 6:
+            {
+                size_t h = pick();
+                value[h] = v;
+                q.update(h, v);
+                break;
+            }
+            case 7:
+            {
+                size_t h = pick();
+                q.erase(h);
+                live[h] = false;
+                freed.push_back(h);
+                CHECK(!q.contains(h));
+                break;
+            }
+        }
+
+        size_t count = 0, best = live.size();
+        for(size_t h = 0; h != live.size(); ++h)
+        {
+            if(live[h])
+            {
+                ++count;
+                if(best == live.size() || comp(value[best], value[h]))
+                {
+                    best = h;
+                }
+            }
+        }
+        largest = std::max(largest, count);
+
+        CHECK(q.size() == count);
+        CHECK(live.size() <= largest);
+        if(count)
+        {
+            CHECK(q.top() == value[best]);
+            CHECK(value[q.top_handle()] == q.top());
+        }
+        if(op % 64 == 0)
+        {
+            for(size_t h = 0; h != live.size(); ++h)
+            {
+                CHECK(q.contains(h) == live[h]);
+                CHECK(!live[h] || q.value(h) == value[h]);
+            }
+        }
+    }
+
+    // popping the rest gives every remaining value in order
+    std::vector<int> rest;
+    for(size_t h = 0; h != live.size(); ++h)
+    {
+        if(live[h])
+        {
+            rest.push_back(value[h]);
+        }
+    }
+    std::sort(rest.begin(), rest.end(), [&comp](int a, int b) { return comp(b, a); });
+    for(int expect : rest)
+    {
+        CHECK(*q.try_pop() == expect);
+    }
+    CHECK(q.empty() && !q.try_top() && !q.try_pop());
+
+    q.clear();
+    CHECK(q.push(1) == 0);
+}
+
+// bulk construction hands out the handles 0 to n - 1 in range order
+template <size_t Arity>
+void bulk_indexed(size_t n)
+{
+    using Q = adstl::indexed_priority_queue<int, std::greater<int>, Arity>;
+
+    std::vector<int> elements(n);
+    for(size_t i = 0; i != n; ++i)
+    {
+        elements[i] = static_cast<int>((i * 7919) % 1009);
+    }
+
+    Q q(elements.begin(), elements.end());
+    CHECK(q.size() == n);
+    for(size_t h = 0; h != n; ++h)
+    {
+        CHECK(q.contains(h) && q.value(h) == elements[h]);
+    }
+    CHECK(!q.contains(n));
+
+    // every third one out by handle, the others have to come out smallest first
+    std::vector<int> rest;
+    for(size_t h = 0; h != n; ++h)
+    {
+        if(h % 3 == 0)
+        {
+            q.erase(h);
+        }
+        else
+        {
+            rest.push_back(elements[h]);
+        }
+    }
+    std::sort(rest.begin(), rest.end());
+    for(int expect : rest)
+    {
+        size_t h = q.top_handle();
+        CHECK(q.top() == expect && elements[h] == expect);
+        q.pop();
+    }
+    CHECK(q.empty());
+
+    Q other;
+    other.swap(q);
+    CHECK(other.empty() && q.empty());
+}
+
+}
+
+void run_priority_queue_tests()
+{
+    for(unsigned seed = 0; seed != 4; ++seed)
+    {
+        random_queue<adstl::priority_queue<int>>(seed, 40000);
+        random_queue<adstl::priority_queue<int, std::greater<int>>>(seed, 40000);
+        random_queue<adstl::quaternary_priority_queue<int>>(seed, 40000);
+        random_queue<adstl::quaternary_priority_queue<int, std::greater<int>>>(seed, 40000);
+        random_queue<adstl::priority_queue<int, std::less<int>, adstl::vector<int>, 3>>(seed, 40000);
+        // operator[] walks the segment chain, short segments cross plenty of boundaries anyway
+        random_queue<adstl::priority_queue<int, std::less<int>, adstl::segmented_vector<int, std::allocator<int>, 16>, 4>>(seed, 3000);
+        random_queue<adstl::priority_queue<int, std::less<int>, adstl::small_vector<int, 16>, 2>>(seed, 40000);
+        random_queue<adstl::quaternary_priority_queue<std::string>>(seed, 10000);
+
+        random_indexed<std::greater<int>, 2>(seed, 20000);
+        random_indexed<std::greater<int>, 4>(seed, 20000);
+        random_indexed<std::less<int>, 4>(seed, 20000);
+        random_indexed<std::less<int>, 3>(seed, 20000);
+    }
+
+    for(size_t n : {0, 1, 2, 3, 4, 5, 17, 1000, 12345})
+    {
+        bulk_queue<adstl::priority_queue<int>>(n);
+        bulk_queue<adstl::quaternary_priority_queue<std::string>>(n);
+        bulk_queue<adstl::priority_queue<int, std::greater<int>, adstl::vector<int>, 3>>(n);
+        bulk_indexed<2>(n);
+        bulk_indexed<4>(n);
+    }
+}
+
+}